@@ -23,4 +23,25 @@
 #define N_LOC 2
 #define M_LOC 3
 
+// Channels are distributed over cores in blocks of that size
+#define CHANNEL_BLOCK 8
+#define LINE_BLOCK 1
+
+// Decisions of the explorer attached to each layer
+#define DATAFLOW_ATTR "xten.dataflow"
+
+// [row, col] of the core an expanded op is placed on
+#define CORE_ATTR "xten.core"
+
+// Memory banks of its core holding each buffer of an expanded op
+#define BANKS_ATTR "xten.banks"
+
+// Module attribute naming the file holding the data of the xten.external_constant ops
+#define WEIGHTS_BLOB_ATTR "xten.weights_blob"
+
+// Scales of an int8 layer, real values being scale * int: input_scale, output_scale and
+// weight_scales with one scale per output channel. The layer accumulates in int32 and rescales
+// each output channel by input_scale * weight_scales[c] / output_scale into its int8 result
+#define QUANT_ATTR "xten.quant"
+
 #endif
@@ -14,6 +14,8 @@
 #include "xten/Dialect/XTen/XTenOpWrapper.h"
 #include "xten/Util/Arch.h"
 
+#include "llvm/ADT/STLExtras.h"
+
 #define FORCE_INT8 1
 
 #include <memory>
@@ -55,6 +57,50 @@ namespace xilinx {
             }
         };
 
+        // Struct of arrays view of a set of candidate ModelParams for one layer
+        // Filled by the caller, valid and totalTime are computed by DataflowExplorer::evaluateBatch
+        class ModelParamsBatch {
+        public:
+            std::vector<uint32_t> P;
+            std::vector<uint32_t> Ca;
+            std::vector<uint32_t> L;
+            std::vector<uint32_t> W;
+            std::vector<uint8_t> lineGranularity;
+
+            std::vector<uint8_t> valid;
+            std::vector<uint64_t> memBanks;
+            std::vector<uint64_t> totalTime;
+
+            void push_back(ModelParams params) {
+                P.push_back(params.P);
+                Ca.push_back(params.Ca);
+                L.push_back(params.L);
+                W.push_back(params.W);
+                lineGranularity.push_back(params.lineGranularity);
+            }
+
+            ModelParams at(uint64_t i) {
+                return ModelParams(P[i], Ca[i], L[i], W[i], lineGranularity[i]);
+            }
+
+            uint64_t size() {
+                return P.size();
+            }
+        };
+
+        // Banks of each buffer of one expanded op, see DataflowExplorer::getLocalBufferBanks
+        class BufferBanks {
+        public:
+            uint64_t weights;
+            uint64_t input;
+            uint64_t forward;
+            uint64_t output;
+
+            uint64_t total() {
+                return weights + input + forward + output;
+            }
+        };
+
         // TODO build destructors for graphs
 
         class DataflowExplorer {
@@ -83,14 +129,17 @@ namespace xilinx {
 
             uint64_t getActivationInBanks(uint64_t layerId, ModelParams &params);
             uint64_t getActivationOutBanks(uint64_t layerId, ModelParams &params);
+            int64_t getLocalWeightSize(uint64_t layerId, ModelParams &params);
             uint64_t getWeightBanks(uint64_t layerId, ModelParams &params);
             uint64_t getTotalMemBanks(uint64_t layerId, ModelParams &params);
+            BufferBanks getLocalBufferBanks(uint64_t layerId, ModelParams &params);
 
             uint64_t getActCommunicationTimePerTile(uint64_t layerId, ModelParams &params);
             uint64_t getActCommunicationTime(uint64_t layerId, ModelParams &params);
 
             uint64_t getWeightCommunicationTimePerTile(uint64_t layerId, ModelParams &params);
             uint64_t getWeightCommunicationTime(uint64_t layerid, ModelParams &params);
+            uint64_t getWeightStreamVolume(uint64_t layerId, ModelParams &params);
 
             uint64_t getTotalTimePerTile(uint64_t layerId, ModelParams &params);
             uint64_t getTotalTime(uint64_t layerId, ModelParams &params);
@@ -108,10 +157,14 @@ namespace xilinx {
             bool allWeightsIn(uint64_t layerId, ModelParams &params);
             bool checkPath(std::vector<ModelParams> &params);
 
+            // Batch version of isValid, getTotalMemBanks and getTotalTime
+            void evaluateBatch(uint64_t layerId, ModelParamsBatch &batch);
+
             // Explore functions
             bool isValid(uint64_t layerId, ModelParams &params);
             bool prune(Node_t* locNode, uint64_t locLayerId, Node_t* prevNode, uint64_t locBound, uint64_t prevBound, float maxDist);
             bool wMatches(Node_t* layerNode, Node_t* inNode, uint64_t layerId);
+            bool canFollow(uint64_t layerId, ModelParams &prev, ModelParams &loc);
             std::vector<uint64_t> generateExplorationBounds();
 
             void generateValidTopologies();
@@ -119,31 +172,49 @@ namespace xilinx {
             void enumeratePaths();
             void getParetoFrontierAndCleanGraph();
             void dfsRec(Node_t* node, std::vector<ModelParams> path, uint64_t loc,
-                        std::ofstream &throughput, std::ofstream &latency);
+                        llvm::raw_ostream &throughput, llvm::raw_ostream &latency);
             void dfsRecFast(Node_t* node, std::vector<ModelParams> path, uint64_t loc,
-                        std::ofstream &throughput, std::ofstream &latency);
-            void dfs(bool full);
+                        llvm::raw_ostream &throughput, llvm::raw_ostream &latency);
+            void dfs(bool full, llvm::raw_ostream &throughput, llvm::raw_ostream &latency);
+
+            // Exploration statistics
+            uint64_t numCandidates; // (P, Ca, L, W, granularity) evaluated by generateValidTopologies
+            uint64_t numEdges; // edges of the path graph
+            uint64_t numCellsRelaxed; // (node, area) frontier cells relaxed by enumeratePaths
+            uint64_t peakNodeMemory; // bytes held by the path graph nodes
+            uint64_t getPathGraphMemory();
 
             // Pareto stuff found at the end of exploration
             std::vector<PathInfo_t> paretoThroughput;
             std::vector<PathInfo_t> paretoLatency;
 
             DataflowExplorer(std::vector<std::pair<std::string, AbsOpWrapper*>> &nameToOps);
+            DataflowExplorer(std::vector<std::pair<std::string, std::map<std::string, int64_t>>> &nameToSizes);
             ~DataflowExplorer();
 
+            void initializeLayers(std::vector<std::pair<std::string, std::map<std::string, int64_t>>> &nameToSizes);
+            std::string emitLayerDescriptors();
+
             // Explore function
+            // runPhase runs each phase of the exploration given its name and may time it
+            void enumerate(llvm::function_ref<void(const char*, llvm::function_ref<void()>)> runPhase);
             void enumerate();
             void printValidTopologies();
-            void dumpModelParam(ModelParams& params, std::ofstream &outputFile, std::string layerName, uint64_t i);
-            void dumpValidTopologies();
-            void dumpParetoFrontiers();
-            void dumpPath(PathInfo_t &path, std::string fname);
-            void dumpPathsFrom(std::vector<PathInfo_t> &paths, std::string prefix);
-            void dumpMacs();
-
+            void dumpModelParam(ModelParams& params, llvm::raw_ostream &outputFile, std::string layerName, uint64_t i);
+            void dumpValidTopologies(llvm::raw_ostream &out);
+            void dumpParetoFrontiers(llvm::raw_ostream &out);
+            void dumpPath(PathInfo_t &path, uint64_t area, llvm::raw_ostream &out);
+            void dumpPathsFrom(std::vector<PathInfo_t> &paths, std::string name, llvm::raw_ostream &out);
+            void dumpMacs(llvm::raw_ostream &out);
+            bool dumpExploration(std::string filename);
+
+            std::vector<ModelParams> getMaxThroughputPath();
             std::map<std::string, ModelParams> getMaxThroughput();
+            std::string emitBottleneckReport(unsigned int maxExtraCores);
             std::map<std::string, ModelParams> getBestTopology();
         };
+
+        bool parseLayerDescriptors(std::string filename, std::vector<std::pair<std::string, std::map<std::string, int64_t>>> &layers);
     }
 }
 
@@ -0,0 +1,88 @@
+//===- XTenDataflowSimulator.h ----------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "xten/Dialect/XTen/XTenDataflowExplorer.h"
+
+#include <string>
+#include <vector>
+
+namespace xilinx {
+    namespace xten {
+        // What a layer did during the simulation, times are in cycles
+        class SimLayerStats_t {
+        public:
+            uint64_t tiles; // tiles per sample
+            uint64_t computeTileTime; // compute of one tile
+            uint64_t streamTime; // streaming the input lines of one sample to the layer
+            uint64_t weightTileTime; // streaming the weights of one tile, 0 if they stay in memory
+            uint64_t bufferLines; // capacity of the input buffer in lines
+            uint64_t requiredLines; // lines the input buffer must hold for the pipeline to make progress
+
+            uint64_t busy; // computing
+            uint64_t inputStall; // waiting for lines the producer has not computed yet
+            uint64_t streamStall; // waiting for input lines or weights still being streamed
+            uint64_t outputStall; // waiting for the consumer to free buffer space
+
+            uint64_t maxOccupancy; // lines held in the input buffer
+            double avgOccupancy;
+
+            uint64_t firstDone; // end of the first sample
+            uint64_t lastDone; // end of the last sample
+
+            SimLayerStats_t() {
+                tiles = 0; computeTileTime = 0; streamTime = 0; weightTileTime = 0;
+                bufferLines = 0; requiredLines = 0;
+                busy = 0; inputStall = 0; streamStall = 0; outputStall = 0;
+                maxOccupancy = 0; avgOccupancy = 0;
+                firstDone = 0; lastDone = 0;
+            }
+        };
+
+        // Discrete event simulation of the line level producer consumer pipeline of a design
+        // Each layer computes its tiles in order. The lines produced by a layer are streamed to the
+        // next one over a link of their own, and weights that do not fit in memory are streamed for
+        // each tile over another one, so both overlap with compute. A tile starts when the lines it
+        // reads and its weights have arrived and when the lines it produces fit in the bounded input
+        // buffer of the next layer. Only compute and stream durations come from the analytical model.
+        class DataflowSimulator {
+        public:
+            DataflowSimulator(DataflowExplorer &explorer, std::vector<ModelParams> &path);
+
+            // Returns false if an input buffer cannot hold what its tiles need or if the pipeline
+            // deadlocked, failure then says why
+            bool run(uint64_t numSamples);
+
+            // Simulated cycles between two samples leaving the pipeline
+            uint64_t getInterval();
+            uint64_t getLatency();
+
+            std::string emitReport();
+
+            std::vector<SimLayerStats_t> layers;
+            std::string failure;
+
+        private:
+            DataflowExplorer &explorer;
+            std::vector<ModelParams> path;
+            uint64_t numSamples;
+            uint64_t endTime;
+
+            uint64_t inLines(uint64_t layerId);
+            uint64_t outLines(uint64_t layerId);
+            uint64_t neededLines(uint64_t layerId, uint64_t tile);
+            uint64_t releasedLines(uint64_t layerId, uint64_t tile);
+            uint64_t producedLines(uint64_t layerId, uint64_t tile);
+            uint64_t getRequiredLines(uint64_t layerId);
+            uint64_t getStreamTime(uint64_t layerId, uint64_t lines);
+        };
+    }
+}
@@ -19,6 +19,10 @@
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Pass/AnalysisManager.h"
+#include "mlir/Pass/PassInstrumentation.h"
+
+#include "llvm/ADT/SetVector.h"
 
 using namespace mlir;
 
@@ -69,8 +73,27 @@ namespace xilinx {
 
         torch::Torch::BaseTensorType breakShapeInto(torch::Torch::BaseTensorType initShape, unsigned int at, unsigned int into);
         torch::Torch::BaseTensorType mergeShapeInto(torch::Torch::BaseTensorType initShape, unsigned int at, unsigned int into);
-
-        void splitConstantInto(arith::ConstantOp op, std::vector<Value> &ops, OpBuilder &builder, Split split, SplitType t, unsigned int into);
+        torch::Torch::BaseTensorType resizeShapeAt(torch::Torch::BaseTensorType initShape, unsigned int at, int64_t size);
+
+        // Sizes of the into parts of size, multiples of granularity when possible and the tail in the last part
+        // Empty when size is smaller than into, as some parts would be empty
+        std::vector<int64_t> getSplitSizes(int64_t size, unsigned int into, int64_t granularity);
+        // Largest part of getSplitSizes, 1 when the parts would be empty as a core holds at least one element
+        int64_t getMaxSplitSize(int64_t size, unsigned int into, int64_t granularity);
+        // Integer ceil(a / b) for positive a, b, inline so that the batch evaluation of the explorer vectorizes
+        inline int64_t ceilDiv(int64_t a, int64_t b) {
+            return (a + b - 1) / b;
+        }
+
+        bool isConstantOrSlice(Value v);
+        // Data of an arith.constant or torch.vtensor.literal, null for anything else
+        DenseElementsAttr getConstantData(Value v);
+        void sliceConstantInto(Value v, std::vector<Value> &ops, OpBuilder &builder, Split split, SplitType t, unsigned int into);
+        void sliceConstantAlong(Value v, std::vector<Value> &ops, OpBuilder &builder, unsigned int dim, std::vector<int64_t> &sizes);
+        // Data of the part of the constant slice refers to, null if slice does not refer to a constant
+        // or if the elements of the constant are not byte addressable
+        DenseElementsAttr materializeSlice(SliceOp slice);
+        uint64_t rawElementBytes(Type elementType);
 
         void deleteOpsFrom(std::vector<Operation*> &ops);
         void deleteOpsFrom(std::vector<AbsOpWrapper*> &ops);
@@ -80,12 +103,54 @@ namespace xilinx {
                            std::vector<Operation*> &toDelete, unsigned int dim, unsigned int into);
 
         void insertSplit(OpBuilder &builder, Value prevInput, std::vector<Value> &nInputs, unsigned int dim, unsigned int into);
+        void insertSplit(OpBuilder &builder, Value prevInput, std::vector<Value> &nInputs, unsigned int dim,
+                         std::vector<int64_t> &sizes);
         void replaceSplit(OpBuilder &builder, SplitOp split, std::vector<Value> &values,
                           std::vector<Operation*> &toDelete, unsigned int dim);
 
 
         unsigned int getAttrOrDefault(Operation* op, std::string attrName, unsigned int defVal);
+
+        // Null after an error on op when the dataflow has no model of op
+        AbsOpWrapper* opToWrapper(Operation* op);
+        // Fails after an error on each op with a layer_name that opToWrapper does not support
+        LogicalResult checkLayerOps(func::FuncOp graph);
+
+        // Keeps the weight scales of the output channels [offset, offset + size) in the QUANT_ATTR of op, if any
+        void sliceQuantAttr(Operation* op, int64_t offset, int64_t size);
+        // Type of the partial sums of a chain computing resultType, int32 accumulators for int8 layers
+        Type getPartialResultType(Operation* op, Type resultType);
+
+        void setDataflowAttr(Operation* op, ModelParams &params, uint64_t computeTime, uint64_t totalTimePerTile, uint64_t totalTime);
+        bool getDataflowAttr(Operation* op, ModelParams &params);
         void printOperationLoc(Operation* op);
+
+        // Layer name of an expanded op followed by its locP, locCa, locL and locW
+        std::string getOpLabel(Operation* op);
+
+        // Writes report to filename, or to stdout for "-", fails after an error at loc if the file cannot be opened
+        LogicalResult writeReport(std::string filename, std::string report, Location loc);
+
+        // Times a phase of a pass under -mlir-timing, nested in the timer of the running pass
+        // The instrumentation reports phases like analyses, phases are identified by the address of
+        // their name, which must be a string literal
+        class PhaseTimer {
+        public:
+            PhaseTimer(AnalysisManager am, Operation* op, const char* name);
+            ~PhaseTimer();
+
+        private:
+            PassInstrumentor* instrumentor;
+            Operation* op;
+            const char* name;
+        };
+
+        // Ops with a layer_name producing v, seen through the concat, split and slice ops of the expansion
+        void findProducerOps(Value v, llvm::SmallSetVector<Operation*, 4> &producers);
+
+        // Ops with a layer_name in topological order of the SSA graph, ties keep the order of the graph
+        // producers[i] holds the positions in that order of the layers read by the i-th layer
+        std::vector<Operation*> getLayersInTopologicalOrder(func::FuncOp graph, std::vector<std::vector<uint64_t>> &producers);
     }
 }
 
@@ -47,6 +47,7 @@ namespace xilinx {
             virtual Value getWeights() = 0;
             virtual Value getInput() = 0;
             virtual Value getPartialInput() = 0;
+            virtual Value getResidual() = 0;
             virtual Optional<Value> getBiases() = 0;
             virtual ArrayRef<Value> getBN() = 0;
             virtual unsigned int getF0() = 0;
@@ -62,7 +63,7 @@ namespace xilinx {
             //virtual Value getBNBias();
             virtual Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                        llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                       llvm::Optional<ArrayRef<Value>> bn) = 0;
+                                       llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) = 0;
             virtual Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) = 0;
         };
 
@@ -76,6 +77,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -88,7 +90,7 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
 
@@ -102,6 +104,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -114,7 +117,7 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
 
@@ -128,6 +131,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -140,7 +144,7 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
 
@@ -154,6 +158,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -166,7 +171,7 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
 
@@ -180,6 +185,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -192,7 +198,7 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
 
@@ -206,6 +212,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -218,7 +225,172 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+
+        class Conv2dHardswishOpWrapper : public AbsOpWrapper {
+        private:
+            Conv2dHardswishOp conv;
+        public:
+            Conv2dHardswishOpWrapper(Conv2dHardswishOp c);
+            ~Conv2dHardswishOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        class PartialConv2dHardswishOpWrapper : public AbsOpWrapper {
+        private:
+            PartialConv2dHardswishOp conv;
+        public:
+            PartialConv2dHardswishOpWrapper(PartialConv2dHardswishOp c);
+            ~PartialConv2dHardswishOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        class Conv2dBatchNormOpWrapper : public AbsOpWrapper {
+        private:
+            Conv2dBatchNormOp conv;
+        public:
+            Conv2dBatchNormOpWrapper(Conv2dBatchNormOp c);
+            ~Conv2dBatchNormOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        class PartialConv2dBatchNormOpWrapper : public AbsOpWrapper {
+        private:
+            PartialConv2dBatchNormOp conv;
+        public:
+            PartialConv2dBatchNormOpWrapper(PartialConv2dBatchNormOp c);
+            ~PartialConv2dBatchNormOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        class Conv2dBatchNormAddReLUOpWrapper : public AbsOpWrapper {
+        private:
+            Conv2dBatchNormAddReLUOp conv;
+        public:
+            Conv2dBatchNormAddReLUOpWrapper(Conv2dBatchNormAddReLUOp c);
+            ~Conv2dBatchNormAddReLUOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            // Only the op given the residual adds it, the others are plain conv bn partial ops
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        class PartialConv2dBatchNormAddReLUOpWrapper : public AbsOpWrapper {
+        private:
+            PartialConv2dBatchNormAddReLUOp conv;
+        public:
+            PartialConv2dBatchNormAddReLUOpWrapper(PartialConv2dBatchNormAddReLUOp c);
+            ~PartialConv2dBatchNormAddReLUOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            // Only the op given the residual adds it, the others are plain conv bn partial ops
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
 
@@ -233,6 +405,7 @@ namespace xilinx {
             Value getWeights() override;
             Value getInput() override;
             Value getPartialInput() override;
+            Value getResidual() override;
             Optional<Value> getBiases() override;
             ArrayRef<Value> getBN() override;
             virtual unsigned int getF0() override;
@@ -245,7 +418,124 @@ namespace xilinx {
             double getKernelEfficiency() override;
             Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                llvm::Optional<Value> bias,llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                               llvm::Optional<ArrayRef<Value>> bn) override;
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        // Matrix multiply of x [rows, K] by y [K, cols], y plays the role of the weights
+        // P partitions the columns of y, W partitions the rows of x
+        class MMOpWrapper : public AbsOpWrapper {
+        private:
+            MMOp mm;
+        public:
+            MMOpWrapper(MMOp c);
+            ~MMOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        // Fully connected layer, input [rows, K] times the transpose of weight [cols, K] plus bias [cols]
+        // P partitions the rows of the weights and the bias, W partitions the rows of the input
+        class LinearReLUOpWrapper : public AbsOpWrapper {
+        private:
+            LinearReLUOp linear;
+        public:
+            LinearReLUOpWrapper(LinearReLUOp c);
+            ~LinearReLUOpWrapper();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        // Elementwise binary ops are depth-wise with a 1x1 window, both inputs are partitioned alike
+        class AddOpWrapper : public AbsOpWrapper {
+        private:
+            AddOp add;
+        public:
+            AddOpWrapper(AddOp c);
+            ~AddOpWrapper();
+            Value getOtherInput();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            // weight, when given, replaces the second input
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
+            Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
+        };
+
+        class MulOpWrapper : public AbsOpWrapper {
+        private:
+            MulOp mul;
+        public:
+            MulOpWrapper(MulOp c);
+            ~MulOpWrapper();
+            Value getOtherInput();
+            Operation* getUnderlyingOperation() override;
+            Value getWeights() override;
+            Value getInput() override;
+            Value getPartialInput() override;
+            Value getResidual() override;
+            Optional<Value> getBiases() override;
+            ArrayRef<Value> getBN() override;
+            virtual unsigned int getF0() override;
+            virtual unsigned int getF1() override;
+            unsigned int getStride() override;
+            bool hasWeights() override;
+            bool hasBias() override;
+            bool hasBN() override;
+            bool isDepthWise() override;
+            double getKernelEfficiency() override;
+            // weight, when given, replaces the second input
+            Operation* buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                               llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                               llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) override;
             Operation* wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) override;
         };
     }
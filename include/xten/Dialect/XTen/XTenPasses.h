@@ -13,8 +13,17 @@
 
 #include "mlir/Pass/Pass.h"
 
+#include "xten/Dialect/XTen/XTenAllocateBanksPass.h"
 #include "xten/Dialect/XTen/XTenDataflow.h"
+#include "xten/Dialect/XTen/XTenDataflowAnnotatePass.h"
+#include "xten/Dialect/XTen/XTenEmitGraphPass.h"
+#include "xten/Dialect/XTen/XTenExternalizeConstantsPass.h"
+#include "xten/Dialect/XTen/XTenFoldBatchNormPass.h"
+#include "xten/Dialect/XTen/XTenInternalizeConstantsPass.h"
+#include "xten/Dialect/XTen/XTenMaterializeSlicesPass.h"
 #include "xten/Dialect/XTen/XTenNamePass.h"
+#include "xten/Dialect/XTen/XTenPlacePass.h"
+#include "xten/Dialect/XTen/XTenQuantizePass.h"
 
 namespace xilinx {
 namespace xten {
@@ -24,6 +24,8 @@ class AbsArchitecture {
     virtual uint64_t getComSpeed() = 0;
     virtual uint64_t getPipelineDepth() = 0;
     virtual uint64_t getNumCores() = 0;
+    virtual uint64_t getNumRows() = 0;
+    virtual uint64_t getNumCols() = 0;
     virtual uint64_t getClockFrequency() = 0;
 };
 
@@ -71,6 +73,15 @@ class AIEv1 : public AbsArchitecture {
         return 400;
     }
 
+    // Cores are laid out as a grid, neighbours share memory and cascade streams
+    uint64_t getNumRows() override {
+        return 8;
+    }
+
+    uint64_t getNumCols() override {
+        return 50;
+    }
+
     uint64_t getClockFrequency() override {
         return pow(10, 9);
     }
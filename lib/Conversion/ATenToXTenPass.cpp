@@ -75,11 +75,15 @@ struct ATenToXTenPass : public ATenToXTenBase<ATenToXTenPass> {
     target.addLegalDialect<AffineDialect, LLVM::LLVMDialect,
                            func::FuncDialect, scf::SCFDialect>();
 
+    target.addLegalOp<xilinx::xten::Conv2dBatchNormOp>();
+    target.addLegalOp<xilinx::xten::Conv2dBatchNormAddReLUOp>();
     target.addLegalOp<xilinx::xten::Conv2dBatchNormReLUOp>();
     target.addLegalOp<xilinx::xten::Conv2dReLUOp>();
     target.addLegalOp<xilinx::xten::Conv2dLReLUOp>();
     target.addLegalOp<xilinx::xten::Conv2dLReLUMaxPoolOp>();
+    target.addLegalOp<xilinx::xten::Conv2dHardswishOp>();
     target.addLegalOp<xilinx::xten::Conv2dOp>();
+    target.addLegalOp<xilinx::xten::LinearReLUOp>();
     target.addLegalOp<xilinx::xten::NoOp>();
     if (failed(applyPatternsAndFoldGreedily(module, /*target,*/ std::move(fusionPatterns)))) {
       emitError(UnknownLoc::get(context), "error translating or fusing ATen to XTen\n");
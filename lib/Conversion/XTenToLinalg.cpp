@@ -11,6 +11,7 @@
 #include "PassDetail.h"
 
 #include "xten/Conversion/XTenToLinalgPass.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
 #include "xten/Dialect/XTen/XTenDialect.h"
 #include "xten/Dialect/XTen/XTenOps.h"
 #include "xten/Util/Util.h"
@@ -18,10 +19,13 @@
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionDialect.h"
+#include "torch-mlir/Dialect/TorchConversion/IR/TorchConversionOps.h"
 
+#include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Pass/Pass.h"
@@ -31,6 +35,9 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <cmath>
+#include <type_traits>
+
 #define DEBUG_TYPE "xten-to-linalg-pass"
 
 using namespace mlir;
@@ -39,6 +46,24 @@ using namespace mlir::torch;
 
 namespace {
 
+// Builtin element type of a torch dtype, arith and linalg only take signless integers
+static Type getBuiltinElementType(Type dtype) {
+  if (auto intTy = dtype.dyn_cast<IntegerType>())
+    return IntegerType::get(dtype.getContext(), intTy.getWidth());
+  return dtype;
+}
+
+// MemRefTypeCast to the builtin element type, for the si8 and si32 tensors of quantized ops
+static Value BuiltinMemRefTypeCast(OpBuilder &builder, Value val) {
+  auto tensorTy = val.getType().cast<Torch::BaseTensorType>();
+  auto sizes = tensorTy.getSizes();
+  auto elementTy = getBuiltinElementType(tensorTy.getDtype());
+  auto tensor = builder.create<TorchConversion::ToBuiltinTensorOp>(
+      val.getLoc(), RankedTensorType::get(sizes, elementTy), val);
+  return builder.create<bufferization::ToMemrefOp>(
+      val.getLoc(), MemRefType::get(sizes, elementTy, {}, 0), tensor);
+}
+
 template <class T>
 class XTenBinaryOpConversion : public ConversionPattern {
 public:
@@ -134,6 +159,10 @@ public:
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value > operands,
                   ConversionPatternRewriter &rewriter) const override {
+    // Quantized mm are lowered by XTenQuantizedMMOpConversion
+    if (op->hasAttr(QUANT_ATTR))
+      return failure();
+
     auto mmult = cast<MMOp>(op);
     auto loc = mmult.getLoc();
 
@@ -169,6 +198,10 @@ public:
   LogicalResult
   matchAndRewrite(Operation *op, ArrayRef<Value > operands,
                   ConversionPatternRewriter &rewriter) const override {
+    // Quantized conv2d are lowered by XTenQuantizedConv2dOpConversion
+    if (op->hasAttr(QUANT_ATTR))
+      return failure();
+
     auto mmult = cast<Conv2dOp>(op);
     auto loc = mmult.getLoc();
 
@@ -230,6 +263,505 @@ public:
   }
 };
 
+// Elementwise epilogue applied in place to the result of a fused op, the ops only differ
+// by the activation or the normalization that follows the convolution or the matmul
+static void emitInPlaceGeneric(ConversionPatternRewriter &rewriter, Location loc,
+                               ValueRange inputs, ArrayRef<AffineMap> inputMaps, Value C,
+                               function_ref<Value(OpBuilder &, Location, ValueRange, Value)> emitElement) {
+  auto rank = C.getType().cast<MemRefType>().getRank();
+
+  SmallVector<AffineMap, 6> indexMap(inputMaps.begin(), inputMaps.end());
+  indexMap.push_back(rewriter.getMultiDimIdentityMap(rank));
+
+  rewriter.create<linalg::GenericOp>(
+    loc, TypeRange{}, inputs, ValueRange{C}, indexMap,
+    SmallVector<StringRef>(rank, getParallelIteratorTypeName()),
+    [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange blockArgs) {
+      auto result = emitElement(nestedBuilder, nestedLoc,
+                                blockArgs.drop_back(), blockArgs.back());
+      nestedBuilder.create<linalg::YieldOp>(nestedLoc, result);
+    });
+}
+
+// C = bias broadcast along the channel dimension, or zero when bias is null or none, before
+// the convolution or the matmul accumulates on top of it
+static void emitBiasInit(ConversionPatternRewriter &rewriter, Location loc, Value bias,
+                         Value C, unsigned channelDim) {
+  auto rank = C.getType().cast<MemRefType>().getRank();
+  auto elementTy = C.getType().cast<MemRefType>().getElementType();
+
+  bool hasBias = bias && !bias.getType().isa<Torch::NoneType>();
+  SmallVector<Value, 1> biasInputs;
+  SmallVector<AffineMap, 1> biasMaps;
+  if (hasBias) {
+    biasInputs.push_back(BuiltinMemRefTypeCast(rewriter, bias));
+    biasMaps.push_back(AffineMap::get(rank, 0, rewriter.getAffineDimExpr(channelDim)));
+  }
+
+  emitInPlaceGeneric(rewriter, loc, biasInputs, biasMaps, C,
+    [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+      if (hasBias)
+        return args[0];
+      return builder.create<mlir::arith::ConstantOp>(nestedLoc, builder.getZeroAttr(elementTy));
+    });
+}
+
+static Value emitReLU(OpBuilder &builder, Location loc, Value x) {
+  auto elementTy = x.getType();
+  if (elementTy.isa<FloatType>()) {
+    auto zero = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(elementTy, 0.0));
+    return builder.create<mlir::arith::MaxFOp>(loc, x, zero);
+  } else {
+    auto zero = builder.create<mlir::arith::ConstantOp>(loc, builder.getIntegerAttr(elementTy, 0));
+    return builder.create<mlir::arith::MaxSIOp>(loc, x, zero);
+  }
+}
+
+// x * min(max(x + 3, 0), 6) / 6
+static Value emitHardswish(OpBuilder &builder, Location loc, Value x) {
+  auto elementTy = x.getType();
+  auto three = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(elementTy, 3.0));
+  auto six = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(elementTy, 6.0));
+  Value shifted = builder.create<mlir::arith::AddFOp>(loc, x, three);
+  Value clamped = builder.create<mlir::arith::MinFOp>(loc, emitReLU(builder, loc, shifted), six);
+  Value scaled = builder.create<mlir::arith::MulFOp>(loc, x, clamped);
+  return builder.create<mlir::arith::DivFOp>(loc, scaled, six);
+}
+
+// Rounds the float x half away from zero to the integer type intTy, saturating at its bounds
+static Value emitRoundToInt(OpBuilder &builder, Location loc, Value x, Type intTy) {
+  auto floatTy = x.getType();
+  unsigned width = intTy.getIntOrFloatBitWidth();
+  double lowest = -std::ldexp(1.0, width - 1);
+  double highest = std::ldexp(1.0, width - 1) - 1;
+
+  auto zero = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(floatTy, 0.0));
+  auto half = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(floatTy, 0.5));
+  auto minusHalf = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(floatTy, -0.5));
+  auto lowestCst = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(floatTy, lowest));
+  auto highestCst = builder.create<mlir::arith::ConstantOp>(loc, builder.getFloatAttr(floatTy, highest));
+
+  Value negative = builder.create<mlir::arith::CmpFOp>(loc, mlir::arith::CmpFPredicate::OLT, x, zero);
+  Value offset = builder.create<mlir::arith::SelectOp>(loc, negative, minusHalf, half);
+  Value rounded = builder.create<mlir::arith::AddFOp>(loc, x, offset);
+  Value clamped = builder.create<mlir::arith::MaxFOp>(loc, rounded, lowestCst);
+  clamped = builder.create<mlir::arith::MinFOp>(loc, clamped, highestCst);
+  return builder.create<mlir::arith::FPToSIOp>(loc, intTy, clamped);
+}
+
+// C += input [N, K] times the transpose of weight [M, K], integer inputs are sign extended to
+// the accumulators
+static void emitLinear(ConversionPatternRewriter &rewriter, Location loc, Value A, Value B, Value C) {
+  auto elementTy = C.getType().cast<MemRefType>().getElementType();
+
+  auto i = rewriter.getAffineDimExpr(0);
+  auto j = rewriter.getAffineDimExpr(1);
+  auto k = rewriter.getAffineDimExpr(2);
+
+  SmallVector<AffineMap, 3> indexMap{AffineMap::get(3, 0, {i, k}, rewriter.getContext()),
+                                     AffineMap::get(3, 0, {j, k}, rewriter.getContext()),
+                                     AffineMap::get(3, 0, {i, j}, rewriter.getContext())};
+
+  rewriter.create<linalg::GenericOp>(
+    loc, TypeRange{}, ValueRange{A, B}, ValueRange{C}, indexMap,
+    SmallVector<StringRef>{getParallelIteratorTypeName(),
+                           getParallelIteratorTypeName(),
+                           getReductionIteratorTypeName()},
+    [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange blockArgs) {
+      Value result;
+      if (elementTy.isa<FloatType>()) {
+        Value mul = nestedBuilder.create<mlir::arith::MulFOp>(nestedLoc, blockArgs[0], blockArgs[1]);
+        result = nestedBuilder.create<mlir::arith::AddFOp>(nestedLoc, blockArgs[2], mul);
+      } else {
+        Value a = blockArgs[0];
+        Value b = blockArgs[1];
+        if (a.getType() != elementTy)
+          a = nestedBuilder.create<mlir::arith::ExtSIOp>(nestedLoc, elementTy, a);
+        if (b.getType() != elementTy)
+          b = nestedBuilder.create<mlir::arith::ExtSIOp>(nestedLoc, elementTy, b);
+        Value mul = nestedBuilder.create<mlir::arith::MulIOp>(nestedLoc, a, b);
+        result = nestedBuilder.create<mlir::arith::AddIOp>(nestedLoc, blockArgs[2], mul);
+      }
+      nestedBuilder.create<linalg::YieldOp>(nestedLoc, result);
+    });
+}
+
+class XTenConv2dHardswishOpConversion : public ConversionPattern {
+public:
+  explicit XTenConv2dHardswishOpConversion(MLIRContext *context)
+      : ConversionPattern(Conv2dHardswishOp::getOperationName(), 1, context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value > operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto conv = cast<Conv2dHardswishOp>(op);
+    auto loc = conv.getLoc();
+
+    auto resultTy = op->getResult(0).getType();
+    auto tensorTy = resultTy.cast<Torch::BaseTensorType>();
+    auto elementTy = tensorTy.getDtype();
+    if (!elementTy.isa<FloatType>())
+      return failure();
+
+    auto A = MemRefTypeCast(rewriter, operands[0]);
+    auto B = MemRefTypeCast(rewriter, operands[1]);
+
+    auto memRefResultTy =
+        mlir::MemRefType::get(tensorTy.getSizes(), elementTy, {}, 0);
+
+    auto C = rewriter.create<memref::AllocOp>(loc, memRefResultTy);
+
+    emitBiasInit(rewriter, loc, conv.bias(), C, 3);
+    rewriter.create<linalg::Conv2DNhwcHwcfOp>(loc, ValueRange{A, B}, ValueRange{C});
+
+    emitInPlaceGeneric(rewriter, loc, ValueRange{}, {}, C,
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+        return emitHardswish(builder, nestedLoc, x);
+      });
+
+    auto tensor_cast =
+        TensorTypeCast(rewriter, C->getResult(0), op->getResult(0).getType());
+    rewriter.replaceOp(op, tensor_cast);
+    return success();
+  }
+};
+
+// Inference batch norm after the convolution, per channel of the NHWC result:
+// (x - running_mean) * bn_weight / sqrt(running_var + eps) + bn_bias,
+// followed by the residual add and the ReLU for conv2d_bn_add_relu
+template <class T>
+class XTenConv2dBatchNormOpConversion : public ConversionPattern {
+public:
+  explicit XTenConv2dBatchNormOpConversion(MLIRContext *context)
+      : ConversionPattern(T::getOperationName(), 1, context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value > operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto conv = cast<T>(op);
+    auto loc = conv.getLoc();
+
+    auto resultTy = op->getResult(0).getType();
+    auto tensorTy = resultTy.cast<Torch::BaseTensorType>();
+    auto elementTy = tensorTy.getDtype();
+
+    auto eps = conv.eps().template getDefiningOp<Torch::ConstantFloatOp>();
+    if (!eps || !elementTy.isa<FloatType>())
+      return failure();
+
+    auto A = MemRefTypeCast(rewriter, operands[0]);
+    auto B = MemRefTypeCast(rewriter, operands[1]);
+
+    auto memRefResultTy =
+        mlir::MemRefType::get(tensorTy.getSizes(), elementTy, {}, 0);
+
+    auto C = rewriter.create<memref::AllocOp>(loc, memRefResultTy);
+
+    emitBiasInit(rewriter, loc, conv.bias(), C, 3);
+    rewriter.create<linalg::Conv2DNhwcHwcfOp>(loc, ValueRange{A, B}, ValueRange{C});
+
+    auto rank = tensorTy.getSizes().size();
+    auto channelMap = AffineMap::get(rank, 0, rewriter.getAffineDimExpr(3));
+
+    SmallVector<Value, 5> inputs{MemRefTypeCast(rewriter, conv.bn_weight()),
+                                 MemRefTypeCast(rewriter, conv.bn_bias()),
+                                 MemRefTypeCast(rewriter, conv.running_mean()),
+                                 MemRefTypeCast(rewriter, conv.running_var())};
+    SmallVector<AffineMap, 5> inputMaps(4, channelMap);
+
+    bool residual = std::is_same<T, Conv2dBatchNormAddReLUOp>::value;
+    if (residual) {
+      inputs.push_back(MemRefTypeCast(rewriter, op->getOperands().back()));
+      inputMaps.push_back(rewriter.getMultiDimIdentityMap(rank));
+    }
+
+    double epsValue = eps.value().convertToDouble();
+    emitInPlaceGeneric(rewriter, loc, inputs, inputMaps, C,
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+        auto epsCst = builder.create<mlir::arith::ConstantOp>(nestedLoc, builder.getFloatAttr(elementTy, epsValue));
+        Value var = builder.create<mlir::arith::AddFOp>(nestedLoc, args[3], epsCst);
+        Value stddev = builder.create<math::SqrtOp>(nestedLoc, var);
+        Value centered = builder.create<mlir::arith::SubFOp>(nestedLoc, x, args[2]);
+        Value scaled = builder.create<mlir::arith::MulFOp>(nestedLoc, centered, args[0]);
+        Value normalized = builder.create<mlir::arith::DivFOp>(nestedLoc, scaled, stddev);
+        Value result = builder.create<mlir::arith::AddFOp>(nestedLoc, normalized, args[1]);
+        if (!residual)
+          return result;
+
+        result = builder.create<mlir::arith::AddFOp>(nestedLoc, result, args[4]);
+        return emitReLU(builder, nestedLoc, result);
+      });
+
+    auto tensor_cast =
+        TensorTypeCast(rewriter, C->getResult(0), op->getResult(0).getType());
+    rewriter.replaceOp(op, tensor_cast);
+    return success();
+  }
+};
+
+// input [N, K] times the transpose of weight [M, K], accumulated on top of the bias
+class XTenLinearReLUOpConversion : public ConversionPattern {
+public:
+  explicit XTenLinearReLUOpConversion(MLIRContext *context)
+      : ConversionPattern(LinearReLUOp::getOperationName(), 1, context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value > operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    // Quantized linear_relu are lowered by XTenQuantizedLinearReLUOpConversion
+    if (op->hasAttr(QUANT_ATTR))
+      return failure();
+
+    auto linear = cast<LinearReLUOp>(op);
+    auto loc = linear.getLoc();
+
+    auto resultTy = op->getResult(0).getType();
+    auto tensorTy = resultTy.cast<Torch::BaseTensorType>();
+    auto elementTy = tensorTy.getDtype();
+    auto memRefResultTy =
+        mlir::MemRefType::get(tensorTy.getSizes(), elementTy, {}, 0);
+
+    auto A = MemRefTypeCast(rewriter, operands[0]);
+    auto B = MemRefTypeCast(rewriter, operands[1]);
+    auto C = rewriter.create<memref::AllocOp>(loc, memRefResultTy);
+
+    emitBiasInit(rewriter, loc, linear.bias(), C, 1);
+    emitLinear(rewriter, loc, A, B, C);
+
+    emitInPlaceGeneric(rewriter, loc, ValueRange{}, {}, C,
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+        return emitReLU(builder, nestedLoc, x);
+      });
+
+    auto tensor_cast =
+        TensorTypeCast(rewriter, C->getResult(0), op->getResult(0).getType());
+    rewriter.replaceOp(op, tensor_cast);
+    return success();
+  }
+};
+
+// round(input / scale) saturated to the integer element type of the result
+class XTenQuantizeOpConversion : public ConversionPattern {
+public:
+  explicit XTenQuantizeOpConversion(MLIRContext *context)
+      : ConversionPattern(QuantizeOp::getOperationName(), 1, context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value > operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto quantize = cast<QuantizeOp>(op);
+    auto loc = quantize.getLoc();
+
+    auto tensorTy = op->getResult(0).getType().cast<Torch::BaseTensorType>();
+    auto elementTy = getBuiltinElementType(tensorTy.getDtype());
+    auto inputTy = operands[0].getType().cast<Torch::BaseTensorType>();
+    if (!elementTy.isa<IntegerType>() || !inputTy.getDtype().isa<FloatType>())
+      return failure();
+
+    auto A = MemRefTypeCast(rewriter, operands[0]);
+    auto C = rewriter.create<memref::AllocOp>(
+        loc, mlir::MemRefType::get(tensorTy.getSizes(), elementTy, {}, 0));
+
+    auto rank = tensorTy.getSizes().size();
+    double scale = quantize.scale().convertToDouble();
+    emitInPlaceGeneric(rewriter, loc, ValueRange{A}, {rewriter.getMultiDimIdentityMap(rank)}, C,
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+        auto scaleCst = builder.create<mlir::arith::ConstantOp>(nestedLoc, builder.getFloatAttr(args[0].getType(), scale));
+        Value scaled = builder.create<mlir::arith::DivFOp>(nestedLoc, args[0], scaleCst);
+        return emitRoundToInt(builder, nestedLoc, scaled, elementTy);
+      });
+
+    auto tensor_cast =
+        TensorTypeCast(rewriter, C->getResult(0), op->getResult(0).getType());
+    rewriter.replaceOp(op, tensor_cast);
+    return success();
+  }
+};
+
+// input * scale in the float element type of the result
+class XTenDequantizeOpConversion : public ConversionPattern {
+public:
+  explicit XTenDequantizeOpConversion(MLIRContext *context)
+      : ConversionPattern(DequantizeOp::getOperationName(), 1, context) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value > operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto dequantize = cast<DequantizeOp>(op);
+    auto loc = dequantize.getLoc();
+
+    auto tensorTy = op->getResult(0).getType().cast<Torch::BaseTensorType>();
+    auto elementTy = tensorTy.getDtype();
+    auto inputTy = operands[0].getType().cast<Torch::BaseTensorType>();
+    if (!elementTy.isa<FloatType>() || !inputTy.getDtype().isa<IntegerType>())
+      return failure();
+
+    auto A = BuiltinMemRefTypeCast(rewriter, operands[0]);
+    auto C = rewriter.create<memref::AllocOp>(
+        loc, mlir::MemRefType::get(tensorTy.getSizes(), elementTy, {}, 0));
+
+    auto rank = tensorTy.getSizes().size();
+    double scale = dequantize.scale().convertToDouble();
+    emitInPlaceGeneric(rewriter, loc, ValueRange{A}, {rewriter.getMultiDimIdentityMap(rank)}, C,
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+        auto scaleCst = builder.create<mlir::arith::ConstantOp>(nestedLoc, builder.getFloatAttr(elementTy, scale));
+        Value value = builder.create<mlir::arith::SIToFPOp>(nestedLoc, elementTy, args[0]);
+        return builder.create<mlir::arith::MulFOp>(nestedLoc, value, scaleCst);
+      });
+
+    auto tensor_cast =
+        TensorTypeCast(rewriter, C->getResult(0), op->getResult(0).getType());
+    rewriter.replaceOp(op, tensor_cast);
+    return success();
+  }
+};
+
+// Layers quantized by xten-quantize, with their scales in QUANT_ATTR: the i8 input and weights
+// accumulate in i32 on top of the i32 bias. The requantize epilogue brings each output channel c
+// of the accumulators back to real values with input_scale * weight_scales[c], applies the
+// activation of the layer and rounds the result divided by output_scale to i8. The output
+// channels are the innermost dimension of the result, NHWC for the convolutions. T provides
+// emitAccumulate and emitActivation, the float lowerings of the same ops skip quantized ones.
+template <class T>
+class XTenQuantizedOpConversion : public ConversionPattern {
+public:
+  XTenQuantizedOpConversion(StringRef rootName, MLIRContext *ctx)
+      : ConversionPattern(rootName, 1, ctx) {}
+
+  LogicalResult
+  matchAndRewrite(Operation *op, ArrayRef<Value > operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto quant = op->getAttrOfType<DictionaryAttr>(QUANT_ATTR);
+    if (!quant)
+      return failure();
+
+    auto inputScale = quant.getAs<FloatAttr>("input_scale");
+    auto outputScale = quant.getAs<FloatAttr>("output_scale");
+    auto weightScales = quant.getAs<ArrayAttr>("weight_scales");
+    if (!inputScale || !outputScale || !weightScales)
+      return failure();
+
+    auto loc = op->getLoc();
+    auto tensorTy = op->getResult(0).getType().cast<Torch::BaseTensorType>();
+    auto sizes = tensorTy.getSizes();
+    auto elementTy = getBuiltinElementType(tensorTy.getDtype());
+    auto rank = sizes.size();
+    int64_t channels = sizes[rank - 1];
+    if (!elementTy.isa<IntegerType>() ||
+        (weightScales.size() != 1 && (int64_t)weightScales.size() != channels))
+      return failure();
+
+    auto accTy = rewriter.getI32Type();
+    auto C = rewriter.create<memref::AllocOp>(
+        loc, mlir::MemRefType::get(sizes, accTy, {}, 0));
+    static_cast<const T*>(this)->emitAccumulate(op, operands, rewriter, C);
+
+    // Real value of one unit of the accumulators of each output channel
+    auto f32 = rewriter.getF32Type();
+    SmallVector<float, 16> realScales;
+    for (int64_t c = 0; c < channels; c++) {
+      auto weightScale = weightScales[weightScales.size() == 1 ? 0 : c].cast<FloatAttr>();
+      realScales.push_back(inputScale.getValueAsDouble() * weightScale.getValueAsDouble());
+    }
+    auto scalesTy = RankedTensorType::get({channels}, f32);
+    Value scalesTensor = rewriter.create<mlir::arith::ConstantOp>(
+        loc, DenseElementsAttr::get(scalesTy, llvm::makeArrayRef(realScales)));
+    Value scales = rewriter.create<bufferization::ToMemrefOp>(
+        loc, mlir::MemRefType::get({channels}, f32, {}, 0), scalesTensor);
+
+    auto D = rewriter.create<memref::AllocOp>(
+        loc, mlir::MemRefType::get(sizes, elementTy, {}, 0));
+
+    SmallVector<AffineMap, 2> inputMaps{
+        rewriter.getMultiDimIdentityMap(rank),
+        AffineMap::get(rank, 0, rewriter.getAffineDimExpr(rank - 1))};
+    double outScale = outputScale.getValueAsDouble();
+    emitInPlaceGeneric(rewriter, loc, ValueRange{C, scales}, inputMaps, D,
+      [&](OpBuilder &builder, Location nestedLoc, ValueRange args, Value x) -> Value {
+        auto outScaleCst = builder.create<mlir::arith::ConstantOp>(nestedLoc, builder.getFloatAttr(f32, outScale));
+        Value acc = builder.create<mlir::arith::SIToFPOp>(nestedLoc, f32, args[0]);
+        Value real = builder.create<mlir::arith::MulFOp>(nestedLoc, acc, args[1]);
+        real = static_cast<const T*>(this)->emitActivation(builder, nestedLoc, real);
+        Value scaled = builder.create<mlir::arith::DivFOp>(nestedLoc, real, outScaleCst);
+        return emitRoundToInt(builder, nestedLoc, scaled, elementTy);
+      });
+
+    auto tensor_cast =
+        TensorTypeCast(rewriter, D->getResult(0), op->getResult(0).getType());
+    rewriter.replaceOp(op, tensor_cast);
+    return success();
+  }
+};
+
+// conv2d, conv2d_relu and conv2d_hardswish
+template <class OpT>
+class XTenQuantizedConv2dOpConversion
+    : public XTenQuantizedOpConversion<XTenQuantizedConv2dOpConversion<OpT>> {
+public:
+  explicit XTenQuantizedConv2dOpConversion(MLIRContext *context)
+      : XTenQuantizedOpConversion<XTenQuantizedConv2dOpConversion<OpT>>(
+            OpT::getOperationName(), context) {}
+
+  void emitAccumulate(Operation *op, ArrayRef<Value> operands,
+                      ConversionPatternRewriter &rewriter, Value C) const {
+    auto conv = cast<OpT>(op);
+    auto A = BuiltinMemRefTypeCast(rewriter, operands[0]);
+    auto B = BuiltinMemRefTypeCast(rewriter, operands[1]);
+
+    emitBiasInit(rewriter, op->getLoc(), conv.bias(), C, 3);
+    rewriter.create<linalg::Conv2DNhwcHwcfOp>(op->getLoc(), ValueRange{A, B}, ValueRange{C});
+  }
+
+  Value emitActivation(OpBuilder &builder, Location loc, Value x) const {
+    if (std::is_same<OpT, Conv2dReLUOp>::value)
+      return emitReLU(builder, loc, x);
+    if (std::is_same<OpT, Conv2dHardswishOp>::value)
+      return emitHardswish(builder, loc, x);
+    return x;
+  }
+};
+
+class XTenQuantizedMMOpConversion
+    : public XTenQuantizedOpConversion<XTenQuantizedMMOpConversion> {
+public:
+  explicit XTenQuantizedMMOpConversion(MLIRContext *context)
+      : XTenQuantizedOpConversion(MMOp::getOperationName(), context) {}
+
+  void emitAccumulate(Operation *op, ArrayRef<Value> operands,
+                      ConversionPatternRewriter &rewriter, Value C) const {
+    auto A = BuiltinMemRefTypeCast(rewriter, operands[0]);
+    auto B = BuiltinMemRefTypeCast(rewriter, operands[1]);
+
+    emitBiasInit(rewriter, op->getLoc(), Value(), C, 1);
+    rewriter.create<linalg::MatmulOp>(op->getLoc(), TypeRange{}, ValueRange{A, B},
+                                      ValueRange{C});
+  }
+
+  Value emitActivation(OpBuilder &builder, Location loc, Value x) const {
+    return x;
+  }
+};
+
+class XTenQuantizedLinearReLUOpConversion
+    : public XTenQuantizedOpConversion<XTenQuantizedLinearReLUOpConversion> {
+public:
+  explicit XTenQuantizedLinearReLUOpConversion(MLIRContext *context)
+      : XTenQuantizedOpConversion(LinearReLUOp::getOperationName(), context) {}
+
+  void emitAccumulate(Operation *op, ArrayRef<Value> operands,
+                      ConversionPatternRewriter &rewriter, Value C) const {
+    auto A = BuiltinMemRefTypeCast(rewriter, operands[0]);
+    auto B = BuiltinMemRefTypeCast(rewriter, operands[1]);
+
+    emitBiasInit(rewriter, op->getLoc(), cast<LinearReLUOp>(op).bias(), C, 1);
+    emitLinear(rewriter, op->getLoc(), A, B, C);
+  }
+
+  Value emitActivation(OpBuilder &builder, Location loc, Value x) const {
+    return emitReLU(builder, loc, x);
+  }
+};
+
 class XTenToLinalgPass : public XTenToLinalgBase<XTenToLinalgPass> {
 
 public:
@@ -250,11 +782,23 @@ public:
                     XTenMulOpConversion,
                     XTenMMOpConversion,
                     XTenConv2dOpConversion,
-                    XTenPartialConv2dReLUOpConversion>(context);
+                    XTenPartialConv2dReLUOpConversion,
+                    XTenConv2dHardswishOpConversion,
+                    XTenConv2dBatchNormOpConversion<Conv2dBatchNormOp>,
+                    XTenConv2dBatchNormOpConversion<Conv2dBatchNormAddReLUOp>,
+                    XTenLinearReLUOpConversion,
+                    XTenQuantizeOpConversion,
+                    XTenDequantizeOpConversion,
+                    XTenQuantizedConv2dOpConversion<Conv2dOp>,
+                    XTenQuantizedConv2dOpConversion<Conv2dReLUOp>,
+                    XTenQuantizedConv2dOpConversion<Conv2dHardswishOp>,
+                    XTenQuantizedMMOpConversion,
+                    XTenQuantizedLinearReLUOpConversion>(context);
 
     ConversionTarget target(*context);
 
     target.addLegalDialect<AffineDialect, linalg::LinalgDialect,
+                           math::MathDialect,
                            memref::MemRefDialect, func::FuncDialect,
                            scf::SCFDialect, Torch::TorchDialect,
                            TorchConversion::TorchConversionDialect>();
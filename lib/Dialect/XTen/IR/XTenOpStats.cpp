@@ -9,6 +9,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
 
 #include "xten/Dialect/XTen/XTenDialect.h"
 #include "xten/Dialect/XTen/XTenOps.h"
@@ -214,6 +215,24 @@ std::map<std::string, uint64_t> getConv2dStatistics<xilinx::xten::PartialConv2dB
     return getConv2dStatisticsWithType(o, resultType);
 }
 
+template<>
+std::map<std::string, uint64_t> getConv2dStatistics<xilinx::xten::PartialConv2dBatchNormOp>(xilinx::xten::PartialConv2dBatchNormOp o) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dStatisticsWithType(o, resultType);
+}
+
+template<>
+std::map<std::string, uint64_t> getConv2dStatistics<xilinx::xten::PartialConv2dBatchNormAddReLUOp>(xilinx::xten::PartialConv2dBatchNormAddReLUOp o) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dStatisticsWithType(o, resultType);
+}
+
+template<>
+std::map<std::string, uint64_t> getConv2dStatistics<xilinx::xten::PartialConv2dHardswishOp>(xilinx::xten::PartialConv2dHardswishOp o) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dStatisticsWithType(o, resultType);
+}
+
 
 // OperandTransferVolume
 template<class T>
@@ -240,6 +259,24 @@ uint64_t getConv2dOperandTransferVolume<xilinx::xten::PartialConv2dBatchNormReLU
     return getConv2dOperandTransferVolumeWithType(o, idx, read, resultType);
 }
 
+template<>
+uint64_t getConv2dOperandTransferVolume<xilinx::xten::PartialConv2dBatchNormOp>(xilinx::xten::PartialConv2dBatchNormOp o, unsigned int idx, bool read) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dOperandTransferVolumeWithType(o, idx, read, resultType);
+}
+
+template<>
+uint64_t getConv2dOperandTransferVolume<xilinx::xten::PartialConv2dBatchNormAddReLUOp>(xilinx::xten::PartialConv2dBatchNormAddReLUOp o, unsigned int idx, bool read) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dOperandTransferVolumeWithType(o, idx, read, resultType);
+}
+
+template<>
+uint64_t getConv2dOperandTransferVolume<xilinx::xten::PartialConv2dHardswishOp>(xilinx::xten::PartialConv2dHardswishOp o, unsigned int idx, bool read) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dOperandTransferVolumeWithType(o, idx, read, resultType);
+}
+
 // ResultTransferVolume
 template<class T>
 uint64_t  getConv2dResultTransferVolume(T o, unsigned int idx, bool write) {
@@ -265,6 +302,37 @@ uint64_t getConv2dResultTransferVolume<xilinx::xten::PartialConv2dBatchNormReLUO
     return getConv2dResultTransferVolumeWithType(o, idx, write, resultType);
 }
 
+template<>
+uint64_t getConv2dResultTransferVolume<xilinx::xten::PartialConv2dBatchNormOp>(xilinx::xten::PartialConv2dBatchNormOp o, unsigned int idx, bool write) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dResultTransferVolumeWithType(o, idx, write, resultType);
+}
+
+template<>
+uint64_t getConv2dResultTransferVolume<xilinx::xten::PartialConv2dBatchNormAddReLUOp>(xilinx::xten::PartialConv2dBatchNormAddReLUOp o, unsigned int idx, bool write) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dResultTransferVolumeWithType(o, idx, write, resultType);
+}
+
+template<>
+uint64_t getConv2dResultTransferVolume<xilinx::xten::PartialConv2dHardswishOp>(xilinx::xten::PartialConv2dHardswishOp o, unsigned int idx, bool write) {
+    TensorType resultType = o.getResult(0).getType().template cast<TensorType>();
+    return getConv2dResultTransferVolumeWithType(o, idx, write, resultType);
+}
+
+
+// Hardswish x * min(max(x + 3, 0), 6) / 6 on top of the convolution
+template<class T>
+std::map<std::string, uint64_t> getConv2dHardswishStatistics(T o) {
+    std::map<std::string, uint64_t> toReturn = getConv2dStatistics<T>(o);
+
+    uint64_t ofm_volume = toReturn["result:0:activation_out"];
+    toReturn["ops:+"] += ofm_volume;
+    toReturn["ops:>"] += 2 * ofm_volume;
+    toReturn["ops:*"] += 2 * ofm_volume;
+
+    return toReturn;
+}
 
 } // namespace
 
@@ -285,6 +353,56 @@ uint64_t Conv2dBatchNormReLUOp::getResultTransferVolume(unsigned int idx, bool w
   return getConv2dResultTransferVolume<Conv2dBatchNormReLUOp>(*this, idx, write);
 }
 
+// acap conv2d bn
+
+std::map<std::string, uint64_t> Conv2dBatchNormOp::getStatistics() {
+  return getConv2dStatistics<Conv2dBatchNormOp>(*this);
+}
+
+uint64_t Conv2dBatchNormOp::getOperandTransferVolume(unsigned int idx, bool read) {
+  return getConv2dOperandTransferVolume<Conv2dBatchNormOp>(*this, idx, read);
+}
+
+uint64_t Conv2dBatchNormOp::getResultTransferVolume(unsigned int idx, bool write) {
+  return getConv2dResultTransferVolume<Conv2dBatchNormOp>(*this, idx, write);
+}
+
+// acap conv2d bn add relu
+
+std::map<std::string, uint64_t> Conv2dBatchNormAddReLUOp::getStatistics() {
+  std::map<std::string, uint64_t> toReturn = getConv2dStatistics<Conv2dBatchNormAddReLUOp>(*this);
+
+  // The residual is read once and added to each output
+  uint64_t residual_volume = xilinx::xten::getTensorVolume(this->residual().getType());
+  toReturn["ops:+"] += residual_volume;
+  toReturn["operand:14:activation_in"] = residual_volume;
+  toReturn["reads"] += residual_volume;
+
+  return toReturn;
+}
+
+uint64_t Conv2dBatchNormAddReLUOp::getOperandTransferVolume(unsigned int idx, bool read) {
+  return getConv2dOperandTransferVolume<Conv2dBatchNormAddReLUOp>(*this, idx, read);
+}
+
+uint64_t Conv2dBatchNormAddReLUOp::getResultTransferVolume(unsigned int idx, bool write) {
+  return getConv2dResultTransferVolume<Conv2dBatchNormAddReLUOp>(*this, idx, write);
+}
+
+// acap conv2d hardswish
+
+std::map<std::string, uint64_t> Conv2dHardswishOp::getStatistics() {
+  return getConv2dHardswishStatistics<Conv2dHardswishOp>(*this);
+}
+
+uint64_t Conv2dHardswishOp::getOperandTransferVolume(unsigned int idx, bool read) {
+  return getConv2dOperandTransferVolume<Conv2dHardswishOp>(*this, idx, read);
+}
+
+uint64_t Conv2dHardswishOp::getResultTransferVolume(unsigned int idx, bool write) {
+  return getConv2dResultTransferVolume<Conv2dHardswishOp>(*this, idx, write);
+}
+
 // acap conv2d relu
 
 std::map<std::string, uint64_t> Conv2dReLUOp::getStatistics() {
@@ -350,6 +468,86 @@ uint64_t Conv2dOp::getResultTransferVolume(unsigned int idx, bool write) {
         return getConv2dResultTransferVolume<PartialConv2dBatchNormReLUOp>(*this, idx, write);
     }
 
+    std::map<std::string, uint64_t> PartialConv2dBatchNormOp::getStatistics() {
+        return getConv2dStatistics<PartialConv2dBatchNormOp>(*this);
+    }
+
+    uint64_t PartialConv2dBatchNormOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return getConv2dOperandTransferVolume<PartialConv2dBatchNormOp>(*this, idx, read);
+    }
+
+    uint64_t PartialConv2dBatchNormOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return getConv2dResultTransferVolume<PartialConv2dBatchNormOp>(*this, idx, write);
+    }
+
+    std::map<std::string, uint64_t> PartialConv2dBatchNormAddReLUOp::getStatistics() {
+        std::map<std::string, uint64_t> toReturn = getConv2dStatistics<PartialConv2dBatchNormAddReLUOp>(*this);
+
+        uint64_t residual_volume = xilinx::xten::getTensorVolume(this->residual().getType());
+        toReturn["ops:+"] += residual_volume;
+        toReturn["operand:15:activation_in"] = residual_volume;
+        toReturn["reads"] += residual_volume;
+
+        return toReturn;
+    }
+
+    uint64_t PartialConv2dBatchNormAddReLUOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return getConv2dOperandTransferVolume<PartialConv2dBatchNormAddReLUOp>(*this, idx, read);
+    }
+
+    uint64_t PartialConv2dBatchNormAddReLUOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return getConv2dResultTransferVolume<PartialConv2dBatchNormAddReLUOp>(*this, idx, write);
+    }
+
+    std::map<std::string, uint64_t> PartialConv2dHardswishOp::getStatistics() {
+        return getConv2dHardswishStatistics<PartialConv2dHardswishOp>(*this);
+    }
+
+    uint64_t PartialConv2dHardswishOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return getConv2dOperandTransferVolume<PartialConv2dHardswishOp>(*this, idx, read);
+    }
+
+    uint64_t PartialConv2dHardswishOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return getConv2dResultTransferVolume<PartialConv2dHardswishOp>(*this, idx, write);
+    }
+
+    std::map<std::string, uint64_t> LinearReLUOp::getStatistics() {
+        std::map<std::string, uint64_t> toReturn;
+
+        TensorType inputTy = this->input().getType().template cast<TensorType>();
+        uint64_t ofm_volume = xilinx::xten::getTensorVolume(this->getResult().getType());
+        uint64_t ifm_volume = xilinx::xten::getTensorVolume(inputTy);
+        uint64_t weight_volume = xilinx::xten::getTensorVolume(this->weight().getType());
+        uint64_t bias_volume = 0;
+        if(this->bias() && !this->bias().getType().isa<mlir::torch::Torch::NoneType>()) {
+            bias_volume = xilinx::xten::getTensorVolume(this->bias().getType());
+        }
+
+        // K MACs per output, then the bias and the ReLU
+        uint64_t K = inputTy.getShape()[inputTy.getRank() - 1];
+        toReturn["ops:MAC"] = ofm_volume * K;
+        toReturn["ops:+"] = ofm_volume;
+        toReturn["ops:>"] = ofm_volume;
+
+        toReturn["operand:0:activation_in"] = ifm_volume;
+        toReturn["result:0:activation_out"] = ofm_volume;
+        toReturn["operand:1:parameters_in:weight"] = weight_volume;
+        toReturn["operand:2:parameters_in:bias"] = bias_volume;
+
+        toReturn["reads"] = ifm_volume + weight_volume + bias_volume;
+        toReturn["writes"] = ofm_volume;
+
+        return toReturn;
+    }
+
+    uint64_t LinearReLUOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return read ? xilinx::xten::getTensorVolume(this->getOperand(idx).getType()) : 0;
+    }
+
+    uint64_t LinearReLUOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return write ? xilinx::xten::getTensorVolume(this->getResult().getType()) : 0;
+    }
+
     std::map<std::string, uint64_t> ConcatOp::getStatistics() {
         std::map<std::string, uint64_t> toReturn;
 
@@ -396,6 +594,90 @@ uint64_t Conv2dOp::getResultTransferVolume(unsigned int idx, bool write) {
         return 0;
     }
 
+    std::map<std::string, uint64_t> SliceOp::getStatistics() {
+        std::map<std::string, uint64_t> toReturn;
+
+        toReturn["ops:+"] = 0;
+        toReturn["ops:MAC"] = 0;
+
+        // NOTE a slice only references its input, data is moved by its users
+        toReturn["reads"] = 0;
+        toReturn["writes"] = 0;
+
+        return toReturn;
+    }
+
+    uint64_t SliceOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return 0;
+    }
+
+    uint64_t SliceOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return 0;
+    }
+
+    std::map<std::string, uint64_t> ExternalConstantOp::getStatistics() {
+        std::map<std::string, uint64_t> toReturn;
+
+        toReturn["ops:+"] = 0;
+        toReturn["ops:MAC"] = 0;
+
+        // NOTE same as a constant, data is moved by its users
+        toReturn["reads"] = 0;
+        toReturn["writes"] = 0;
+
+        return toReturn;
+    }
+
+    uint64_t ExternalConstantOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return 0;
+    }
+
+    uint64_t ExternalConstantOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return 0;
+    }
+
+    std::map<std::string, uint64_t> QuantizeOp::getStatistics() {
+        std::map<std::string, uint64_t> toReturn;
+
+        uint64_t volume = xilinx::xten::getTensorVolume(this->getResult().getType());
+
+        // NOTE one multiply by the scale per element
+        toReturn["ops:*"] = volume;
+        toReturn["reads"] = volume;
+        toReturn["writes"] = volume;
+
+        return toReturn;
+    }
+
+    uint64_t QuantizeOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return read ? xilinx::xten::getTensorVolume(this->input().getType()) : 0;
+    }
+
+    uint64_t QuantizeOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return write ? xilinx::xten::getTensorVolume(this->getResult().getType()) : 0;
+    }
+
+    std::map<std::string, uint64_t> DequantizeOp::getStatistics() {
+        std::map<std::string, uint64_t> toReturn;
+
+        uint64_t volume = xilinx::xten::getTensorVolume(this->getResult().getType());
+
+        // NOTE one multiply by the scale per element
+        toReturn["ops:*"] = volume;
+        toReturn["reads"] = volume;
+        toReturn["writes"] = volume;
+
+        return toReturn;
+    }
+
+    uint64_t DequantizeOp::getOperandTransferVolume(unsigned int idx, bool read) {
+        return read ? xilinx::xten::getTensorVolume(this->input().getType()) : 0;
+    }
+
+    uint64_t DequantizeOp::getResultTransferVolume(unsigned int idx, bool write) {
+        return write ? xilinx::xten::getTensorVolume(this->getResult().getType()) : 0;
+    }
+
 
 }
 }
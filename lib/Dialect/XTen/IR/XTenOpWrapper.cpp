@@ -22,6 +22,17 @@ using namespace mlir::torch;
 namespace xilinx {
     namespace xten {
 
+        // Constant, externalized constant or slice of one of them, graph inputs are activations
+        static bool isConstantWeights(Value v) {
+            if(auto slice = v.getDefiningOp<SliceOp>()) {
+                v = slice.input();
+            }
+
+            Operation* def = v.getDefiningOp();
+            return (def != nullptr) && (llvm::isa<mlir::arith::ConstantOp>(def) || llvm::isa<Torch::ValueTensorLiteralOp>(def) ||
+                                        llvm::isa<ExternalConstantOp>(def));
+        }
+
         AbsOpWrapper::~AbsOpWrapper() {}
 
         Conv2dOpWrapper::Conv2dOpWrapper(Conv2dOp c) {
@@ -54,6 +65,10 @@ namespace xilinx {
             return Value();
         }
 
+        Value Conv2dOpWrapper::getResidual() {
+            return Value();
+        }
+
         unsigned int Conv2dOpWrapper::getF0() {
             return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
@@ -107,7 +122,7 @@ namespace xilinx {
 
         Operation* Conv2dOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                             llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                            llvm::Optional<ArrayRef<Value>> bn) {
+                                            llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
             assert(weight.hasValue());
 
             if(this->hasBias()) {
@@ -216,6 +231,10 @@ namespace xilinx {
             return this->conv.PartialIn();
         }
 
+        Value PartialConv2dOpWrapper::getResidual() {
+            return Value();
+        }
+
         unsigned int PartialConv2dOpWrapper::getF0() {
             return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
@@ -264,7 +283,7 @@ namespace xilinx {
 
         Operation* PartialConv2dOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                                    llvm::Optional<Value> bias, llvm::Optional<Value> partialIn,
-                                                   bool firstInPartialChain, llvm::Optional<ArrayRef<Value>> bn) {
+                                                   bool firstInPartialChain, llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
             assert(weight.hasValue());
             if(this->hasBias()) {
                 assert(bias.hasValue());
@@ -365,6 +384,10 @@ namespace xilinx {
             return Value();
         }
 
+        Value Conv2dReLUOpWrapper::getResidual() {
+            return Value();
+        }
+
         unsigned int Conv2dReLUOpWrapper::getF0() {
             return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
@@ -414,7 +437,7 @@ namespace xilinx {
 
         Operation* Conv2dReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
                                                 llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                                llvm::Optional<ArrayRef<Value>> bn) {
+                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
             assert(weight.hasValue());
 
             if(this->hasBias()) {
@@ -521,6 +544,10 @@ namespace xilinx {
             return this->conv.PartialIn();
         }
 
+        Value PartialConv2dReLUOpWrapper::getResidual() {
+            return Value();
+        }
+
         unsigned int PartialConv2dReLUOpWrapper::getF0() {
             return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
@@ -571,7 +598,7 @@ namespace xilinx {
         Operation* PartialConv2dReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
                                                        llvm::Optional<Value> weight, llvm::Optional<Value> bias,
                                                        llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                                       llvm::Optional<ArrayRef<Value>> bn) {
+                                                       llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
             assert(weight.hasValue());
 
             if(this->hasBias()) {
@@ -672,6 +699,10 @@ namespace xilinx {
             return this->conv.PartialIn();
         }
 
+        Value PartialConv2dBatchNormReLUOpWrapper::getResidual() {
+            return Value();
+        }
+
         unsigned int PartialConv2dBatchNormReLUOpWrapper::getF0() {
             return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
@@ -722,7 +753,7 @@ namespace xilinx {
         Operation* PartialConv2dBatchNormReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
                                                                 llvm::Optional<Value> weight, llvm::Optional<Value> bias,
                                                                 llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                                                llvm::Optional<ArrayRef<Value>> bn) {
+                                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
             assert(weight.hasValue());
             assert(bn.hasValue());
 
@@ -846,6 +877,10 @@ namespace xilinx {
             return Value();
         }
 
+        Value Conv2dBatchNormReLUOpWrapper::getResidual() {
+            return Value();
+        }
+
         unsigned int Conv2dBatchNormReLUOpWrapper::getF0() {
             return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
@@ -896,7 +931,7 @@ namespace xilinx {
         Operation* Conv2dBatchNormReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
                                                                 llvm::Optional<Value> weight, llvm::Optional<Value> bias,
                                                                 llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                                                llvm::Optional<ArrayRef<Value>> bn) {
+                                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
             assert(weight.hasValue());
             assert(bn.hasValue());
 
@@ -1004,113 +1039,156 @@ namespace xilinx {
             return op;
         }
 
-        MaxPool2dOpWrapper::MaxPool2dOpWrapper(Torch::AtenMaxPool2dOp mp) {
-            maxpool = mp;
+        Conv2dHardswishOpWrapper::Conv2dHardswishOpWrapper(Conv2dHardswishOp c) {
+            conv = c;
         }
 
-        MaxPool2dOpWrapper::~MaxPool2dOpWrapper() {}
+        Conv2dHardswishOpWrapper::~Conv2dHardswishOpWrapper() {}
 
+        Operation* Conv2dHardswishOpWrapper::getUnderlyingOperation() {
+            return conv.getOperation();
+        }
 
-        Operation* MaxPool2dOpWrapper::getUnderlyingOperation() {
-            return maxpool.getOperation();
+        Value Conv2dHardswishOpWrapper::getWeights() {
+            return this->conv.weight();
         }
 
-        Value MaxPool2dOpWrapper::getWeights() {
-            return Value();
+        ArrayRef<Value> Conv2dHardswishOpWrapper::getBN() {
+            return ArrayRef<Value>();
         }
 
-        Optional<Value> MaxPool2dOpWrapper::getBiases() {
-            return Optional<Value>{};
+        Optional<Value> Conv2dHardswishOpWrapper::getBiases() {
+            return this->conv.bias();
         }
 
-        unsigned int MaxPool2dOpWrapper::getF0() {
-            Value ks = this->maxpool.kernel_size();
-            SmallVector<int64_t,2> kernel_size;
-            matchPattern(ks, Torch::m_TorchConstantIntList(kernel_size));
+        Value Conv2dHardswishOpWrapper::getInput() {
+            return this->conv.input();
+        }
 
-            return kernel_size[0];
+        Value Conv2dHardswishOpWrapper::getPartialInput() {
+            return Value();
         }
 
-        unsigned int MaxPool2dOpWrapper::getF1() {
-            Value ks = this->maxpool.kernel_size();
-            SmallVector<int64_t,2> kernel_size;
-            matchPattern(ks, Torch::m_TorchConstantIntList(kernel_size));
+        Value Conv2dHardswishOpWrapper::getResidual() {
+            return Value();
+        }
 
-            return kernel_size[1];
+        unsigned int Conv2dHardswishOpWrapper::getF0() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
         }
 
-        unsigned int MaxPool2dOpWrapper::getStride() {
-            Value s = this->maxpool.stride();
+        unsigned int Conv2dHardswishOpWrapper::getF1() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F1_LOC];
+        }
+
+        unsigned int Conv2dHardswishOpWrapper::getStride() {
+            Value s = this->conv.stride();
             SmallVector<int64_t,2> stride;
             matchPattern(s, Torch::m_TorchConstantIntList(stride));
 
             return stride[0];
         }
 
-        Value MaxPool2dOpWrapper::getInput() {
-            return this->maxpool.self();
-        }
-
-        Value MaxPool2dOpWrapper::getPartialInput() {
-            return Value();
+        bool Conv2dHardswishOpWrapper::hasWeights() {
+            return true;
         }
 
-        ArrayRef<Value> MaxPool2dOpWrapper::getBN() {
-            return ArrayRef<Value>();
+        bool Conv2dHardswishOpWrapper::hasBias() {
+            return this->getBiases().hasValue();
         }
 
-        bool MaxPool2dOpWrapper::hasWeights() {
+        bool Conv2dHardswishOpWrapper::hasBN() {
             return false;
         }
 
-        bool MaxPool2dOpWrapper::hasBias() {
-            return false;
-        }
+        bool Conv2dHardswishOpWrapper::isDepthWise() {
+            llvm::APInt intT = this->conv.groups().getDefiningOp<mlir::torch::Torch::ConstantIntOp>().value();
+            unsigned int groups = intT.getSExtValue();
+            mlir::torch::Torch::BaseTensorType aShape = this->conv.input().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            ArrayRef<int64_t> aShapeAR = aShape.getSizes();
 
-        bool MaxPool2dOpWrapper::isDepthWise() {
-            return true;
-        }
+            int64_t C = aShapeAR[C_LOC];
 
-        bool MaxPool2dOpWrapper::hasBN() {
-            return false;
+            return groups == C;
         }
 
-        double MaxPool2dOpWrapper::getKernelEfficiency() {
-            return 0.25;
+        double Conv2dHardswishOpWrapper::getKernelEfficiency() {
+            if(this->isDepthWise()) {
+                return 0.30;
+            } else {
+                return 0.90;
+            }
         }
 
-        Operation* MaxPool2dOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
-                                                          llvm::Optional<Value> weight, llvm::Optional<Value> bias,
-                                                          llvm::Optional<Value> partialIn, bool firstInPartialChain,
-                                                          llvm::Optional<ArrayRef<Value>> bn) {
-            assert(!weight.hasValue());
-            assert(!bias.hasValue());
-            assert(!firstInPartialChain);
-            assert(!partialIn.hasValue());
+        Operation* Conv2dHardswishOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input, llvm::Optional<Value> weight,
+                                                llvm::Optional<Value> bias, llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(weight.hasValue());
+
+            if(this->hasBias()) {
+                assert(bias.hasValue());
+            }
 
             Operation* op = this->getUnderlyingOperation();
-            Operation* nOp =  builder.create<Torch::AtenMaxPool2dOp>(builder.getUnknownLoc(), returnType, input,
-                                                                     this->maxpool.kernel_size(),
-                                                                     this->maxpool.stride(),
-                                                                     this->maxpool.padding(),
-                                                                     this->maxpool.dilation(),
-                                                                     this->maxpool.ceil_mode());
+            Value biasVal = (bias.hasValue()) ? bias.getValue() : this->conv.bias();
 
-            nOp->setAttrs(op->getAttrs());
-            return nOp;
+            if(firstInPartialChain || partialIn.hasValue()) {
+                Value chainIn = (partialIn.hasValue()) ? partialIn.getValue() : Value();
+                Operation* nOp =  builder.create<PartialConv2dHardswishOp>(builder.getUnknownLoc(),
+                                                                      returnType,
+                                                                      input,
+                                                                      chainIn,
+                                                                      weight.getValue(),
+                                                                      biasVal,
+                                                                      this->conv.stride(),
+                                                                      this->conv.padding(),
+                                                                      this->conv.dilation(),
+                                                                      this->conv.groups());
+
+                nOp->setAttrs(op->getAttrs());
+                return nOp;
+            } else {
+                Operation* nOp = builder.create<Conv2dHardswishOp>(builder.getUnknownLoc(),
+                                                              returnType,
+                                                              input,
+                                                              weight.getValue(),
+                                                              biasVal,
+                                                              this->conv.stride(),
+                                                              this->conv.padding(),
+                                                              this->conv.dilation(),
+                                                              this->conv.groups());
+
+                nOp->setAttrs(op->getAttrs());
+                return nOp;
+            }
         }
 
-        Operation* MaxPool2dOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> typeRes) {
-            assert(!typeRes.hasValue());
+        Operation* Conv2dHardswishOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) {
+            Operation* op;
+
+            if(resTypes.hasValue()) {
+                op =  builder.create<PartialConv2dHardswishOp>(builder.getUnknownLoc(),
+                                                          resTypes.getValue(),
+                                                          this->getInput(),
+                                                          Value(),
+                                                          this->getWeights(),
+                                                          this->getBiases().getValueOr(nullptr),
+                                                          this->conv.stride(),
+                                                          this->conv.padding(),
+                                                          this->conv.dilation(),
+                                                          this->conv.groups());
+            } else {
+                op = builder.create<Conv2dHardswishOp>(builder.getUnknownLoc(),
+                                                  this->getUnderlyingOperation()->getResultTypes(),
+                                                  this->getInput(),
+                                                  this->getWeights(),
+                                                  this->getBiases().getValueOr(nullptr),
+                                                  this->conv.stride(),
+                                                  this->conv.padding(),
+                                                  this->conv.dilation(),
+                                                  this->conv.groups());
+            }
 
-            Operation* op =  builder.create<Torch::AtenMaxPool2dOp>(builder.getUnknownLoc(),
-                                                                    this->getUnderlyingOperation()->getResultTypes(),
-                                                                    this->getInput(),
-                                                                    this->maxpool.kernel_size(),
-                                                                    this->maxpool.stride(),
-                                                                    this->maxpool.padding(),
-                                                                    this->maxpool.dilation(),
-                                                                    this->maxpool.ceil_mode());
 
             op->setAttrs(this->getUnderlyingOperation()->getAttrs());
 
@@ -1121,6 +1199,1452 @@ namespace xilinx {
             return op;
         }
 
+        PartialConv2dHardswishOpWrapper::PartialConv2dHardswishOpWrapper(PartialConv2dHardswishOp c) {
+            conv = c;
+        }
+
+        PartialConv2dHardswishOpWrapper::~PartialConv2dHardswishOpWrapper() {}
+
+        Operation* PartialConv2dHardswishOpWrapper::getUnderlyingOperation() {
+            return conv.getOperation();
+        }
+
+        Value PartialConv2dHardswishOpWrapper::getWeights() {
+            return this->conv.weight();
+        }
+
+        ArrayRef<Value> PartialConv2dHardswishOpWrapper::getBN() {
+            return ArrayRef<Value>();
+        }
+
+        Optional<Value> PartialConv2dHardswishOpWrapper::getBiases() {
+            return this->conv.bias();
+        }
+
+        Value PartialConv2dHardswishOpWrapper::getInput() {
+            return this->conv.input();
+        }
+
+        Value PartialConv2dHardswishOpWrapper::getPartialInput() {
+            return this->conv.PartialIn();
+        }
+
+        Value PartialConv2dHardswishOpWrapper::getResidual() {
+            return Value();
+        }
+
+        unsigned int PartialConv2dHardswishOpWrapper::getF0() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
+        }
+
+        unsigned int PartialConv2dHardswishOpWrapper::getF1() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F1_LOC];
+        }
+
+        unsigned int PartialConv2dHardswishOpWrapper::getStride() {
+            Value s = this->conv.stride();
+            SmallVector<int64_t,2> stride;
+            matchPattern(s, Torch::m_TorchConstantIntList(stride));
+
+            return stride[0];
+        }
+
+        bool PartialConv2dHardswishOpWrapper::hasWeights() {
+            return true;
+        }
+
+        bool PartialConv2dHardswishOpWrapper::hasBias() {
+            return this->getBiases().hasValue();
+        }
+
+        bool PartialConv2dHardswishOpWrapper::hasBN() {
+            return false;
+        }
+
+        bool PartialConv2dHardswishOpWrapper::isDepthWise() {
+            llvm::APInt intT = this->conv.groups().getDefiningOp<mlir::torch::Torch::ConstantIntOp>().value();
+            unsigned int groups = intT.getSExtValue();
+            mlir::torch::Torch::BaseTensorType aShape = this->conv.input().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            ArrayRef<int64_t> aShapeAR = aShape.getSizes();
+
+            int64_t C = aShapeAR[C_LOC];
+
+            return groups == C;
+        }
+
+        double PartialConv2dHardswishOpWrapper::getKernelEfficiency() {
+            if(this->isDepthWise()) {
+                return 0.30;
+            } else {
+                return 0.90;
+            }
+        }
+
+        Operation* PartialConv2dHardswishOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                       llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                       llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                       llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(weight.hasValue());
+
+            if(this->hasBias()) {
+                assert(bias.hasValue());
+            }
+
+            Value chainIn;
+            if(partialIn.hasValue()) {
+                chainIn = partialIn.getValue();
+            } else if(this->conv.PartialIn()){
+                chainIn = this->conv.PartialIn();
+            } else {
+                chainIn = Value();
+            }
+
+            Value biasVal = bias.hasValue() ? bias.getValue() : this->conv.bias();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp = builder.create<PartialConv2dHardswishOp>(builder.getUnknownLoc(),
+                                                                 returnType,
+                                                                 input,
+                                                                 chainIn,
+                                                                 weight.getValue(),
+                                                                 biasVal,
+                                                                 this->conv.stride(),
+                                                                 this->conv.padding(),
+                                                                 this->conv.dilation(),
+                                                                 this->conv.groups());
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* PartialConv2dHardswishOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) {
+            Operation* op;
+
+            if(resTypes.hasValue()) {
+                op = builder.create<PartialConv2dHardswishOp>(builder.getUnknownLoc(),
+                                                         resTypes.getValue(),
+                                                         this->getInput(),
+                                                         this->conv.PartialIn(),
+                                                         this->getWeights(),
+                                                         this->getBiases().getValueOr(nullptr),
+                                                         this->conv.stride(),
+                                                         this->conv.padding(),
+                                                         this->conv.dilation(),
+                                                         this->conv.groups());
+            } else {
+                op = builder.create<PartialConv2dHardswishOp>(builder.getUnknownLoc(),
+                                                         this->getUnderlyingOperation()->getResultTypes(),
+                                                         this->getInput(),
+                                                         this->conv.PartialIn(),
+                                                         this->getWeights(),
+                                                         this->getBiases().getValueOr(nullptr),
+                                                         this->conv.stride(),
+                                                         this->conv.padding(),
+                                                         this->conv.dilation(),
+                                                         this->conv.groups());
+            }
+
+
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        PartialConv2dBatchNormOpWrapper::PartialConv2dBatchNormOpWrapper(PartialConv2dBatchNormOp c) {
+            conv = c;
+        }
+
+        PartialConv2dBatchNormOpWrapper::~PartialConv2dBatchNormOpWrapper() {}
+
+        Operation* PartialConv2dBatchNormOpWrapper::getUnderlyingOperation() {
+            return conv.getOperation();
+        }
+
+        Value PartialConv2dBatchNormOpWrapper::getWeights() {
+            return this->conv.weight();
+        }
+
+        ArrayRef<Value> PartialConv2dBatchNormOpWrapper::getBN() {
+            return ArrayRef<Value>({this->conv.bn_weight(), this->conv.bn_bias(), this->conv.running_mean(), this->conv.running_var()});
+        }
+
+        Optional<Value> PartialConv2dBatchNormOpWrapper::getBiases() {
+            return this->conv.bias();
+        }
+
+        Value PartialConv2dBatchNormOpWrapper::getInput() {
+            return this->conv.input();
+        }
+
+        Value PartialConv2dBatchNormOpWrapper::getPartialInput() {
+            return this->conv.PartialIn();
+        }
+
+        Value PartialConv2dBatchNormOpWrapper::getResidual() {
+            return Value();
+        }
+
+        unsigned int PartialConv2dBatchNormOpWrapper::getF0() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
+        }
+
+        unsigned int PartialConv2dBatchNormOpWrapper::getF1() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F1_LOC];
+        }
+
+        unsigned int PartialConv2dBatchNormOpWrapper::getStride() {
+            Value s = this->conv.stride();
+            SmallVector<int64_t,2 > stride;
+            matchPattern(s, Torch::m_TorchConstantIntList(stride));
+
+            return stride[0];
+        }
+
+        bool PartialConv2dBatchNormOpWrapper::hasWeights() {
+            return true;
+        }
+
+        bool PartialConv2dBatchNormOpWrapper::hasBias() {
+            return this->getBiases().hasValue();
+        }
+
+        bool PartialConv2dBatchNormOpWrapper::hasBN() {
+            return true;
+        }
+
+        bool PartialConv2dBatchNormOpWrapper::isDepthWise() {
+            llvm::APInt intT = this->conv.groups().getDefiningOp<mlir::torch::Torch::ConstantIntOp>().value();
+            unsigned int groups = intT.getSExtValue();
+            mlir::torch::Torch::BaseTensorType aShape = this->conv.input().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            ArrayRef<int64_t> aShapeAR = aShape.getSizes();
+
+            int64_t C = aShapeAR[C_LOC];
+
+            return groups == C;
+        }
+
+        double PartialConv2dBatchNormOpWrapper::getKernelEfficiency() {
+            if(this->isDepthWise()) {
+                return 0.30;
+            } else {
+                return 0.90;
+            }
+        }
+
+        Operation* PartialConv2dBatchNormOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                                llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                                llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(weight.hasValue());
+            assert(bn.hasValue());
+
+            if(this->hasBias()) {
+                assert(bias.hasValue());
+            }
+
+            Value chainIn;
+            if(partialIn.hasValue()) {
+                chainIn = partialIn.getValue();
+            } else if(this->conv.PartialIn()){
+                chainIn = this->conv.PartialIn();
+            } else {
+                chainIn = Value();
+            }
+
+            Value biasVal = bias.hasValue() ? bias.getValue() : this->conv.bias();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp = builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                          returnType,
+                                                                          input,
+                                                                          chainIn,
+                                                                          weight.getValue(),
+                                                                          biasVal,
+                                                                          this->conv.stride(),
+                                                                          this->conv.padding(),
+                                                                          this->conv.dilation(),
+                                                                          this->conv.groups(),
+                                                                          bn.getValue()[0],
+                                                                          bn.getValue()[1],
+                                                                          bn.getValue()[2],
+                                                                          bn.getValue()[3],
+                                                                          this->conv.training(),
+                                                                          this->conv.momentum(),
+                                                                          this->conv.eps());
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* PartialConv2dBatchNormOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) {
+            Operation* op;
+            if(resTypes.hasValue()) {
+                op = builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                  resTypes.getValue(),
+                                                                  this->getInput(),
+                                                                  this->conv.PartialIn(),
+                                                                  this->getWeights(),
+                                                                  this->getBiases().getValueOr(nullptr),
+                                                                  this->conv.stride(),
+                                                                  this->conv.padding(),
+                                                                  this->conv.dilation(),
+                                                                  this->conv.groups(),
+                                                                  this->conv.bn_weight(),
+                                                                  this->conv.bn_bias(),
+                                                                  this->conv.running_mean(),
+                                                                  this->conv.running_var(),
+                                                                  this->conv.training(),
+                                                                  this->conv.momentum(),
+                                                                  this->conv.eps());
+            } else {
+                op = builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                  this->getUnderlyingOperation()->getResultTypes(),
+                                                                  this->getInput(),
+                                                                  this->conv.PartialIn(),
+                                                                  this->getWeights(),
+                                                                  this->getBiases().getValueOr(nullptr),
+                                                                  this->conv.stride(),
+                                                                  this->conv.padding(),
+                                                                  this->conv.dilation(),
+                                                                  this->conv.groups(),
+                                                                  this->conv.bn_weight(),
+                                                                  this->conv.bn_bias(),
+                                                                  this->conv.running_mean(),
+                                                                  this->conv.running_var(),
+                                                                  this->conv.training(),
+                                                                  this->conv.momentum(),
+                                                                  this->conv.eps());
+            }
+
+
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+
+        Conv2dBatchNormOpWrapper::Conv2dBatchNormOpWrapper(Conv2dBatchNormOp c) {
+            conv = c;
+        }
+
+        Conv2dBatchNormOpWrapper::~Conv2dBatchNormOpWrapper() {}
+
+        Operation* Conv2dBatchNormOpWrapper::getUnderlyingOperation() {
+            return conv.getOperation();
+        }
+
+        Value Conv2dBatchNormOpWrapper::getWeights() {
+            return this->conv.weight();
+        }
+
+        ArrayRef<Value> Conv2dBatchNormOpWrapper::getBN() {
+            return ArrayRef<Value>({this->conv.bn_weight(), this->conv.bn_bias(), this->conv.running_mean(), this->conv.running_var()});
+        }
+
+        Optional<Value> Conv2dBatchNormOpWrapper::getBiases() {
+            return this->conv.bias();
+        }
+
+        Value Conv2dBatchNormOpWrapper::getInput() {
+            return this->conv.input();
+        }
+
+        Value Conv2dBatchNormOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value Conv2dBatchNormOpWrapper::getResidual() {
+            return Value();
+        }
+
+        unsigned int Conv2dBatchNormOpWrapper::getF0() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
+        }
+
+        unsigned int Conv2dBatchNormOpWrapper::getF1() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F1_LOC];
+        }
+
+        unsigned int Conv2dBatchNormOpWrapper::getStride() {
+            Value s = this->conv.stride();
+            SmallVector<int64_t,2> stride;
+            matchPattern(s, Torch::m_TorchConstantIntList(stride));
+
+            return stride[0];
+        }
+
+        bool Conv2dBatchNormOpWrapper::hasWeights() {
+            return true;
+        }
+
+        bool Conv2dBatchNormOpWrapper::hasBias() {
+            return this->getBiases().hasValue();
+        }
+
+        bool Conv2dBatchNormOpWrapper::hasBN() {
+            return true;
+        }
+
+        bool Conv2dBatchNormOpWrapper::isDepthWise() {
+            llvm::APInt intT = this->conv.groups().getDefiningOp<mlir::torch::Torch::ConstantIntOp>().value();
+            unsigned int groups = intT.getSExtValue();
+            mlir::torch::Torch::BaseTensorType aShape = this->conv.input().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            ArrayRef<int64_t> aShapeAR = aShape.getSizes();
+
+            int64_t C = aShapeAR[C_LOC];
+
+            return groups == C;
+        }
+
+        double Conv2dBatchNormOpWrapper::getKernelEfficiency() {
+            if(this->isDepthWise()) {
+                return 0.30;
+            } else {
+                return 0.90;
+            }
+        }
+
+        Operation* Conv2dBatchNormOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                                llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                                llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(weight.hasValue());
+            assert(bn.hasValue());
+
+            if(this->hasBias()) {
+                assert(bias.hasValue());
+            }
+
+            Value biasVal = bias.hasValue() ? bias.getValue() : this->conv.bias();
+
+            Operation* op = this->getUnderlyingOperation();
+            if(firstInPartialChain || partialIn.hasValue()) {
+                Value chainIn = (partialIn.hasValue()) ? partialIn.getValue() : Value();
+                Operation* nOp =  builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                               returnType,
+                                                                               input,
+                                                                               chainIn,
+                                                                               weight.getValue(),
+                                                                               biasVal,
+                                                                               this->conv.stride(),
+                                                                               this->conv.padding(),
+                                                                               this->conv.dilation(),
+                                                                               this->conv.groups(),
+                                                                               bn.getValue()[0],
+                                                                               bn.getValue()[1],
+                                                                               bn.getValue()[2],
+                                                                               bn.getValue()[3],
+                                                                               this->conv.training(),
+                                                                               this->conv.momentum(),
+                                                                               this->conv.eps());
+                nOp->setAttrs(op->getAttrs());
+
+                return nOp;
+            } else {
+                Operation* nOp = builder.create<Conv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                       returnType,
+                                                                       input,
+                                                                       weight.getValue(),
+                                                                       biasVal,
+                                                                       this->conv.stride(),
+                                                                       this->conv.padding(),
+                                                                       this->conv.dilation(),
+                                                                       this->conv.groups(),
+                                                                       bn.getValue()[0],
+                                                                       bn.getValue()[1],
+                                                                       bn.getValue()[2],
+                                                                       bn.getValue()[3],
+                                                                       this->conv.training(),
+                                                                       this->conv.momentum(),
+                                                                       this->conv.eps());
+
+                nOp->setAttrs(op->getAttrs());
+
+                return nOp;
+            }
+        }
+
+        Operation* Conv2dBatchNormOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) {
+            Operation* op;
+
+            if(resTypes.hasValue()) {
+                op =  builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                   resTypes.getValue(),
+                                                                   this->getInput(),
+                                                                   Value(),
+                                                                   this->getWeights(),
+                                                                   this->getBiases().getValueOr(nullptr),
+                                                                   this->conv.stride(),
+                                                                   this->conv.padding(),
+                                                                   this->conv.dilation(),
+                                                                   this->conv.groups(),
+                                                                   this->conv.bn_weight(),
+                                                                   this->conv.bn_bias(),
+                                                                   this->conv.running_mean(),
+                                                                   this->conv.running_var(),
+                                                                   this->conv.training(),
+                                                                   this->conv.momentum(),
+                                                                   this->conv.eps());
+            } else {
+                op = builder.create<Conv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                           this->getUnderlyingOperation()->getResultTypes(),
+                                                           this->getInput(),
+                                                           this->getWeights(),
+                                                           this->getBiases().getValueOr(nullptr),
+                                                           this->conv.stride(),
+                                                           this->conv.padding(),
+                                                           this->conv.dilation(),
+                                                           this->conv.groups(),
+                                                           this->conv.bn_weight(),
+                                                           this->conv.bn_bias(),
+                                                           this->conv.running_mean(),
+                                                           this->conv.running_var(),
+                                                           this->conv.training(),
+                                                           this->conv.momentum(),
+                                                           this->conv.eps());
+            }
+
+
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        Conv2dBatchNormAddReLUOpWrapper::Conv2dBatchNormAddReLUOpWrapper(Conv2dBatchNormAddReLUOp c) {
+            conv = c;
+        }
+
+        Conv2dBatchNormAddReLUOpWrapper::~Conv2dBatchNormAddReLUOpWrapper() {}
+
+        Operation* Conv2dBatchNormAddReLUOpWrapper::getUnderlyingOperation() {
+            return conv.getOperation();
+        }
+
+        Value Conv2dBatchNormAddReLUOpWrapper::getWeights() {
+            return this->conv.weight();
+        }
+
+        ArrayRef<Value> Conv2dBatchNormAddReLUOpWrapper::getBN() {
+            return ArrayRef<Value>({this->conv.bn_weight(), this->conv.bn_bias(), this->conv.running_mean(), this->conv.running_var()});
+        }
+
+        Optional<Value> Conv2dBatchNormAddReLUOpWrapper::getBiases() {
+            return this->conv.bias();
+        }
+
+        Value Conv2dBatchNormAddReLUOpWrapper::getInput() {
+            return this->conv.input();
+        }
+
+        Value Conv2dBatchNormAddReLUOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value Conv2dBatchNormAddReLUOpWrapper::getResidual() {
+            return this->conv.residual();
+        }
+
+        unsigned int Conv2dBatchNormAddReLUOpWrapper::getF0() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
+        }
+
+        unsigned int Conv2dBatchNormAddReLUOpWrapper::getF1() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F1_LOC];
+        }
+
+        unsigned int Conv2dBatchNormAddReLUOpWrapper::getStride() {
+            Value s = this->conv.stride();
+            SmallVector<int64_t,2> stride;
+            matchPattern(s, Torch::m_TorchConstantIntList(stride));
+
+            return stride[0];
+        }
+
+        bool Conv2dBatchNormAddReLUOpWrapper::hasWeights() {
+            return true;
+        }
+
+        bool Conv2dBatchNormAddReLUOpWrapper::hasBias() {
+            return this->getBiases().hasValue();
+        }
+
+        bool Conv2dBatchNormAddReLUOpWrapper::hasBN() {
+            return true;
+        }
+
+        bool Conv2dBatchNormAddReLUOpWrapper::isDepthWise() {
+            llvm::APInt intT = this->conv.groups().getDefiningOp<mlir::torch::Torch::ConstantIntOp>().value();
+            unsigned int groups = intT.getSExtValue();
+            mlir::torch::Torch::BaseTensorType aShape = this->conv.input().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            ArrayRef<int64_t> aShapeAR = aShape.getSizes();
+
+            int64_t C = aShapeAR[C_LOC];
+
+            return groups == C;
+        }
+
+        double Conv2dBatchNormAddReLUOpWrapper::getKernelEfficiency() {
+            if(this->isDepthWise()) {
+                return 0.30;
+            } else {
+                return 0.90;
+            }
+        }
+
+        Operation* Conv2dBatchNormAddReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                                llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                                llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(weight.hasValue());
+            assert(bn.hasValue());
+
+            if(this->hasBias()) {
+                assert(bias.hasValue());
+            }
+
+            Value biasVal = bias.hasValue() ? bias.getValue() : this->conv.bias();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp;
+            if(firstInPartialChain || partialIn.hasValue()) {
+                Value chainIn = (partialIn.hasValue()) ? partialIn.getValue() : Value();
+                if(residual.hasValue()) {
+                    nOp = builder.create<PartialConv2dBatchNormAddReLUOp>(builder.getUnknownLoc(),
+                                                                          returnType,
+                                                                          input,
+                                                                          chainIn,
+                                                                          weight.getValue(),
+                                                                          biasVal,
+                                                                          this->conv.stride(),
+                                                                          this->conv.padding(),
+                                                                          this->conv.dilation(),
+                                                                          this->conv.groups(),
+                                                                          bn.getValue()[0],
+                                                                          bn.getValue()[1],
+                                                                          bn.getValue()[2],
+                                                                          bn.getValue()[3],
+                                                                          this->conv.training(),
+                                                                          this->conv.momentum(),
+                                                                          this->conv.eps(),
+                                                                          residual.getValue());
+                } else {
+                    nOp = builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                                   returnType,
+                                                                   input,
+                                                                   chainIn,
+                                                                   weight.getValue(),
+                                                                   biasVal,
+                                                                   this->conv.stride(),
+                                                                   this->conv.padding(),
+                                                                   this->conv.dilation(),
+                                                                   this->conv.groups(),
+                                                                   bn.getValue()[0],
+                                                                   bn.getValue()[1],
+                                                                   bn.getValue()[2],
+                                                                   bn.getValue()[3],
+                                                                   this->conv.training(),
+                                                                   this->conv.momentum(),
+                                                                   this->conv.eps());
+                }
+            } else {
+                nOp = builder.create<Conv2dBatchNormAddReLUOp>(builder.getUnknownLoc(),
+                                                               returnType,
+                                                               input,
+                                                               weight.getValue(),
+                                                               biasVal,
+                                                               this->conv.stride(),
+                                                               this->conv.padding(),
+                                                               this->conv.dilation(),
+                                                               this->conv.groups(),
+                                                               bn.getValue()[0],
+                                                               bn.getValue()[1],
+                                                               bn.getValue()[2],
+                                                               bn.getValue()[3],
+                                                               this->conv.training(),
+                                                               this->conv.momentum(),
+                                                               this->conv.eps(),
+                                                               residual.getValueOr(this->conv.residual()));
+            }
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* Conv2dBatchNormAddReLUOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) {
+            Operation* op;
+
+            if(resTypes.hasValue()) {
+                op =  builder.create<PartialConv2dBatchNormAddReLUOp>(builder.getUnknownLoc(),
+                                                                      resTypes.getValue(),
+                                                                      this->getInput(),
+                                                                      Value(),
+                                                                      this->getWeights(),
+                                                                      this->getBiases().getValueOr(nullptr),
+                                                                      this->conv.stride(),
+                                                                      this->conv.padding(),
+                                                                      this->conv.dilation(),
+                                                                      this->conv.groups(),
+                                                                      this->conv.bn_weight(),
+                                                                      this->conv.bn_bias(),
+                                                                      this->conv.running_mean(),
+                                                                      this->conv.running_var(),
+                                                                      this->conv.training(),
+                                                                      this->conv.momentum(),
+                                                                      this->conv.eps(),
+                                                                      this->conv.residual());
+            } else {
+                op = builder.create<Conv2dBatchNormAddReLUOp>(builder.getUnknownLoc(),
+                                                              this->getUnderlyingOperation()->getResultTypes(),
+                                                              this->getInput(),
+                                                              this->getWeights(),
+                                                              this->getBiases().getValueOr(nullptr),
+                                                              this->conv.stride(),
+                                                              this->conv.padding(),
+                                                              this->conv.dilation(),
+                                                              this->conv.groups(),
+                                                              this->conv.bn_weight(),
+                                                              this->conv.bn_bias(),
+                                                              this->conv.running_mean(),
+                                                              this->conv.running_var(),
+                                                              this->conv.training(),
+                                                              this->conv.momentum(),
+                                                              this->conv.eps(),
+                                                              this->conv.residual());
+            }
+
+
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        PartialConv2dBatchNormAddReLUOpWrapper::PartialConv2dBatchNormAddReLUOpWrapper(PartialConv2dBatchNormAddReLUOp c) {
+            conv = c;
+        }
+
+        PartialConv2dBatchNormAddReLUOpWrapper::~PartialConv2dBatchNormAddReLUOpWrapper() {}
+
+        Operation* PartialConv2dBatchNormAddReLUOpWrapper::getUnderlyingOperation() {
+            return conv.getOperation();
+        }
+
+        Value PartialConv2dBatchNormAddReLUOpWrapper::getWeights() {
+            return this->conv.weight();
+        }
+
+        ArrayRef<Value> PartialConv2dBatchNormAddReLUOpWrapper::getBN() {
+            return ArrayRef<Value>({this->conv.bn_weight(), this->conv.bn_bias(), this->conv.running_mean(), this->conv.running_var()});
+        }
+
+        Optional<Value> PartialConv2dBatchNormAddReLUOpWrapper::getBiases() {
+            return this->conv.bias();
+        }
+
+        Value PartialConv2dBatchNormAddReLUOpWrapper::getInput() {
+            return this->conv.input();
+        }
+
+        Value PartialConv2dBatchNormAddReLUOpWrapper::getPartialInput() {
+            return this->conv.PartialIn();
+        }
+
+        Value PartialConv2dBatchNormAddReLUOpWrapper::getResidual() {
+            return this->conv.residual();
+        }
+
+        unsigned int PartialConv2dBatchNormAddReLUOpWrapper::getF0() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F0_LOC];
+        }
+
+        unsigned int PartialConv2dBatchNormAddReLUOpWrapper::getF1() {
+            return this->conv.weight().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[F1_LOC];
+        }
+
+        unsigned int PartialConv2dBatchNormAddReLUOpWrapper::getStride() {
+            Value s = this->conv.stride();
+            SmallVector<int64_t,2> stride;
+            matchPattern(s, Torch::m_TorchConstantIntList(stride));
+
+            return stride[0];
+        }
+
+        bool PartialConv2dBatchNormAddReLUOpWrapper::hasWeights() {
+            return true;
+        }
+
+        bool PartialConv2dBatchNormAddReLUOpWrapper::hasBias() {
+            return this->getBiases().hasValue();
+        }
+
+        bool PartialConv2dBatchNormAddReLUOpWrapper::hasBN() {
+            return true;
+        }
+
+        bool PartialConv2dBatchNormAddReLUOpWrapper::isDepthWise() {
+            llvm::APInt intT = this->conv.groups().getDefiningOp<mlir::torch::Torch::ConstantIntOp>().value();
+            unsigned int groups = intT.getSExtValue();
+            mlir::torch::Torch::BaseTensorType aShape = this->conv.input().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            ArrayRef<int64_t> aShapeAR = aShape.getSizes();
+
+            int64_t C = aShapeAR[C_LOC];
+
+            return groups == C;
+        }
+
+        double PartialConv2dBatchNormAddReLUOpWrapper::getKernelEfficiency() {
+            if(this->isDepthWise()) {
+                return 0.30;
+            } else {
+                return 0.90;
+            }
+        }
+
+        Operation* PartialConv2dBatchNormAddReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                                   llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                                   llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                                   llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(weight.hasValue());
+            assert(bn.hasValue());
+
+            if(this->hasBias()) {
+                assert(bias.hasValue());
+            }
+
+            Value chainIn;
+            if(partialIn.hasValue()) {
+                chainIn = partialIn.getValue();
+            } else if(this->conv.PartialIn()){
+                chainIn = this->conv.PartialIn();
+            } else {
+                chainIn = Value();
+            }
+
+            Value biasVal = bias.hasValue() ? bias.getValue() : this->conv.bias();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp;
+            if(residual.hasValue()) {
+                nOp = builder.create<PartialConv2dBatchNormAddReLUOp>(builder.getUnknownLoc(),
+                                                                      returnType,
+                                                                      input,
+                                                                      chainIn,
+                                                                      weight.getValue(),
+                                                                      biasVal,
+                                                                      this->conv.stride(),
+                                                                      this->conv.padding(),
+                                                                      this->conv.dilation(),
+                                                                      this->conv.groups(),
+                                                                      bn.getValue()[0],
+                                                                      bn.getValue()[1],
+                                                                      bn.getValue()[2],
+                                                                      bn.getValue()[3],
+                                                                      this->conv.training(),
+                                                                      this->conv.momentum(),
+                                                                      this->conv.eps(),
+                                                                      residual.getValue());
+            } else {
+                nOp = builder.create<PartialConv2dBatchNormOp>(builder.getUnknownLoc(),
+                                                               returnType,
+                                                               input,
+                                                               chainIn,
+                                                               weight.getValue(),
+                                                               biasVal,
+                                                               this->conv.stride(),
+                                                               this->conv.padding(),
+                                                               this->conv.dilation(),
+                                                               this->conv.groups(),
+                                                               bn.getValue()[0],
+                                                               bn.getValue()[1],
+                                                               bn.getValue()[2],
+                                                               bn.getValue()[3],
+                                                               this->conv.training(),
+                                                               this->conv.momentum(),
+                                                               this->conv.eps());
+            }
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* PartialConv2dBatchNormAddReLUOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> resTypes) {
+            TypeRange types = resTypes.hasValue() ? resTypes.getValue() : this->getUnderlyingOperation()->getResultTypes();
+            Operation* op = builder.create<PartialConv2dBatchNormAddReLUOp>(builder.getUnknownLoc(),
+                                                                            types,
+                                                                            this->getInput(),
+                                                                            this->conv.PartialIn(),
+                                                                            this->getWeights(),
+                                                                            this->getBiases().getValueOr(nullptr),
+                                                                            this->conv.stride(),
+                                                                            this->conv.padding(),
+                                                                            this->conv.dilation(),
+                                                                            this->conv.groups(),
+                                                                            this->conv.bn_weight(),
+                                                                            this->conv.bn_bias(),
+                                                                            this->conv.running_mean(),
+                                                                            this->conv.running_var(),
+                                                                            this->conv.training(),
+                                                                            this->conv.momentum(),
+                                                                            this->conv.eps(),
+                                                                            this->conv.residual());
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        MaxPool2dOpWrapper::MaxPool2dOpWrapper(Torch::AtenMaxPool2dOp mp) {
+            maxpool = mp;
+        }
+
+        MaxPool2dOpWrapper::~MaxPool2dOpWrapper() {}
+
+
+        Operation* MaxPool2dOpWrapper::getUnderlyingOperation() {
+            return maxpool.getOperation();
+        }
+
+        Value MaxPool2dOpWrapper::getWeights() {
+            return Value();
+        }
+
+        Optional<Value> MaxPool2dOpWrapper::getBiases() {
+            return Optional<Value>{};
+        }
+
+        unsigned int MaxPool2dOpWrapper::getF0() {
+            Value ks = this->maxpool.kernel_size();
+            SmallVector<int64_t,2> kernel_size;
+            matchPattern(ks, Torch::m_TorchConstantIntList(kernel_size));
+
+            return kernel_size[0];
+        }
+
+        unsigned int MaxPool2dOpWrapper::getF1() {
+            Value ks = this->maxpool.kernel_size();
+            SmallVector<int64_t,2> kernel_size;
+            matchPattern(ks, Torch::m_TorchConstantIntList(kernel_size));
+
+            return kernel_size[1];
+        }
+
+        unsigned int MaxPool2dOpWrapper::getStride() {
+            Value s = this->maxpool.stride();
+            SmallVector<int64_t,2> stride;
+            matchPattern(s, Torch::m_TorchConstantIntList(stride));
+
+            return stride[0];
+        }
+
+        Value MaxPool2dOpWrapper::getInput() {
+            return this->maxpool.self();
+        }
+
+        Value MaxPool2dOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value MaxPool2dOpWrapper::getResidual() {
+            return Value();
+        }
+
+        ArrayRef<Value> MaxPool2dOpWrapper::getBN() {
+            return ArrayRef<Value>();
+        }
+
+        bool MaxPool2dOpWrapper::hasWeights() {
+            return false;
+        }
+
+        bool MaxPool2dOpWrapper::hasBias() {
+            return false;
+        }
+
+        bool MaxPool2dOpWrapper::isDepthWise() {
+            return true;
+        }
+
+        bool MaxPool2dOpWrapper::hasBN() {
+            return false;
+        }
+
+        double MaxPool2dOpWrapper::getKernelEfficiency() {
+            return 0.25;
+        }
+
+        Operation* MaxPool2dOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                          llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                          llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                          llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(!weight.hasValue());
+            assert(!bias.hasValue());
+            assert(!firstInPartialChain);
+            assert(!partialIn.hasValue());
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp =  builder.create<Torch::AtenMaxPool2dOp>(builder.getUnknownLoc(), returnType, input,
+                                                                     this->maxpool.kernel_size(),
+                                                                     this->maxpool.stride(),
+                                                                     this->maxpool.padding(),
+                                                                     this->maxpool.dilation(),
+                                                                     this->maxpool.ceil_mode());
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* MaxPool2dOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> typeRes) {
+            assert(!typeRes.hasValue());
+
+            Operation* op =  builder.create<Torch::AtenMaxPool2dOp>(builder.getUnknownLoc(),
+                                                                    this->getUnderlyingOperation()->getResultTypes(),
+                                                                    this->getInput(),
+                                                                    this->maxpool.kernel_size(),
+                                                                    this->maxpool.stride(),
+                                                                    this->maxpool.padding(),
+                                                                    this->maxpool.dilation(),
+                                                                    this->maxpool.ceil_mode());
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        MMOpWrapper::MMOpWrapper(MMOp c) {
+            mm = c;
+        }
+
+        MMOpWrapper::~MMOpWrapper() {}
+
+        Operation* MMOpWrapper::getUnderlyingOperation() {
+            return mm.getOperation();
+        }
+
+        Value MMOpWrapper::getWeights() {
+            return this->mm.y();
+        }
+
+        Optional<Value> MMOpWrapper::getBiases() {
+            return Optional<Value>{};
+        }
+
+        unsigned int MMOpWrapper::getF0() {
+            return 1;
+        }
+
+        unsigned int MMOpWrapper::getF1() {
+            return 1;
+        }
+
+        unsigned int MMOpWrapper::getStride() {
+            return 1;
+        }
+
+        Value MMOpWrapper::getInput() {
+            return this->mm.x();
+        }
+
+        Value MMOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value MMOpWrapper::getResidual() {
+            return Value();
+        }
+
+        ArrayRef<Value> MMOpWrapper::getBN() {
+            return ArrayRef<Value>();
+        }
+
+        // y is only weights when it is constant, an mm of two activations streams both
+        bool MMOpWrapper::hasWeights() {
+            return isConstantWeights(this->mm.y());
+        }
+
+        bool MMOpWrapper::hasBias() {
+            return false;
+        }
+
+        bool MMOpWrapper::isDepthWise() {
+            return false;
+        }
+
+        bool MMOpWrapper::hasBN() {
+            return false;
+        }
+
+        double MMOpWrapper::getKernelEfficiency() {
+            return 0.90;
+        }
+
+        Operation* MMOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                        llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                        llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                        llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(!bias.hasValue());
+            assert(!firstInPartialChain);
+            assert(!partialIn.hasValue());
+
+            Value y = weight.hasValue() ? weight.getValue() : this->mm.y();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp = builder.create<MMOp>(builder.getUnknownLoc(), returnType, input, y);
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* MMOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> typeRes) {
+            assert(!typeRes.hasValue());
+
+            Operation* op = builder.create<MMOp>(builder.getUnknownLoc(),
+                                                 this->getUnderlyingOperation()->getResultTypes(),
+                                                 this->getInput(),
+                                                 this->mm.y());
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        LinearReLUOpWrapper::LinearReLUOpWrapper(LinearReLUOp c) {
+            linear = c;
+        }
+
+        LinearReLUOpWrapper::~LinearReLUOpWrapper() {}
+
+        Operation* LinearReLUOpWrapper::getUnderlyingOperation() {
+            return linear.getOperation();
+        }
+
+        Value LinearReLUOpWrapper::getWeights() {
+            return this->linear.weight();
+        }
+
+        Optional<Value> LinearReLUOpWrapper::getBiases() {
+            return this->linear.bias();
+        }
+
+        unsigned int LinearReLUOpWrapper::getF0() {
+            return 1;
+        }
+
+        unsigned int LinearReLUOpWrapper::getF1() {
+            return 1;
+        }
+
+        unsigned int LinearReLUOpWrapper::getStride() {
+            return 1;
+        }
+
+        Value LinearReLUOpWrapper::getInput() {
+            return this->linear.input();
+        }
+
+        Value LinearReLUOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value LinearReLUOpWrapper::getResidual() {
+            return Value();
+        }
+
+        ArrayRef<Value> LinearReLUOpWrapper::getBN() {
+            return ArrayRef<Value>();
+        }
+
+        bool LinearReLUOpWrapper::hasWeights() {
+            return true;
+        }
+
+        bool LinearReLUOpWrapper::hasBias() {
+            return !this->linear.bias().getType().isa<Torch::NoneType>();
+        }
+
+        bool LinearReLUOpWrapper::isDepthWise() {
+            return false;
+        }
+
+        bool LinearReLUOpWrapper::hasBN() {
+            return false;
+        }
+
+        double LinearReLUOpWrapper::getKernelEfficiency() {
+            return 0.90;
+        }
+
+        Operation* LinearReLUOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                                llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                                llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                                llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(!firstInPartialChain);
+            assert(!partialIn.hasValue());
+
+            Value w = weight.hasValue() ? weight.getValue() : this->linear.weight();
+            Value biasVal = bias.hasValue() ? bias.getValue() : this->linear.bias();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp = builder.create<LinearReLUOp>(builder.getUnknownLoc(), returnType, input, w, biasVal);
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* LinearReLUOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> typeRes) {
+            assert(!typeRes.hasValue());
+
+            Operation* op = builder.create<LinearReLUOp>(builder.getUnknownLoc(),
+                                                         this->getUnderlyingOperation()->getResultTypes(),
+                                                         this->getInput(),
+                                                         this->linear.weight(),
+                                                         this->linear.bias());
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        AddOpWrapper::AddOpWrapper(AddOp c) {
+            add = c;
+        }
+
+        AddOpWrapper::~AddOpWrapper() {}
+
+        Value AddOpWrapper::getOtherInput() {
+            return this->add.input1();
+        }
+
+        Operation* AddOpWrapper::getUnderlyingOperation() {
+            return add.getOperation();
+        }
+
+        Value AddOpWrapper::getWeights() {
+            return Value();
+        }
+
+        Optional<Value> AddOpWrapper::getBiases() {
+            return Optional<Value>{};
+        }
+
+        unsigned int AddOpWrapper::getF0() {
+            return 1;
+        }
+
+        unsigned int AddOpWrapper::getF1() {
+            return 1;
+        }
+
+        unsigned int AddOpWrapper::getStride() {
+            return 1;
+        }
+
+        Value AddOpWrapper::getInput() {
+            return this->add.input0();
+        }
+
+        Value AddOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value AddOpWrapper::getResidual() {
+            return Value();
+        }
+
+        ArrayRef<Value> AddOpWrapper::getBN() {
+            return ArrayRef<Value>();
+        }
+
+        bool AddOpWrapper::hasWeights() {
+            return false;
+        }
+
+        bool AddOpWrapper::hasBias() {
+            return false;
+        }
+
+        bool AddOpWrapper::isDepthWise() {
+            return true;
+        }
+
+        bool AddOpWrapper::hasBN() {
+            return false;
+        }
+
+        double AddOpWrapper::getKernelEfficiency() {
+            return 0.25;
+        }
+
+        Operation* AddOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                         llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                         llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                         llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(!bias.hasValue());
+            assert(!firstInPartialChain);
+            assert(!partialIn.hasValue());
+
+            Value other = weight.hasValue() ? weight.getValue() : this->getOtherInput();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp = builder.create<AddOp>(builder.getUnknownLoc(), returnType, input, other);
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* AddOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> typeRes) {
+            assert(!typeRes.hasValue());
+
+            Operation* op = builder.create<AddOp>(builder.getUnknownLoc(),
+                                                 this->getUnderlyingOperation()->getResultTypes(),
+                                                 this->getInput(),
+                                                 this->getOtherInput());
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
+
+        MulOpWrapper::MulOpWrapper(MulOp c) {
+            mul = c;
+        }
+
+        MulOpWrapper::~MulOpWrapper() {}
+
+        Value MulOpWrapper::getOtherInput() {
+            return this->mul.input1();
+        }
+
+        Operation* MulOpWrapper::getUnderlyingOperation() {
+            return mul.getOperation();
+        }
+
+        Value MulOpWrapper::getWeights() {
+            return Value();
+        }
+
+        Optional<Value> MulOpWrapper::getBiases() {
+            return Optional<Value>{};
+        }
+
+        unsigned int MulOpWrapper::getF0() {
+            return 1;
+        }
+
+        unsigned int MulOpWrapper::getF1() {
+            return 1;
+        }
+
+        unsigned int MulOpWrapper::getStride() {
+            return 1;
+        }
+
+        Value MulOpWrapper::getInput() {
+            return this->mul.input0();
+        }
+
+        Value MulOpWrapper::getPartialInput() {
+            return Value();
+        }
+
+        Value MulOpWrapper::getResidual() {
+            return Value();
+        }
+
+        ArrayRef<Value> MulOpWrapper::getBN() {
+            return ArrayRef<Value>();
+        }
+
+        bool MulOpWrapper::hasWeights() {
+            return false;
+        }
+
+        bool MulOpWrapper::hasBias() {
+            return false;
+        }
+
+        bool MulOpWrapper::isDepthWise() {
+            return true;
+        }
+
+        bool MulOpWrapper::hasBN() {
+            return false;
+        }
+
+        double MulOpWrapper::getKernelEfficiency() {
+            return 0.25;
+        }
+
+        Operation* MulOpWrapper::buildOp(OpBuilder &builder, TypeRange returnType, Value input,
+                                         llvm::Optional<Value> weight, llvm::Optional<Value> bias,
+                                         llvm::Optional<Value> partialIn, bool firstInPartialChain,
+                                         llvm::Optional<ArrayRef<Value>> bn, llvm::Optional<Value> residual) {
+            assert(!bias.hasValue());
+            assert(!firstInPartialChain);
+            assert(!partialIn.hasValue());
+
+            Value other = weight.hasValue() ? weight.getValue() : this->getOtherInput();
+
+            Operation* op = this->getUnderlyingOperation();
+            Operation* nOp = builder.create<MulOp>(builder.getUnknownLoc(), returnType, input, other);
+
+            nOp->setAttrs(op->getAttrs());
+            return nOp;
+        }
+
+        Operation* MulOpWrapper::wCopy(OpBuilder &builder, unsigned int into, llvm::Optional<TypeRange> typeRes) {
+            assert(!typeRes.hasValue());
+
+            Operation* op = builder.create<MulOp>(builder.getUnknownLoc(),
+                                                 this->getUnderlyingOperation()->getResultTypes(),
+                                                 this->getInput(),
+                                                 this->getOtherInput());
+
+            op->setAttrs(this->getUnderlyingOperation()->getAttrs());
+
+            auto ty = IntegerType::get(builder.getContext(), 32);
+            auto attr = IntegerAttr::get(ty, into);
+            op->setAttr(llvm::StringRef("locW"), attr);
+
+            return op;
+        }
     }
 }
 
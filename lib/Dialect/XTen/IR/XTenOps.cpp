@@ -10,9 +10,14 @@
 
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/TypeUtilities.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallSet.h"
+
 #include "xten/Dialect/XTen/XTenDialect.h"
 #include "xten/Dialect/XTen/XTenOps.h"
 
@@ -23,3 +28,434 @@ using namespace xilinx::xten;
 
 #define GET_OP_CLASSES
 #include "xten/Dialect/XTen/XTenOps.cpp.inc"
+
+namespace {
+
+using namespace mlir::torch;
+
+llvm::Optional<int64_t> getConstantDim(Value dim) {
+  APInt value;
+  if (matchPattern(dim, m_ConstantInt(&value)))
+    return value.getSExtValue();
+  return llvm::None;
+}
+
+// Sizes of values along dim, fails if one of them is not known
+LogicalResult getSizesAlong(ValueRange values, int64_t dim,
+                            SmallVectorImpl<int64_t> &sizes) {
+  for (Value v : values) {
+    auto type = v.getType().dyn_cast<Torch::BaseTensorType>();
+    if (!type || !type.hasSizes() || dim < 0 ||
+        dim >= (int64_t)type.getSizes().size() ||
+        type.getSizes()[dim] == Torch::kUnknownSize)
+      return failure();
+    sizes.push_back(type.getSizes()[dim]);
+  }
+  return success();
+}
+
+Torch::BaseTensorType resizeAt(Type type, int64_t dim, int64_t size) {
+  auto tensorType = type.cast<Torch::BaseTensorType>();
+  SmallVector<int64_t> sizes(tensorType.getSizes().begin(),
+                             tensorType.getSizes().end());
+  sizes[dim] = size;
+  return tensorType.getWithSizesAndDtype(llvm::makeArrayRef(sizes),
+                                         tensorType.getDtype())
+      .cast<Torch::BaseTensorType>();
+}
+
+// Builds the region [start, start + length) along dim of the concatenation
+// of inputs directly from the inputs: inputs fully covered are used as is,
+// partially covered ones are sliced
+Value extractFromConcat(PatternRewriter &rewriter, Location loc,
+                        ValueRange inputs, ArrayRef<int64_t> sizes,
+                        Value dimValue, int64_t dim, int64_t start,
+                        int64_t length, Type resultType) {
+  SmallVector<Value> parts;
+  int64_t offset = 0;
+  for (auto it : llvm::zip(inputs, sizes)) {
+    Value input = std::get<0>(it);
+    int64_t size = std::get<1>(it);
+    int64_t begin = std::max(start, offset);
+    int64_t end = std::min(start + length, offset + size);
+
+    if (begin < end) {
+      if (begin == offset && end == offset + size) {
+        parts.push_back(input);
+      } else {
+        auto type = input.getType().cast<Torch::BaseTensorType>();
+        SmallVector<int64_t> offsets(type.getSizes().size(), 0);
+        offsets[dim] = begin - offset;
+        parts.push_back(rewriter.create<SliceOp>(
+            loc, resizeAt(type, dim, end - begin), input,
+            rewriter.getI64ArrayAttr(offsets)));
+      }
+    }
+
+    offset += size;
+  }
+
+  if (parts.size() == 1 && parts[0].getType() == resultType)
+    return parts[0];
+
+  return rewriter.create<ConcatOp>(loc, resultType, parts, dimValue);
+}
+
+// Split of input along dim into outSizes placed before split, if input
+// already has one, so that splitting input again folds into it
+SplitOp findSplitLike(Value input, SplitOp split, int64_t dim,
+                      ArrayRef<int64_t> outSizes) {
+  for (Operation *user : input.getUsers()) {
+    auto other = dyn_cast<SplitOp>(user);
+    if (!other || other == split || other.input() != input ||
+        other->getBlock() != split->getBlock() ||
+        !other->isBeforeInBlock(split) ||
+        getConstantDim(other.dim()) != dim ||
+        other.getNumResults() != outSizes.size())
+      continue;
+
+    bool sameSplit = true;
+    for (auto it : llvm::zip(other.getResultTypes(), outSizes))
+      sameSplit &= std::get<0>(it) ==
+                   Type(resizeAt(input.getType(), dim, std::get<1>(it)));
+    if (sameSplit)
+      return other;
+  }
+  return nullptr;
+}
+
+// Whether input is a concat along dim whose inputs end on every boundary,
+// so that splitting it at those boundaries only regroups its inputs
+bool concatAlignedWith(Value input, int64_t dim, ArrayRef<int64_t> boundaries) {
+  auto concat = input.getDefiningOp<ConcatOp>();
+  if (!concat)
+    return false;
+
+  auto concatDim = getConstantDim(concat.dim());
+  SmallVector<int64_t> sizes;
+  if (!concatDim.hasValue() || concatDim.getValue() != dim ||
+      failed(getSizesAlong(concat.inputs(), dim, sizes)))
+    return false;
+
+  llvm::SmallSet<int64_t, 8> ends;
+  int64_t end = 0;
+  for (int64_t size : sizes)
+    ends.insert(end += size);
+
+  return llvm::all_of(boundaries,
+                      [&](int64_t boundary) { return ends.count(boundary); });
+}
+
+// split(concat(x...)) on the same dim: every result is wired to the inputs
+// it covers. On orthogonal dims the split is pushed through the concat when
+// none of the inputs needs a new split: inputs already split the same way
+// reuse that split, inputs concatenated along the split dim at its
+// boundaries are regrouped.
+struct SplitOfConcat : public OpRewritePattern<SplitOp> {
+  using OpRewritePattern<SplitOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(SplitOp split,
+                                PatternRewriter &rewriter) const override {
+    auto concat = split.input().getDefiningOp<ConcatOp>();
+    if (!concat)
+      return failure();
+
+    auto splitDim = getConstantDim(split.dim());
+    auto concatDim = getConstantDim(concat.dim());
+    if (!splitDim.hasValue() || !concatDim.hasValue())
+      return failure();
+
+    SmallVector<int64_t> outSizes;
+    if (failed(getSizesAlong(split.getResults(), splitDim.getValue(), outSizes)))
+      return failure();
+
+    if (splitDim.getValue() == concatDim.getValue()) {
+      SmallVector<int64_t> inSizes;
+      if (failed(getSizesAlong(concat.inputs(), concatDim.getValue(), inSizes)))
+        return failure();
+
+      SmallVector<Value> replacements;
+      int64_t start = 0;
+      for (auto it : llvm::zip(split.getResults(), outSizes)) {
+        Value result = std::get<0>(it);
+        int64_t size = std::get<1>(it);
+        replacements.push_back(extractFromConcat(
+            rewriter, split.getLoc(), concat.inputs(), inSizes, concat.dim(),
+            concatDim.getValue(), start, size, result.getType()));
+        start += size;
+      }
+
+      rewriter.replaceOp(split, replacements);
+      return success();
+    }
+
+    // Only worth it when the concat disappears and no input needs a new split,
+    // otherwise this only trades one split for several
+    if (!concat->hasOneUse())
+      return failure();
+
+    SmallVector<int64_t> boundaries;
+    int64_t boundary = 0;
+    for (int64_t size : outSizes)
+      boundaries.push_back(boundary += size);
+
+    SmallVector<SplitOp> existingSplits;
+    for (Value input : concat.inputs()) {
+      existingSplits.push_back(
+          findSplitLike(input, split, splitDim.getValue(), outSizes));
+      if (existingSplits.back() ||
+          concatAlignedWith(input, splitDim.getValue(), boundaries))
+        continue;
+      return failure();
+    }
+
+    SmallVector<SmallVector<Value>> parts(split.getNumResults());
+    for (auto it : llvm::zip(concat.inputs(), existingSplits)) {
+      Value input = std::get<0>(it);
+      SplitOp existing = std::get<1>(it);
+      if (existing) {
+        for (unsigned int i = 0; i < split.getNumResults(); i++)
+          parts[i].push_back(existing.getResult(i));
+        continue;
+      }
+
+      auto inner = input.getDefiningOp<ConcatOp>();
+      SmallVector<int64_t> inSizes;
+      (void)getSizesAlong(inner.inputs(), splitDim.getValue(), inSizes);
+
+      int64_t start = 0;
+      for (unsigned int i = 0; i < split.getNumResults(); i++) {
+        parts[i].push_back(extractFromConcat(
+            rewriter, split.getLoc(), inner.inputs(), inSizes, inner.dim(),
+            splitDim.getValue(), start, outSizes[i],
+            resizeAt(input.getType(), splitDim.getValue(), outSizes[i])));
+        start += outSizes[i];
+      }
+    }
+
+    SmallVector<Value> replacements;
+    for (unsigned int i = 0; i < split.getNumResults(); i++)
+      replacements.push_back(rewriter.create<ConcatOp>(
+          split.getLoc(), split.getResult(i).getType(), parts[i],
+          concat.dim()));
+
+    rewriter.replaceOp(split, replacements);
+    return success();
+  }
+};
+
+struct SingleResultSplit : public OpRewritePattern<SplitOp> {
+  using OpRewritePattern<SplitOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(SplitOp split,
+                                PatternRewriter &rewriter) const override {
+    if (split.getNumResults() != 1 ||
+        split.getResult(0).getType() != split.input().getType())
+      return failure();
+
+    rewriter.replaceOp(split, split.input());
+    return success();
+  }
+};
+
+// concat(split(x)) of all the results of a split in order on the same dim is x
+struct ConcatOfSplit : public OpRewritePattern<ConcatOp> {
+  using OpRewritePattern<ConcatOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(ConcatOp concat,
+                                PatternRewriter &rewriter) const override {
+    if (concat.inputs().empty())
+      return failure();
+
+    auto split = concat.inputs()[0].getDefiningOp<SplitOp>();
+    if (!split || split.getNumResults() != concat.inputs().size() ||
+        split.input().getType() != concat.getResult().getType())
+      return failure();
+
+    for (auto it : llvm::enumerate(concat.inputs())) {
+      if (it.value() != split.getResult(it.index()))
+        return failure();
+    }
+
+    auto splitDim = getConstantDim(split.dim());
+    auto concatDim = getConstantDim(concat.dim());
+    if (!splitDim.hasValue() || !concatDim.hasValue() ||
+        splitDim.getValue() != concatDim.getValue())
+      return failure();
+
+    rewriter.replaceOp(concat, split.input());
+    return success();
+  }
+};
+
+// concat(a, concat(b, c), d) on the same dim is concat(a, b, c, d)
+struct FlattenConcat : public OpRewritePattern<ConcatOp> {
+  using OpRewritePattern<ConcatOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(ConcatOp concat,
+                                PatternRewriter &rewriter) const override {
+    auto dim = getConstantDim(concat.dim());
+    if (!dim.hasValue())
+      return failure();
+
+    bool changed = false;
+    SmallVector<Value> inputs;
+    for (Value input : concat.inputs()) {
+      auto inner = input.getDefiningOp<ConcatOp>();
+      llvm::Optional<int64_t> innerDim;
+      if (inner)
+        innerDim = getConstantDim(inner.dim());
+      if (innerDim.hasValue() && innerDim.getValue() == dim.getValue()) {
+        inputs.append(inner.inputs().begin(), inner.inputs().end());
+        changed = true;
+      } else {
+        inputs.push_back(input);
+      }
+    }
+
+    if (!changed)
+      return failure();
+
+    rewriter.replaceOpWithNewOp<ConcatOp>(concat, concat.getResult().getType(),
+                                          inputs, concat.dim());
+    return success();
+  }
+};
+
+// slice(slice(x)) is a slice of x, so slices always refer to the original value
+struct SliceOfSlice : public OpRewritePattern<SliceOp> {
+  using OpRewritePattern<SliceOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(SliceOp slice,
+                                PatternRewriter &rewriter) const override {
+    auto inner = slice.input().getDefiningOp<SliceOp>();
+    if (!inner)
+      return failure();
+
+    SmallVector<int64_t> offsets;
+    for (auto it : llvm::zip(slice.offsets(), inner.offsets()))
+      offsets.push_back(std::get<0>(it).cast<IntegerAttr>().getInt() +
+                        std::get<1>(it).cast<IntegerAttr>().getInt());
+
+    rewriter.replaceOpWithNewOp<SliceOp>(slice, slice.getResult().getType(),
+                                         inner.input(),
+                                         rewriter.getI64ArrayAttr(offsets));
+    return success();
+  }
+};
+
+// A slice of a concat that lies within one of its inputs is a slice of that input
+struct SliceOfConcat : public OpRewritePattern<SliceOp> {
+  using OpRewritePattern<SliceOp>::OpRewritePattern;
+
+  LogicalResult matchAndRewrite(SliceOp slice,
+                                PatternRewriter &rewriter) const override {
+    auto concat = slice.input().getDefiningOp<ConcatOp>();
+    if (!concat)
+      return failure();
+
+    auto dim = getConstantDim(concat.dim());
+    if (!dim.hasValue())
+      return failure();
+
+    SmallVector<int64_t> inSizes;
+    SmallVector<int64_t> outSizes;
+    if (failed(getSizesAlong(concat.inputs(), dim.getValue(), inSizes)) ||
+        failed(getSizesAlong(slice.getResult(), dim.getValue(), outSizes)))
+      return failure();
+
+    SmallVector<int64_t> offsets;
+    for (Attribute attr : slice.offsets())
+      offsets.push_back(attr.cast<IntegerAttr>().getInt());
+
+    int64_t start = offsets[dim.getValue()];
+    int64_t offset = 0;
+    for (auto it : llvm::zip(concat.inputs(), inSizes)) {
+      int64_t size = std::get<1>(it);
+      if (start >= offset && start + outSizes[0] <= offset + size) {
+        offsets[dim.getValue()] = start - offset;
+        rewriter.replaceOpWithNewOp<SliceOp>(
+            slice, slice.getResult().getType(), std::get<0>(it),
+            rewriter.getI64ArrayAttr(offsets));
+        return success();
+      }
+      offset += size;
+    }
+
+    return failure();
+  }
+};
+
+} // namespace
+
+namespace xilinx {
+namespace xten {
+
+OpFoldResult ConcatOp::fold(ArrayRef<Attribute> operands) {
+  if (inputs().size() == 1 && inputs()[0].getType() == getResult().getType())
+    return inputs()[0];
+  return nullptr;
+}
+
+void ConcatOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                           MLIRContext *context) {
+  results.add<ConcatOfSplit, FlattenConcat>(context);
+}
+
+void SplitOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                          MLIRContext *context) {
+  results.add<SplitOfConcat, SingleResultSplit>(context);
+}
+
+OpFoldResult SliceOp::fold(ArrayRef<Attribute> operands) {
+  if (input().getType() != getResult().getType())
+    return nullptr;
+
+  for (Attribute attr : offsets()) {
+    if (attr.cast<IntegerAttr>().getInt() != 0)
+      return nullptr;
+  }
+
+  return input();
+}
+
+LogicalResult SliceOp::verify() {
+  auto inputTy = input().getType().cast<mlir::torch::Torch::BaseTensorType>();
+  auto resultTy = getResult().getType().cast<mlir::torch::Torch::BaseTensorType>();
+  if (!inputTy.hasSizes() || !resultTy.hasSizes())
+    return success();
+
+  ArrayRef<int64_t> inSizes = inputTy.getSizes();
+  ArrayRef<int64_t> outSizes = resultTy.getSizes();
+  if (outSizes.size() != inSizes.size())
+    return emitOpError("result rank ")
+           << outSizes.size() << " does not match the input rank "
+           << inSizes.size();
+  if (offsets().size() != inSizes.size())
+    return emitOpError("expected ")
+           << inSizes.size() << " offsets, got " << offsets().size();
+
+  for (unsigned d = 0; d < inSizes.size(); d++) {
+    int64_t offset = offsets()[d].cast<IntegerAttr>().getInt();
+    if (offset < 0)
+      return emitOpError("offset ") << offset << " of dimension " << d
+                                    << " is negative";
+    if (inSizes[d] == mlir::torch::Torch::kUnknownSize ||
+        outSizes[d] == mlir::torch::Torch::kUnknownSize)
+      continue;
+    if (offset + outSizes[d] > inSizes[d])
+      return emitOpError("slice [")
+             << offset << ", " << offset + outSizes[d] << ") of dimension "
+             << d << " is out of the input of size " << inSizes[d];
+  }
+
+  return success();
+}
+
+void SliceOp::getCanonicalizationPatterns(RewritePatternSet &results,
+                                          MLIRContext *context) {
+  results.add<SliceOfSlice, SliceOfConcat>(context);
+}
+
+} // namespace xten
+} // namespace xilinx
@@ -0,0 +1,300 @@
+//===- XTenAllocateBanksPass.cpp --------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+#include "xten/Dialect/XTen/XTenAllocateBanksPass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowExplorer.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-allocate-banks-pass"
+
+using namespace mlir;
+
+// Binds the buffers the analytical model counts for each expanded op to the banks of its core:
+// weights, input lines, lines forwarded to the next W replica and output, in that order.
+// Each bank holds a single buffer and every double buffer spans at least two banks, so the
+// stream writing a buffer and the kernel reading it never hit the same bank at the same time.
+// A layer followed by a depth wise layer has no output buffer, it writes straight into the input
+// lines of the depth wise op. When the depth wise op does not fit its own core, the end of its
+// input lines is taken from the free banks of its producer, that neighbour shares its memory.
+// The counts come from DataflowExplorer::getLocalBufferBanks, the same ones xten-emit-graph reports.
+
+namespace xilinx {
+    namespace xten {
+        class BankLayout {
+        public:
+            std::vector<int64_t> weights;
+            std::vector<int64_t> input;
+            std::vector<int64_t> forward;
+            std::vector<int64_t> output;
+            std::vector<int64_t> lent; // own banks holding the input of the depth wise consumer
+            std::vector<int64_t> borrowed; // banks of the producer holding the end of the input
+            Operation* writesInto; // depth wise consumer receiving the output
+            uint64_t used;
+
+            BankLayout() {
+                writesInto = nullptr;
+                used = 0;
+            }
+
+            void take(std::vector<int64_t> &buffer, uint64_t count) {
+                for(uint64_t i = 0; i < count; i++) {
+                    buffer.push_back(this->used);
+                    this->used++;
+                }
+            }
+
+            uint64_t nextFree() {
+                return this->used + this->lent.size();
+            }
+        };
+
+        struct XTenAllocateBanksPass : public XTenAllocateBanksBase<XTenAllocateBanksPass> {
+        public:
+            Option<std::string> memoryMapFilename{*this, "memory-map",
+                                                  llvm::cl::desc("Write the banks of each expanded op to this file, \"-\" for stdout"),
+                                                  llvm::cl::init("")};
+
+            Statistic numBanksUsed{this, "banks", "Number of banks holding a buffer"};
+            Statistic numBanksShared{this, "shared-banks", "Number of banks lent to a depth wise neighbour"};
+
+            XTenAllocateBanksPass() {}
+            XTenAllocateBanksPass(const XTenAllocateBanksPass &pass) {}
+
+            // Producer lending banks to a depth wise op, preferably the one with the same locP
+            Operation* findLender(Operation* op, llvm::DenseMap<Operation*, BankLayout> &layouts, uint64_t banks, uint64_t numBanks) {
+                llvm::SmallSetVector<Operation*, 4> producers;
+                for(Value operand : op->getOperands()) {
+                    findProducerOps(operand, producers);
+                }
+
+                unsigned int locP = getAttrOrDefault(op, "locP", 0);
+                Operation* lender = nullptr;
+                for(Operation* producer : producers) {
+                    if(layouts.count(producer) == 0 || (layouts[producer].nextFree() + banks) > numBanks) {
+                        continue;
+                    }
+
+                    if(lender == nullptr || getAttrOrDefault(producer, "locP", 0) == locP) {
+                        lender = producer;
+                    }
+                }
+
+                return lender;
+            }
+
+            void setBanksAttr(Operation* op, BankLayout &layout) {
+                Builder builder(op->getContext());
+                std::vector<NamedAttribute> attrs;
+
+                attrs.push_back(builder.getNamedAttr("weights", builder.getI64ArrayAttr(layout.weights)));
+                attrs.push_back(builder.getNamedAttr("input", builder.getI64ArrayAttr(layout.input)));
+                attrs.push_back(builder.getNamedAttr("forward", builder.getI64ArrayAttr(layout.forward)));
+                attrs.push_back(builder.getNamedAttr("output", builder.getI64ArrayAttr(layout.output)));
+
+                if(layout.lent.size() != 0) {
+                    attrs.push_back(builder.getNamedAttr("lent", builder.getI64ArrayAttr(layout.lent)));
+                }
+
+                if(layout.borrowed.size() != 0) {
+                    attrs.push_back(builder.getNamedAttr("borrowed", builder.getI64ArrayAttr(layout.borrowed)));
+                }
+
+                op->setAttr(BANKS_ATTR, builder.getDictionaryAttr(attrs));
+            }
+
+            std::string emitMemoryMap(std::vector<Operation*> &ops, llvm::DenseMap<Operation*, BankLayout> &layouts, uint64_t numBanks, uint64_t bankSize) {
+                llvm::json::Object top;
+                top["banks"] = (int64_t)numBanks;
+                top["bankSize"] = (int64_t)bankSize;
+
+                llvm::json::Array opsJSON;
+                for(Operation* op : ops) {
+                    BankLayout &layout = layouts[op];
+
+                    llvm::json::Object opJSON;
+                    opJSON["name"] = getOpLabel(op);
+                    opJSON["used"] = (int64_t)layout.nextFree();
+                    opJSON["weights"] = llvm::json::Array(layout.weights);
+                    opJSON["input"] = llvm::json::Array(layout.input);
+                    opJSON["forward"] = llvm::json::Array(layout.forward);
+                    opJSON["output"] = llvm::json::Array(layout.output);
+                    opJSON["lent"] = llvm::json::Array(layout.lent);
+                    opJSON["borrowed"] = llvm::json::Array(layout.borrowed);
+
+                    if(layout.writesInto != nullptr) {
+                        opJSON["writesInto"] = getOpLabel(layout.writesInto);
+                    }
+
+                    if(auto core = op->getAttrOfType<ArrayAttr>(CORE_ATTR)) {
+                        llvm::json::Array coreJSON;
+                        for(Attribute c : core) {
+                            coreJSON.push_back(c.cast<IntegerAttr>().getInt());
+                        }
+                        opJSON["core"] = llvm::json::Value(std::move(coreJSON));
+                    }
+
+                    opsJSON.push_back(llvm::json::Value(std::move(opJSON)));
+                }
+
+                top["ops"] = llvm::json::Value(std::move(opsJSON));
+
+                llvm::json::Value topv(std::move(top));
+                std::string ret;
+                llvm::raw_string_ostream ss(ret);
+                ss << llvm::formatv("{0:2}", topv) << "\n";
+                return ss.str();
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                auto graph = module.lookupSymbol<func::FuncOp>("forward");
+                if(!graph) {
+                    emitError(UnknownLoc::get(module.getContext()), "Cant find graph func\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                if(failed(checkLayerOps(graph))) {
+                    signalPassFailure();
+                    return;
+                }
+
+                // Expanded ops in topological order, producers get their banks before the depth wise ops borrowing them
+                std::vector<std::vector<uint64_t>> producers;
+                std::vector<Operation*> ops = getLayersInTopologicalOrder(graph, producers);
+
+                std::vector<std::pair<std::string, AbsOpWrapper*>> explorerInit;
+                std::map<std::string, uint64_t> layerNameToId;
+                for(Operation* op : ops) {
+                    std::string opName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+                    if(layerNameToId.count(opName) == 0) {
+                        layerNameToId[opName] = explorerInit.size();
+                        explorerInit.push_back(std::make_pair(opName, opToWrapper(op)));
+                    }
+                }
+
+                DataflowExplorer explorer(explorerInit);
+                uint64_t numBanks = explorer.arch->getNumBanks();
+
+                llvm::DenseMap<Operation*, BankLayout> layouts;
+                bool invalid = false;
+                for(Operation* op : ops) {
+                    ModelParams params;
+                    if(!getDataflowAttr(op, params)) {
+                        op->emitError("Missing or invalid " DATAFLOW_ATTR " attribute, run xten-annotate-dataflow first");
+                        invalid = true;
+                        break;
+                    }
+
+                    uint64_t id = layerNameToId[op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str()];
+                    BufferBanks banks = explorer.getLocalBufferBanks(id, params);
+                    uint64_t total = banks.total();
+
+                    AbsOpWrapper* wrapped = opToWrapper(op);
+                    bool depthWise = wrapped->isDepthWise();
+                    delete wrapped;
+
+                    BankLayout &layout = layouts[op];
+                    uint64_t borrow = (total > numBanks) ? (total - numBanks) : 0;
+
+                    Operation* lender = nullptr;
+                    if(borrow != 0) {
+                        lender = (depthWise && borrow <= banks.input) ? this->findLender(op, layouts, borrow, numBanks) : nullptr;
+                        if(lender == nullptr) {
+                            op->emitError("Needs " + std::to_string(total) + " memory banks but its core only has " + std::to_string(numBanks));
+                            invalid = true;
+                            break;
+                        }
+                    }
+
+                    layout.take(layout.weights, banks.weights);
+                    layout.take(layout.input, banks.input - borrow);
+                    layout.take(layout.forward, banks.forward);
+                    layout.take(layout.output, banks.output);
+
+                    if(lender != nullptr) {
+                        BankLayout &lenderLayout = layouts[lender];
+                        for(uint64_t i = 0; i < borrow; i++) {
+                            int64_t bank = lenderLayout.nextFree();
+                            lenderLayout.lent.push_back(bank);
+                            layout.borrowed.push_back(bank);
+                        }
+
+                        numBanksShared += borrow;
+                    }
+
+                    // Producers without output buffer write straight into the input lines of op
+                    if(depthWise) {
+                        llvm::SmallSetVector<Operation*, 4> producers;
+                        for(Value operand : op->getOperands()) {
+                            findProducerOps(operand, producers);
+                        }
+
+                        for(Operation* producer : producers) {
+                            BankLayout &producerLayout = layouts[producer];
+                            if(producerLayout.output.size() == 0 && producerLayout.writesInto == nullptr) {
+                                producerLayout.writesInto = op;
+                            }
+                        }
+                    }
+
+                    numBanksUsed += layout.used;
+                }
+
+                if(invalid) {
+                    signalPassFailure();
+                } else {
+                    for(Operation* op : ops) {
+                        this->setBanksAttr(op, layouts[op]);
+                    }
+
+                    if(memoryMapFilename != "") {
+                        std::string memoryMap = this->emitMemoryMap(ops, layouts, numBanks, explorer.arch->getBankSize());
+                        if(failed(writeReport(memoryMapFilename, memoryMap, graph.getLoc()))) {
+                            signalPassFailure();
+                        }
+                    }
+                }
+
+                for(auto &init : explorerInit) {
+                    delete init.second;
+                }
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenAllocateBanksPass() {
+    return std::make_unique<XTenAllocateBanksPass>();
+}
+
+} // namespace xten
+} // namespace xilinx
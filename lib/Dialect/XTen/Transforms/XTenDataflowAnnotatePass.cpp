@@ -0,0 +1,187 @@
+//===- XTenDataflowAnnotatePass.cpp -----------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/Support/Debug.h"
+
+#include "xten/Dialect/XTen/XTenDataflowAnnotatePass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowExplorer.h"
+#include "xten/Dialect/XTen/XTenDataflowSimulator.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-dataflow-annotate-pass"
+
+using namespace mlir;
+
+// Runs the explorer once and records its decision on each layer as an xten.dataflow attribute:
+// {P, Ca, L, W, lineGranularity, computeTime, totalTimePerTile, totalTime}
+// xten-expand-graph only reads these attributes, so they can also be written by hand or by another tool
+
+namespace xilinx {
+    namespace xten {
+
+        struct XTenDataflowAnnotatePass : public XTenDataflowAnnotateBase<XTenDataflowAnnotatePass> {
+        public:
+            Option<std::string> bottleneckReportFilename{*this, "bottleneck-report",
+                                                         llvm::cl::desc("Write the marginal gain report of the selected design to this file, \"-\" for stdout"),
+                                                         llvm::cl::init("")};
+
+            Option<unsigned> bottleneckMaxExtraCores{*this, "bottleneck-extra-cores",
+                                                     llvm::cl::desc("Maximum number of extra cores per layer considered by the bottleneck report"),
+                                                     llvm::cl::init(8)};
+
+            Option<std::string> layerDescriptorsFilename{*this, "layer-descriptors",
+                                                         llvm::cl::desc("Only write the layer descriptors used by the explorer to this file, \"-\" for stdout, and stop"),
+                                                         llvm::cl::init("")};
+
+            Option<std::string> dumpFilename{*this, "dump-file",
+                                             llvm::cl::desc("Write the explored topologies, pareto frontiers and their paths to this file"),
+                                             llvm::cl::init("")};
+
+            Option<std::string> simulationReportFilename{*this, "simulation-report",
+                                                         llvm::cl::desc("Simulate the selected design and write the report to this file, \"-\" for stdout"),
+                                                         llvm::cl::init("")};
+
+            Option<unsigned> simulationSamples{*this, "simulation-samples",
+                                               llvm::cl::desc("Number of samples pushed through the simulated pipeline"),
+                                               llvm::cl::init(4)};
+
+            Statistic numCandidates{this, "candidates", "Number of candidate topologies evaluated"};
+            Statistic numValidTopologies{this, "valid-topologies", "Number of valid topologies over all layers"};
+            Statistic numEdges{this, "edges", "Number of edges in the path graph"};
+            Statistic numCellsRelaxed{this, "cells-relaxed", "Number of frontier cells relaxed while enumerating paths"};
+            Statistic peakNodeMemory{this, "peak-node-memory", "Peak memory held by the path graph nodes in bytes"};
+
+            XTenDataflowAnnotatePass() {}
+            XTenDataflowAnnotatePass(const XTenDataflowAnnotatePass &pass) {}
+
+            void annotate(DataflowExplorer &dataflowExplorer, func::FuncOp graph, std::map<std::string, Operation*> &layerNameToOp) {
+                // Layer descriptors can be explored offline with xten-explore
+                if(layerDescriptorsFilename != "") {
+                    if(failed(writeReport(layerDescriptorsFilename, dataflowExplorer.emitLayerDescriptors(), graph.getLoc()))) {
+                        signalPassFailure();
+                    }
+                    return;
+                }
+
+                LLVM_DEBUG(llvm::outs() << "Total Compute is: " << dataflowExplorer.getTotalCompute() << "\n");
+                dataflowExplorer.enumerate([&](const char* phase, llvm::function_ref<void()> run) {
+                    PhaseTimer timer(this->getAnalysisManager(), graph, phase);
+                    run();
+                });
+
+                numCandidates = dataflowExplorer.numCandidates;
+                numEdges = dataflowExplorer.numEdges;
+                numCellsRelaxed = dataflowExplorer.numCellsRelaxed;
+                peakNodeMemory = dataflowExplorer.peakNodeMemory;
+                for(auto &topologies : dataflowExplorer.validTopologies) {
+                    numValidTopologies += topologies.size();
+                }
+
+                if(dumpFilename != "") {
+                    dataflowExplorer.dumpExploration(dumpFilename);
+                }
+
+                std::vector<ModelParams> path = dataflowExplorer.getMaxThroughputPath();
+                if(path.size() != dataflowExplorer.layerIdToName.size()) {
+                    emitError(graph.getLoc(), "No valid dataflow design was found\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                if(bottleneckReportFilename != "") {
+                    if(failed(writeReport(bottleneckReportFilename, dataflowExplorer.emitBottleneckReport(bottleneckMaxExtraCores), graph.getLoc()))) {
+                        signalPassFailure();
+                    }
+                }
+
+                if(simulationReportFilename != "") {
+                    DataflowSimulator simulator(dataflowExplorer, path);
+                    if(!simulator.run(simulationSamples)) {
+                        emitWarning(graph.getLoc(), "Simulation failed: " + simulator.failure);
+                    }
+
+                    if(failed(writeReport(simulationReportFilename, simulator.emitReport(), graph.getLoc()))) {
+                        signalPassFailure();
+                    }
+                }
+
+                for(uint64_t i = 0; i < path.size(); i++) {
+                    ModelParams &params = path.at(i);
+                    Operation* op = layerNameToOp[dataflowExplorer.layerIdToName[i]];
+
+                    setDataflowAttr(op, params,
+                                    dataflowExplorer.getComputeTime(i, params),
+                                    dataflowExplorer.getTotalTimePerTile(i, params),
+                                    dataflowExplorer.getTotalTime(i, params));
+                }
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                auto graph = module.lookupSymbol<func::FuncOp>("forward");
+                if(!graph) {
+                    emitError(UnknownLoc::get(module.getContext()), "Cant find graph func\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                if(failed(checkLayerOps(graph))) {
+                    signalPassFailure();
+                    return;
+                }
+
+                // Same order as xten-dataflow so that both passes give the same ids to the layers
+                std::vector<std::vector<uint64_t>> producers;
+                std::vector<Operation*> layers = getLayersInTopologicalOrder(graph, producers);
+
+                std::vector<std::pair<std::string, AbsOpWrapper*>> explorerInit;
+                std::map<std::string, Operation*> layerNameToOp;
+                for(Operation* op : layers) {
+                    std::string opName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+                    if(layerNameToOp.count(opName) != 0) {
+                        llvm::outs() << "Cannot have multiple layer with the same name during initizalization\n";
+                        exit(1);
+                    }
+
+                    layerNameToOp[opName] = op;
+                    explorerInit.push_back(std::make_pair(opName, opToWrapper(op)));
+                }
+
+                DataflowExplorer dataflowExplorer(explorerInit);
+                annotate(dataflowExplorer, graph, layerNameToOp);
+
+                for(auto &init : explorerInit) {
+                    delete init.second;
+                }
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenDataflowAnnotatePass() {
+    return std::make_unique<XTenDataflowAnnotatePass>();
+}
+
+} // namespace xten
+} // namespace xilinx
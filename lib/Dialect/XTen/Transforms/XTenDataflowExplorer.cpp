@@ -19,8 +19,14 @@
 
 #include "xten/Transform/ATenOpReport.h"
 
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+
 #include <iostream>
-#include <fstream>
 //#include <omp.h>
 
 #define DEBUG_TYPE "xten-dataflow-explorer"
@@ -72,31 +78,48 @@ namespace xilinx {
 
         // TODO for now both types are the same elementType
         DataflowExplorer::DataflowExplorer(std::vector<std::pair<std::string, AbsOpWrapper*>> &nameToOps) {
-            uint64_t id = 0;
+            std::vector<std::pair<std::string, std::map<std::string, int64_t>>> nameToSizes;
             for(auto pair : nameToOps) {
-                this->layerNameToID[pair.first] = id;
-                this->layerIdToName[id] = pair.first;
                 this->layerNameToOps.push_back(pair.second);
 
                 mlir::torch::Torch::BaseTensorType aShape = pair.second->getInput().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
                 ArrayRef<int64_t> aShapeAR = aShape.getSizes();
 
-                int64_t C = aShapeAR[C_LOC];
-                int64_t M = aShapeAR[M_LOC];
-                int64_t N = aShapeAR[N_LOC];
+                int64_t C;
+                int64_t M;
+                int64_t N;
+                if(aShapeAR.size() == 2) {
+                    // Matrices are seen as a single column image: rows are the lines, columns the channels
+                    C = aShapeAR[1];
+                    M = 1;
+                    N = aShapeAR[0];
+                } else {
+                    C = aShapeAR[C_LOC];
+                    M = aShapeAR[M_LOC];
+                    N = aShapeAR[N_LOC];
+                }
 
                 int64_t COut;
                 int64_t CIn;
                 int64_t F0;
                 int64_t F1;
                 bool dw = pair.second->isDepthWise();
-                if(pair.second->hasWeights()) {
+                // An mm reading an activation as y has no weights but still takes its sizes from y
+                if(pair.second->hasWeights() || llvm::isa<MMOp>(pair.second->getUnderlyingOperation())) {
                     mlir::torch::Torch::BaseTensorType wShape = pair.second->getWeights().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
                     ArrayRef<int64_t> wShapeAR = wShape.getSizes();
-                    COut = wShapeAR[COUT_LOC];
-                    CIn = wShapeAR[CIN_LOC];
-                    F0 = wShapeAR[F0_LOC];
-                    F1 = wShapeAR[F1_LOC];
+                    if(wShapeAR.size() == 2) { // MM, y is K x COut and behaves like a 1x1 kernel, linear weights are COut x K
+                        bool transposed = llvm::isa<LinearReLUOp>(pair.second->getUnderlyingOperation());
+                        COut = wShapeAR[transposed ? 0 : 1];
+                        CIn = wShapeAR[transposed ? 1 : 0];
+                        F0 = 1;
+                        F1 = 1;
+                    } else {
+                        COut = wShapeAR[COUT_LOC];
+                        CIn = wShapeAR[CIN_LOC];
+                        F0 = wShapeAR[F0_LOC];
+                        F1 = wShapeAR[F1_LOC];
+                    }
                 } else {
                     COut = C;
                     CIn = 1;
@@ -105,7 +128,17 @@ namespace xilinx {
                 }
 
                 std::map<std::string, uint64_t> stats = getStats(pair.second->getUnderlyingOperation());
-                uint64_t macs = (stats.count("ops:MAC") == 0) ? stats["ops:>"] : stats["ops:MAC"];
+                uint64_t macs = 0;
+                for(std::string key : {"ops:MAC", "ops:>", "ops:+", "ops:*"}) {
+                    if(stats.count(key) != 0) {
+                        macs = stats[key];
+                        break;
+                    }
+                }
+
+                // Ca and L chain the cores through the partial variant of the op, which only convolutions have
+                Operation* op = pair.second->getUnderlyingOperation();
+                bool partial = !llvm::isa<MMOp>(op) && !llvm::isa<LinearReLUOp>(op) && !llvm::isa<AddOp>(op) && !llvm::isa<MulOp>(op);
 
                 std::map<std::string, int64_t> sizes;
 
@@ -124,15 +157,43 @@ namespace xilinx {
                 sizes["eff"] = 100 * pair.second->getKernelEfficiency();
 
                 sizes["stride"] = pair.second->getStride();
+                sizes["weights"] = pair.second->hasWeights() ? 1 : 0;
+                sizes["partial"] = partial ? 1 : 0;
+
+                nameToSizes.push_back(std::make_pair(pair.first, sizes));
+            }
+
+            this->initializeLayers(nameToSizes);
+        }
 
-                this->layerNameToSize.push_back(sizes);
+        // Explorer working from layer descriptors only, no operation is attached to the layers
+        DataflowExplorer::DataflowExplorer(std::vector<std::pair<std::string, std::map<std::string, int64_t>>> &nameToSizes) {
+            this->initializeLayers(nameToSizes);
+        }
+
+        void DataflowExplorer::initializeLayers(std::vector<std::pair<std::string, std::map<std::string, int64_t>>> &nameToSizes) {
+            uint64_t id = 0;
+            for(auto pair : nameToSizes) {
+                this->layerNameToID[pair.first] = id;
+                this->layerIdToName[id] = pair.first;
+                this->layerNameToSize.push_back(pair.second);
+
+                // Descriptors built by hand may leave partial out, convolutions are the default
+                if(this->layerNameToSize.back().count("partial") == 0) {
+                    this->layerNameToSize.back()["partial"] = 1;
+                }
 
                 id++;
             }
 
             this->validTopologies = std::vector<std::vector<ModelParams>>(id, std::vector<ModelParams>());
-            mlir::torch::Torch::BaseTensorType aShape = this->layerNameToOps[0]->getInput().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
-            uint64_t aWidth = getElementWidth(aShape, FORCE_INT8);
+
+            this->numCandidates = 0;
+            this->numEdges = 0;
+            this->numCellsRelaxed = 0;
+            this->peakNodeMemory = 0;
+
+            uint64_t aWidth = (id == 0) ? 1 : this->layerNameToSize[0]["width"];
             this->arch = new AIEv1(aWidth, aWidth);
         }
 
@@ -146,7 +207,7 @@ namespace xilinx {
         // TODO this is not ideal, clean that up with proper pre / post transformation
         uint64_t DataflowExplorer::getLinesPerTile(uint64_t layerId, ModelParams &params) {
             if(params.P == 0 || params.Ca == 0 || params.L == 0 || params.W == 0) {
-                llvm::outs() << "params was 0 in getLinesPerTile...\n";
+                LLVM_DEBUG(llvm::outs() << "params was 0 in getLinesPerTile...\n");
             }
 
             int64_t C = this->layerNameToSize[layerId]["C"];
@@ -155,8 +216,8 @@ namespace xilinx {
 
             int64_t divider = (dw == DW_TRUE) ? params.P : params.Ca;
 
-            int64_t lineSize = (getMult8(ceil((float)C / divider)) * M) * this->layerNameToSize[layerId]["width"];
-            int64_t linesPerBanks = (int64_t)floor(this->arch->getBankSize() / (float)lineSize);
+            int64_t lineSize = (getMult8(ceilDiv(C, divider)) * M) * this->layerNameToSize[layerId]["width"];
+            int64_t linesPerBanks = this->arch->getBankSize() / lineSize;
 
             if(params.lineGranularity) {
                 return linesPerBanks >= 1 ? 1 : 0;
@@ -174,7 +235,7 @@ namespace xilinx {
             uint64_t banksPerLine = this->getBanksPerLine(layerId, params);
 
             uint64_t F0 = this->layerNameToSize[layerId]["F0"];
-            uint64_t F0OverF = ceil((float)(F0 / params.L));
+            uint64_t F0OverF = getMaxSplitSize(F0, params.L, LINE_BLOCK);
 
             uint64_t producedLines = linesPerTile;
             uint64_t worstLocLines = (F0OverF - 1) + producedLines;
@@ -183,7 +244,7 @@ namespace xilinx {
                 if(params.lineGranularity) {
                     return F0OverF;
                 } else {
-                    return 1 + ceil((float)(worstLocLines - 1) / linesPerTile);
+                    return 1 + ceilDiv(worstLocLines - 1, linesPerTile);
                 }
             } else {
                 return F0OverF * banksPerLine;
@@ -197,8 +258,8 @@ namespace xilinx {
 
             int64_t divider = (dw == DW_TRUE) ? params.P : params.Ca;
 
-            int64_t lineSize = (getMult8(ceil((float)C / divider)) * M) * this->layerNameToSize[layerId]["width"];
-            int64_t banksPerLine = (int64_t)ceil((float)lineSize / this->arch->getBankSize());
+            int64_t lineSize = (getMult8(ceilDiv(C, divider)) * M) * this->layerNameToSize[layerId]["width"];
+            int64_t banksPerLine = ceilDiv(lineSize, this->arch->getBankSize());
 
             return banksPerLine;
         }
@@ -207,7 +268,13 @@ namespace xilinx {
             uint64_t linesPerTile = this->getLinesPerTile(layerId, params);
 
             int64_t N = this->layerNameToSize[layerId]["N"];
-            uint64_t K = std::max((uint64_t)1, (uint64_t)ceil((float)N / linesPerTile));
+
+            // A line spans several banks, so a tile is a single line
+            if(linesPerTile == 0) {
+                return N;
+            }
+
+            uint64_t K = std::max((uint64_t)1, (uint64_t)ceilDiv(N, linesPerTile));
 
             //llvm::outs() << "N= " << N << " K = " << K << " linesPerTile = " << linesPerTile <<"\n";
             return K;
@@ -239,11 +306,12 @@ namespace xilinx {
             }
 
             uint64_t strideAdditionalBanks = 0;
-            if((stride > 1) && (N > 1)) {
+            if((stride > 1) && (N > 1) && (linesPerBanks != 0)) {
                 int64_t locLines = linesPerBanks * banksForFilter;
                 int64_t totLines = locLines + linesPerBanks;
-                if((std::floor((float)locLines / stride) * stride + F0) >= totLines) {
-                    strideAdditionalBanks = std::ceil((float)((std::floor((float)locLines / stride) * stride + F0) - totLines) / linesPerBanks);
+                int64_t lastLine = (locLines / stride) * stride + F0;
+                if(lastLine >= totLines) {
+                    strideAdditionalBanks = ceilDiv(lastLine - totLines, linesPerBanks);
                 }
             }
 
@@ -263,14 +331,9 @@ namespace xilinx {
             }
         }
 
-        // either 2 or 4
-        // TODO check that not in F duplication case
-        // TODO how do we handle biases?
-        uint64_t DataflowExplorer::getWeightBanks(uint64_t layerId, ModelParams &params) {
-            if(!this->layerNameToOps[layerId]->hasWeights()) {
-                return 0;
-            }
-
+        // Bytes of weights held by one core: its share of the output channels, input channels and filter lines
+        // The W replicas of a core hold the same weights
+        int64_t DataflowExplorer::getLocalWeightSize(uint64_t layerId, ModelParams &params) {
             int64_t COut = this->layerNameToSize[layerId]["COut"];
             int64_t CIn = this->layerNameToSize[layerId]["CIn"];
             int64_t F0 = this->layerNameToSize[layerId]["F0"];
@@ -278,12 +341,22 @@ namespace xilinx {
 
             //int64_t weightSize = COut * CIn * F0 * F1 * getElementWidth(wShape, FORCE_INT8);
 
-            int64_t locCout = getMult8(ceil((float)COut / params.P));
-            int64_t locCin = getMult8(ceil((float)CIn / params.Ca));
-            int64_t locF0 = ceil((float)F0 / params.L);
-            int64_t locWeightSize = locCout * locCin * locF0 * F1 * this->layerNameToSize[layerId]["width"];
+            int64_t locCout = getMult8(ceilDiv(COut, params.P));
+            int64_t locCin = getMult8(ceilDiv(CIn, params.Ca));
+            int64_t locF0 = ceilDiv(F0, params.L);
 
-            int64_t weightBanks = ceil(locWeightSize / this->arch->getBankSize());
+            return locCout * locCin * locF0 * F1 * this->layerNameToSize[layerId]["width"];
+        }
+
+        // either 2 or 4
+        // TODO check that not in F duplication case
+        // TODO how do we handle biases?
+        uint64_t DataflowExplorer::getWeightBanks(uint64_t layerId, ModelParams &params) {
+            if(!this->layerNameToSize[layerId]["weights"]) {
+                return 0;
+            }
+
+            int64_t weightBanks = this->getLocalWeightSize(layerId, params) / this->arch->getBankSize();
 
             if((weightBanks >= 4) || (weightBanks == 3)) {
                 return 4;
@@ -293,23 +366,11 @@ namespace xilinx {
         }
 
         bool DataflowExplorer::allWeightsIn(uint64_t layerId, ModelParams &params) {
-            if(!this->layerNameToOps[layerId]->hasWeights()) {
+            if(!this->layerNameToSize[layerId]["weights"]) {
                 return true;
             }
 
-            int64_t COut = this->layerNameToSize[layerId]["COut"];
-            int64_t CIn = this->layerNameToSize[layerId]["CIn"];
-            int64_t F0 = this->layerNameToSize[layerId]["F0"];
-            int64_t F1 = this->layerNameToSize[layerId]["F1"];
-
-            //int64_t weightSize = COut * CIn * F0 * F1 * getElementWidth(wShape, FORCE_INT8);
-
-            int64_t locCout = getMult8(ceil((float)COut / params.P));
-            int64_t locCin = getMult8(ceil((float)CIn / params.Ca));
-            int64_t locF0 = ceil((float)F0 / params.L);
-            int64_t locWeightSize = locCout * locCin * locF0 * F1 * this->layerNameToSize[layerId]["width"];
-
-            int64_t weightBanks = ceil(locWeightSize / this->arch->getBankSize());
+            int64_t weightBanks = this->getLocalWeightSize(layerId, params) / this->arch->getBankSize();
 
             if(weightBanks > 4) {
                 return false;
@@ -327,14 +388,30 @@ namespace xilinx {
             return inBanks + outBanks + weightBanks;
         }
 
+        // Buffers of one expanded op of the layer, params being the xten.dataflow attribute of the op
+        // The explorer works on the local shapes of the op, so only W (forwarding) and Ca and L
+        // (shared output) still have to be given to the model
+        BufferBanks DataflowExplorer::getLocalBufferBanks(uint64_t layerId, ModelParams &params) {
+            ModelParams local(1, 1, 1, params.W, params.lineGranularity);
+            ModelParams localNoForward(1, 1, 1, 1, params.lineGranularity);
+
+            BufferBanks banks;
+            banks.weights = this->getWeightBanks(layerId, local);
+            banks.input = this->getActivationInBanks(layerId, localNoForward);
+            banks.forward = this->getActivationInBanks(layerId, local) - banks.input;
+            banks.output = this->getActivationOutBanks(layerId, params);
+
+            return banks;
+        }
+
         uint64_t DataflowExplorer::getMissmatchChannels(int64_t dim, uint64_t param) {
-            uint64_t allGet = floor((float)dim / param) / 8;
+            uint64_t allGet = (dim / param) / 8;
             uint64_t someGet = dim / 8 - allGet * param;
             return someGet;
         }
 
         uint64_t DataflowExplorer::getMissmatchLines(int64_t dim, uint64_t param) {
-            uint64_t allGet = floor((float)dim / param);
+            uint64_t allGet = dim / param;
             uint64_t someGet = dim - allGet * param;
             return someGet;
         }
@@ -359,16 +436,17 @@ namespace xilinx {
             int64_t F0 = this->layerNameToSize[layerId]["F0"];
             //int64_t F1 = this->layerNameToSize[layerId]["F1"];
 
-            uint64_t missmatchCa = getMissmatchChannels(CIn, params.Ca);
-            uint64_t missmatchP = getMissmatchChannels(COut, params.P);
-            uint64_t missmatchL = getMissmatchLines(F0, params.L);
+            // Splits can be uneven, the slowest core is the one that gets the largest part of each dimension
+            int64_t maxCa = getMaxSplitSize(CIn, params.Ca, CHANNEL_BLOCK);
+            int64_t maxP = getMaxSplitSize(COut, params.P, CHANNEL_BLOCK);
+            int64_t maxL = getMaxSplitSize(F0, params.L, LINE_BLOCK);
 
-            // TODO double check this expression
             // TODO what about efficicency here?
-            uint64_t time  = macs / ((params.P - missmatchP) * (params.Ca - missmatchCa) * (params.L - missmatchL) * params.W);
+            uint64_t time = ceilDiv(macs * maxP * maxCa * maxL, COut * CIn * F0 * params.W);
 
-            float kernelEfficiency = (float)this->layerNameToSize[layerId]["eff"] / 100;
-            return (uint64_t)ceil(time / (this->arch->getVectSize() * kernelEfficiency));
+            // eff is the kernel efficiency in percent
+            int64_t eff = std::max((int64_t)1, this->layerNameToSize[layerId]["eff"]);
+            return ceilDiv(time * 100, this->arch->getVectSize() * eff);
         }
 
         uint64_t DataflowExplorer::getActCommunicationTimePerTile(uint64_t layerId, ModelParams &params) {
@@ -393,7 +471,7 @@ namespace xilinx {
             if(C <= 8) { // spetial trick for the first layer, at the moment assume just send what's necessary
                 actSize = C * M * N * this->layerNameToSize[layerId]["width"];
             } else {
-                actSize = getMult8(ceil((float)C / params.Ca)) * M * N * this->layerNameToSize[layerId]["width"];
+                actSize = getMult8(ceilDiv(C, params.Ca)) * M * N * this->layerNameToSize[layerId]["width"];
             }
 
             if(DW_SHARED && ((this->layerNameToSize[layerId]["DW"] == DW_TRUE)
@@ -404,24 +482,16 @@ namespace xilinx {
             return actSize / (params.W * this->arch->getComSpeed());
         }
 
+        // Time to stream the weights of one core when they do not fit in its banks
+        // W does not appear, the replicas of a core are fed by the same stream
         uint64_t DataflowExplorer::getWeightCommunicationTimePerTile(uint64_t layerId, ModelParams &params) {
-            if(!this->layerNameToOps[layerId]->hasWeights()) {
+            if(!this->layerNameToSize[layerId]["weights"]) {
                 return 0;
             }
 
-            int64_t COut = this->layerNameToSize[layerId]["COut"];
-            int64_t CIn = this->layerNameToSize[layerId]["CIn"];
-            int64_t F0 = this->layerNameToSize[layerId]["F0"];
-            int64_t F1 = this->layerNameToSize[layerId]["F1"];
-
-            //int64_t weightSize = COut * CIn * F0 * F1 * getElementWidth(wShape, FORCE_INT8);
-
-            int64_t locCout = getMult8(ceil((float)COut / params.P));
-            int64_t locCin = getMult8(ceil((float)CIn / params.Ca));
-            int64_t locF0 = ceil((float)F0 / params.L);
-            int64_t locWeightSize = locCout * locCin * locF0 * F1 * this->layerNameToSize[layerId]["width"];
+            int64_t locWeightSize = this->getLocalWeightSize(layerId, params);
 
-            int64_t weightBanks = ceil(locWeightSize / this->arch->getBankSize());
+            int64_t weightBanks = locWeightSize / this->arch->getBankSize();
 
             if(weightBanks <= 4) {
                 return 0;
@@ -442,6 +512,23 @@ namespace xilinx {
             }
         }
 
+        // Bytes of weights sent to the cores of the layer for one input, only used by the bottleneck report
+        // The W replicas of a core are fed by the same broadcast, so W does not count
+        uint64_t DataflowExplorer::getWeightStreamVolume(uint64_t layerId, ModelParams &params) {
+            if(!this->layerNameToSize[layerId]["weights"]) {
+                return 0;
+            }
+
+            uint64_t volume = this->getLocalWeightSize(layerId, params) * params.P * params.Ca * params.L;
+
+            // Weights that do not fit are streamed again for each tile
+            if(!this->allWeightsIn(layerId, params)) {
+                volume *= params.lineGranularity ? this->layerNameToSize[layerId]["N"] : this->getK(layerId, params);
+            }
+
+            return volume;
+        }
+
         uint64_t DataflowExplorer::getTotalTimePerTile(uint64_t layerId, ModelParams &params) {
             uint64_t weightComTile = this->getWeightCommunicationTimePerTile(layerId, params);
             uint64_t actComTile = this->getActCommunicationTimePerTile(layerId, params);
@@ -468,12 +555,9 @@ namespace xilinx {
         uint64_t DataflowExplorer::getTotalCompute() {
             uint64_t totalCompute = 0;
             uint64_t layerId = 0;
-            for(AbsOpWrapper* wrapped : this->layerNameToOps) {
-                (void)wrapped;
-                //Operation* op = wrapped->getUnderlyingOperation();
+            for(layerId = 0; layerId < this->layerNameToSize.size(); layerId++) {
                 uint64_t macs = this->layerNameToSize[layerId]["macs"];
                 totalCompute += macs;
-                layerId++;
             }
 
             return totalCompute;
@@ -576,8 +660,8 @@ namespace xilinx {
         std::vector<uint64_t> DataflowExplorer::getMemWeightPerLayer() {
             std::vector<uint64_t> memPerLayer;
 
-            for(uint64_t i = 0; i < this->layerNameToOps.size(); i++) {
-                if(this->layerNameToOps.at(i)->hasWeights()) {
+            for(uint64_t i = 0; i < this->layerNameToSize.size(); i++) {
+                if(this->layerNameToSize.at(i)["weights"]) {
                     int64_t COut = this->layerNameToSize.at(i)["COut"];
                     int64_t CIn = this->layerNameToSize.at(i)["CIn"];
                     int64_t F0 = this->layerNameToSize.at(i)["F0"];
@@ -592,6 +676,157 @@ namespace xilinx {
             return memPerLayer;
         }
 
+        // Evaluates the analytical model for a whole set of candidates of a layer
+        // Everything that only depends on one of P, Ca, L or W is tabulated once per layer, the candidates are
+        // then evaluated in branch-free passes over the batch arrays, one group of fields at a time
+        // Must give the same results as isValid, getTotalMemBanks and getTotalTime,
+        // xten-explore-bench -check-batch compares both over the full P, Ca, L, W grid
+        void DataflowExplorer::evaluateBatch(uint64_t layerId, ModelParamsBatch &batch) {
+            const int64_t C = this->layerNameToSize[layerId]["C"];
+            const int64_t M = this->layerNameToSize[layerId]["M"];
+            const int64_t N = this->layerNameToSize[layerId]["N"];
+            const int64_t COut = this->layerNameToSize[layerId]["COut"];
+            const int64_t CIn = this->layerNameToSize[layerId]["CIn"];
+            const int64_t F0 = this->layerNameToSize[layerId]["F0"];
+            const int64_t F1 = this->layerNameToSize[layerId]["F1"];
+            const int64_t width = this->layerNameToSize[layerId]["width"];
+            const int64_t stride = std::max((int64_t)1, this->layerNameToSize[layerId]["stride"]);
+            const uint64_t macs = this->layerNameToSize[layerId]["macs"];
+            const int64_t eff = std::max((int64_t)1, this->layerNameToSize[layerId]["eff"]);
+            const bool dw = this->layerNameToSize[layerId]["DW"] == DW_TRUE;
+            const bool hasWeights = this->layerNameToSize[layerId]["weights"];
+            const bool partial = this->layerNameToSize[layerId]["partial"];
+
+            const bool nextDW = (layerId < (this->layerNameToSize.size()-1)) && (this->layerNameToSize.at(layerId+1)["DW"] == DW_TRUE);
+            const bool sharedIn = DW_SHARED && dw && (layerId > 0) && (this->layerNameToSize[layerId-1]["DW"] == DW_FALSE);
+
+            const int64_t bankSize = this->arch->getBankSize();
+            const int64_t numBanks = this->arch->getNumBanks();
+            const int64_t comSpeed = this->arch->getComSpeed();
+            const int64_t vectSize = this->arch->getVectSize();
+            const uint64_t fullWork = COut * C * F0;
+
+            const uint64_t n = batch.size();
+            batch.valid.resize(n);
+            batch.memBanks.resize(n);
+            batch.totalTime.resize(n);
+
+            const uint32_t* P = batch.P.data();
+            const uint32_t* Ca = batch.Ca.data();
+            const uint32_t* L = batch.L.data();
+            const uint32_t* W = batch.W.data();
+            const uint8_t* lg = batch.lineGranularity.data();
+            const uint32_t* divider = dw ? P : Ca;
+
+            uint8_t* valid = batch.valid.data();
+            uint64_t* memBanks = batch.memBanks.data();
+            uint64_t* totalTime = batch.totalTime.data();
+
+            // Tables by split factor, indexed by the P, Ca, L or W of a candidate
+            uint32_t maxFactor = 1;
+            for(uint64_t i = 0; i < n; i++) {
+                maxFactor = std::max(maxFactor, std::max(std::max(P[i], Ca[i]), std::max(L[i], W[i])));
+            }
+
+            std::vector<int64_t> maxCaOf(maxFactor + 1), maxPOf(maxFactor + 1), maxLOf(maxFactor + 1);
+            std::vector<int64_t> linesPerBankOf(maxFactor + 1), banksPerLineOf(maxFactor + 1);
+            std::vector<int64_t> locCOutOf(maxFactor + 1), locCInOf(maxFactor + 1), locF0Of(maxFactor + 1);
+            std::vector<int64_t> actSizeOf(maxFactor + 1);
+            std::vector<uint8_t> enoughCInOf(maxFactor + 1), enoughCOutOf(maxFactor + 1);
+            std::vector<uint8_t> enoughFOf(maxFactor + 1), enoughWOf(maxFactor + 1);
+            for(int64_t f = 1; f <= maxFactor; f++) {
+                // getComputeTime, getTilesPerCore
+                maxCaOf[f] = getMaxSplitSize(C, f, CHANNEL_BLOCK);
+                maxPOf[f] = getMaxSplitSize(COut, f, CHANNEL_BLOCK);
+                maxLOf[f] = getMaxSplitSize(F0, f, LINE_BLOCK);
+
+                // getLinesPerTile, getBanksPerLine
+                int64_t lineSize = getMult8(ceilDiv(C, f)) * M * width;
+                linesPerBankOf[f] = bankSize / lineSize;
+                banksPerLineOf[f] = ceilDiv(lineSize, bankSize);
+
+                // getLocalWeightSize
+                locCOutOf[f] = getMult8(ceilDiv(COut, f));
+                locCInOf[f] = getMult8(ceilDiv(CIn, f));
+                locF0Of[f] = ceilDiv(F0, f);
+
+                // getActCommunicationTime
+                actSizeOf[f] = sharedIn ? 0 : (((C <= 8) ? C : getMult8(ceilDiv(C, f))) * M * N * width);
+
+                // isValid
+                enoughCInOf[f] = ((CIn / f) >= 8) || dw || ((CIn <= 8) && (f == 1));
+                enoughCOutOf[f] = (COut / f) >= 8;
+                enoughFOf[f] = (F0 / f) >= 1;
+                enoughWOf[f] = (N / f) >= 1;
+            }
+
+            // getLinesPerTile, getBanksPerLine, getTilesPerCore, getK
+            std::vector<int64_t> linesPerTile(n), banksPerLine(n), tilesPerCore(n), tiles(n);
+            for(uint64_t i = 0; i < n; i++) {
+                int64_t linesPerBank = linesPerBankOf[divider[i]];
+                int64_t lines = lg[i] ? std::min(linesPerBank, (int64_t)1) : linesPerBank;
+                int64_t safeLines = std::max((int64_t)1, lines);
+                int64_t F0OverF = maxLOf[L[i]];
+
+                int64_t tilesLines = lg[i] ? F0OverF : (1 + ceilDiv(F0OverF + lines - 2, safeLines));
+                int64_t K = (lines != 0) ? std::max((int64_t)1, ceilDiv(N, safeLines)) : N;
+
+                linesPerTile[i] = lines;
+                banksPerLine[i] = banksPerLineOf[divider[i]];
+                tilesPerCore[i] = (lines != 0) ? tilesLines : (F0OverF * banksPerLine[i]);
+                tiles[i] = lg[i] ? N : K;
+            }
+
+            // getActivationInBanks, getActivationOutBanks, getWeightBanks
+            std::vector<int64_t> locWeightSize(n);
+            for(uint64_t i = 0; i < n; i++) {
+                int64_t lines = linesPerTile[i];
+                int64_t minBanksForFilter = ((F0 == 1) || (N <= lines)) ? 1 : 2;
+                int64_t banksForFilter = std::max(minBanksForFilter, tilesPerCore[i]);
+                int64_t forwardTileSize = (W[i] > 1) ? ((lines == 0) ? banksPerLine[i] : 1) : 0;
+                int64_t locLines = lines * banksForFilter;
+                int64_t totLines = locLines + lines;
+                int64_t lastLine = (locLines / stride) * stride + F0;
+                bool strideExtra = (stride > 1) && (N > 1) && (lines != 0) && (lastLine >= totLines);
+                int64_t strideAdditionalBanks = strideExtra ? ceilDiv(lastLine - totLines, std::max((int64_t)1, lines)) : 0;
+                int64_t inBanks = banksForFilter + banksPerLine[i] + forwardTileSize + strideAdditionalBanks;
+
+                int64_t outBanks = nextDW ? 0 : (((Ca[i] == 1) && (L[i] == 1)) ? 2 : 1);
+
+                locWeightSize[i] = locCOutOf[P[i]] * locCInOf[Ca[i]] * locF0Of[L[i]] * F1 * width;
+                int64_t weightBanks = hasWeights ? (((locWeightSize[i] / bankSize) >= 3) ? 4 : 2) : 0;
+
+                memBanks[i] = inBanks + outBanks + weightBanks;
+            }
+
+            // isValid
+            for(uint64_t i = 0; i < n; i++) {
+                bool notTooMuchW = W[i] <= 12;
+                bool noCaIfDW = !dw || (Ca[i] == 1);
+                bool noChainIfNoPartial = partial || ((Ca[i] == 1) && (L[i] == 1));
+                bool memFit = dw || (memBanks[i] <= (uint64_t)numBanks);
+
+                valid[i] = enoughCInOf[Ca[i]] && enoughCOutOf[P[i]] && enoughFOf[L[i]] && enoughWOf[W[i]] &&
+                    notTooMuchW && noCaIfDW && noChainIfNoPartial && memFit;
+            }
+
+            // getComputeTime, getActCommunicationTime, getWeightCommunicationTimePerTile, getTotalTime
+            for(uint64_t i = 0; i < n; i++) {
+                uint64_t work = ceilDiv(macs * maxPOf[P[i]] * maxCaOf[Ca[i]] * maxLOf[L[i]], fullWork * W[i]);
+                uint64_t computeTime = ceilDiv(work * 100, vectSize * eff);
+
+                uint64_t actComTime = actSizeOf[Ca[i]] / (W[i] * comSpeed);
+
+                bool weightStream = hasWeights && ((locWeightSize[i] / bankSize) > 4);
+                uint64_t weightComTile = weightStream ? (locWeightSize[i] / comSpeed) : 0;
+
+                uint64_t totalTimeTile = std::max(std::max(actComTime / tiles[i], weightComTile), computeTime / tiles[i]);
+                totalTimeTile = std::max((uint64_t)1, totalTimeTile);
+
+                totalTime[i] = tiles[i] * totalTimeTile;
+            }
+        }
+
         // Explore functions
         std::vector<uint64_t>  DataflowExplorer::generateExplorationBounds() {
             std::vector<uint64_t> macsPerLayer;
@@ -599,10 +834,10 @@ namespace xilinx {
 
             uint64_t sum = 0;
             uint64_t sumMem = 0;
-            for(uint64_t i = 0; i < this->layerNameToOps.size(); i++) {
+            for(uint64_t i = 0; i < this->layerNameToSize.size(); i++) {
                 uint64_t macs = this->layerNameToSize.at(i)["macs"];
 
-                llvm::outs() << "macs were: " << macs << "\n";
+                LLVM_DEBUG(llvm::outs() << "macs were: " << macs << "\n");
 
                 macsPerLayer.push_back(macs);
                 sum += macs;
@@ -640,6 +875,7 @@ namespace xilinx {
             int64_t COut = this->layerNameToSize[layerId]["COut"];
             int64_t F0 = this->layerNameToSize[layerId]["F0"];
             int64_t dw = this->layerNameToSize[layerId]["DW"];
+            bool partial = this->layerNameToSize[layerId]["partial"];
 
             bool enoughCIn = ((CIn / params.Ca) >= 8) || (dw == DW_TRUE) || ((CIn <= 8) && params.Ca == 1);
             bool enoughCOut = (COut / params.P) >= 8;
@@ -647,6 +883,7 @@ namespace xilinx {
             bool enoughW = (N / params.W) >= 1;
             bool notTooMuchW = params.W <= 12; // TODO arbitrary, tune this
             bool noCaIfDW = (dw == DW_TRUE) ? (params.Ca == 1) : true;
+            bool noChainIfNoPartial = partial || ((params.Ca == 1) && (params.L == 1));
 
             //unsigned int p0 = std::max(params.P, params.Ca);
             //unsigned int p1 = std::min(params.P, params.Ca);
@@ -655,7 +892,7 @@ namespace xilinx {
 
             //double layerUtilization = this->getLayerUtilization(layerId, params);
 
-            if(enoughCIn && enoughCOut && enoughF && enoughW && notTooMuchW && noCaIfDW) {
+            if(enoughCIn && enoughCOut && enoughF && enoughW && notTooMuchW && noCaIfDW && noChainIfNoPartial) {
                 if(dw == DW_TRUE) {
                     // defer memFit analysis to when we have the cascade information
                     // TODO maybe add a defer annotation to be more generic
@@ -674,40 +911,45 @@ namespace xilinx {
             std::vector<uint64_t> bounds = this->generateExplorationBounds();
 
             for(auto i : bounds) {
-                llvm::outs() << "Bounds: " << i << "\n";
+                LLVM_DEBUG(llvm::outs() << "Bounds: " << i << "\n");
             }
 
             for(uint64_t layerId = 0; layerId < bounds.size(); layerId++) {
-                llvm::outs() << "generating nodes for layer: " << layerId << "\n";
+                LLVM_DEBUG(llvm::outs() << "generating nodes for layer: " << layerId << "\n");
                 uint64_t layerCores = bounds.at(layerId);
-                uint64_t F0 = this->layerNameToOps[layerId]->getF0();
+                uint64_t F0 = this->layerNameToSize[layerId]["F0"];
+
+                // Even entries use line granularity, odd entries tile granularity
+                ModelParamsBatch batch;
                 for(uint64_t p = 1; p <= layerCores; p++) {
-                    for(uint64_t ca = 1; ca <= layerCores; ca++) {
-                        for(uint64_t f = 1; f <= F0; f++) {
-                            for(uint64_t w = 1; w <= layerCores; w++) {
-                                uint64_t area = p * ca * f * w;
-                                if(area <= layerCores) {
-                                    ModelParams paramsLine(p, ca, f, w, true);
-                                    ModelParams paramsTile(p, ca, f, w, false);
-
-                                    bool lineValid = this->isValid(layerId, paramsLine) && (f != 1);
-                                    bool tileValid = this->isValid(layerId, paramsTile);
-                                    if(lineValid && tileValid) {
-                                        if(this->getTotalTime(layerId, paramsLine) >= this->getTotalTime(layerId, paramsTile)) {
-                                            this->validTopologies.at(layerId).push_back(paramsTile);
-                                        } else {
-                                            this->validTopologies.at(layerId).push_back(paramsLine);
-                                        }
-                                    } else if(tileValid) {
-                                        this->validTopologies.at(layerId).push_back(paramsTile);
-                                    } else if(lineValid) {
-                                        this->validTopologies.at(layerId).push_back(paramsLine);
-                                    }
-                                }
+                    for(uint64_t ca = 1; ca <= layerCores / p; ca++) {
+                        for(uint64_t f = 1; f <= std::min(F0, layerCores / (p * ca)); f++) {
+                            for(uint64_t w = 1; w <= layerCores / (p * ca * f); w++) {
+                                batch.push_back(ModelParams(p, ca, f, w, true));
+                                batch.push_back(ModelParams(p, ca, f, w, false));
                             }
                         }
                     }
                 }
+
+                this->evaluateBatch(layerId, batch);
+                this->numCandidates += batch.size();
+
+                for(uint64_t i = 0; i < batch.size(); i += 2) {
+                    bool lineValid = batch.valid[i] && (batch.L[i] != 1);
+                    bool tileValid = batch.valid[i+1];
+                    if(lineValid && tileValid) {
+                        if(batch.totalTime[i] >= batch.totalTime[i+1]) {
+                            this->validTopologies.at(layerId).push_back(batch.at(i+1));
+                        } else {
+                            this->validTopologies.at(layerId).push_back(batch.at(i));
+                        }
+                    } else if(tileValid) {
+                        this->validTopologies.at(layerId).push_back(batch.at(i+1));
+                    } else if(lineValid) {
+                        this->validTopologies.at(layerId).push_back(batch.at(i));
+                    }
+                }
             }
         }
 
@@ -743,12 +985,38 @@ namespace xilinx {
             return std::abs(locNorm - prevNorm) > maxDist;
         }
 
+        // Returns true if loc can be used for layerId when prev is used for layerId-1
+        // Takes into account communication characteristics of the underlying architecture
+        bool DataflowExplorer::canFollow(uint64_t layerId, ModelParams &prev, ModelParams &loc) {
+            unsigned int nP = prev.P;
+            unsigned int nW = prev.W;
+            unsigned int L = loc.L;
+            unsigned int W = loc.W;
+
+            bool wFine = (nW == 1) || (nW == L) || (nW == W);
+
+            if(this->layerNameToSize.at(layerId)["DW"] == DW_TRUE) {
+                bool dwFine = true;
+
+                if(layerId > 0) {
+                    uint64_t memDW = this->getTotalMemBanks(layerId, loc);
+                    uint64_t memPrev = this->getTotalMemBanks(layerId-1, prev);
+
+                    dwFine = (memDW + memPrev) <= (2 * this->arch->getNumBanks());
+                }
+
+                return dwFine && (nP == loc.P) && wFine;
+            } else {
+                return (nP == loc.Ca) && wFine;
+            }
+        }
+
         // take valid topologies and build a graph with ins set to all nodes, areaToNode left empty
         // Also take into account communication characteristics of the underlying architecture
         void DataflowExplorer::generatePathGraph() {
             std::vector<uint64_t> bounds = this->generateExplorationBounds();
 
-            llvm::outs() << "Generate graph\n";
+            LLVM_DEBUG(llvm::outs() << "Generate graph\n");
             this->pathGraph = std::vector<std::vector<Node_t*>>(this->validTopologies.size() + 2, std::vector<Node_t*>());
 
             Node_t* root = new Node_t(ModelParams(0,0,0,0,false), 0);
@@ -763,7 +1031,7 @@ namespace xilinx {
 
             uint64_t unitOps = 0;
             for(unsigned int layerId = 0; layerId < this->validTopologies.size(); layerId++) {
-                llvm::outs() << "Generating graph for layer: " << layerId << "\n";
+                LLVM_DEBUG(llvm::outs() << "Generating graph for layer: " << layerId << "\n");
                 for(ModelParams p : this->validTopologies.at(layerId)) {
                     if(layerId == 0) {
                         Node_t* node = new Node_t(p, 0);
@@ -774,60 +1042,19 @@ namespace xilinx {
 
                         // Iterate over previous layer nodes
                         for(Node_t* n : this->pathGraph.at(layerId)) {
-                            if(this->layerNameToSize.at(layerId)["DW"] == DW_TRUE) {
-                                bool dwFine = true;
-
-                                if((layerId > 0) && (this->layerNameToSize.at(layerId)["DW"] == DW_TRUE)) {
-                                    uint64_t memDW = this->getTotalMemBanks(layerId, p);
-                                    uint64_t memPrev = this->getTotalMemBanks(layerId-1, n->params);
-
-                                    dwFine = (memDW + memPrev) <= (2 * this->arch->getNumBanks());
-                                }
-
-                                unsigned int nP = n->params.P;
-                                unsigned int nW = n->params.W;
-                                unsigned int P = p.P;
-                                unsigned int L = p.L;
-                                unsigned int W = p.W;
-
-                                //bool pruned = this->prune(node, layerId, n);
-                                /*bool pruned;
-                                if(layerId == 0) {
-                                    pruned = false;
-                                } else {
-                                    pruned = this->prune(node, layerId, n, bounds.at(layerId), bounds.at(layerId-1), MAX_DIST);
-                                    }*/
-
-
-                                // Take into account communication constraints
-                                if(dwFine && (nP == P) && ((nW == 1) || (nW == L) || (nW == W))) {
-                                    //if(!pruned) {
-                                    node->ins.push_back(n);
-                                    unitOps++;
-                                    //}
-                                }
+                            //bool pruned = this->prune(node, layerId, n);
+                            /*bool pruned;
+                            if(layerId == 0) {
+                                pruned = false;
                             } else {
-                                unsigned int nP = n->params.P;
-                                unsigned int nW = n->params.W;
-                                unsigned int Ca = p.Ca;
-                                unsigned int L = p.L;
-                                unsigned int W = p.W;
-
-                                //bool pruned = this->prune(node, layerId, n);
-                                /*bool pruned;
-                                if(layerId == 0) {
-                                    pruned = false;
-                                } else {
-                                    pruned = this->prune(node, layerId, n, bounds.at(layerId), bounds.at(layerId-1), MAX_DIST);
-                                    }*/
-
-                                // Take into account communication constraints
-                                if((nP == Ca) && ((nW == 1) || (nW == L) || (nW == W))) {
-                                    //if(!pruned) {
-                                    node->ins.push_back(n);
-                                    unitOps++;
-                                    //}
-                                }
+                                pruned = this->prune(node, layerId, n, bounds.at(layerId), bounds.at(layerId-1), MAX_DIST);
+                                }*/
+
+                            if(this->canFollow(layerId, n->params, p)) {
+                                //if(!pruned) {
+                                node->ins.push_back(n);
+                                unitOps++;
+                                //}
                             }
                         }
 
@@ -845,7 +1072,8 @@ namespace xilinx {
 
             this->pathGraph.at(this->pathGraph.size() - 1).push_back(sink);
 
-            llvm::outs() << "UnitOps = " << 400 * unitOps * 2 << "\n";
+            this->numEdges = unitOps;
+            LLVM_DEBUG(llvm::outs() << "UnitOps = " << 400 * unitOps * 2 << "\n");
         }
 
         // Uses the ins generated by previous function to build the areaToNode for all functions
@@ -853,11 +1081,11 @@ namespace xilinx {
         // TODO could potentially parallelize that stuf..
         // TODO maybe we should also remove some of the copies / cleanup layers when we are done with them?
         void DataflowExplorer::enumeratePaths() {
-            llvm::outs() << "Path Graph.size() = " << this->pathGraph.size() << "\n";
+            LLVM_DEBUG(llvm::outs() << "Path Graph.size() = " << this->pathGraph.size() << "\n");
             //llvm::outs() << omp_get_num_threads();
 
             for(uint64_t layer = 1; layer < this->pathGraph.size(); layer++) {
-                llvm::outs() << "Handling layer: " << layer << "\n";
+                LLVM_DEBUG(llvm::outs() << "Handling layer: " << layer << "\n");
 
                 //#pragma omp parallel for
                 for(uint64_t n = 0; n < this->pathGraph.at(layer).size(); n++) {
@@ -874,6 +1102,8 @@ namespace xilinx {
                                 uint64_t nArea = i + layerNode->params.cores();
 
                                 if(nArea <= this->arch->getNumCores()) {
+                                    this->numCellsRelaxed++;
+
                                     // TODO revert the totaltime cache: it's useless
                                     uint64_t nodeTotalTime;
                                     if(layer == this->pathGraph.size()-1) {
@@ -909,6 +1139,8 @@ namespace xilinx {
                                 uint64_t nArea = i + layerNode->params.cores();
 
                                 if(nArea <= this->arch->getNumCores()) {
+                                    this->numCellsRelaxed++;
+
                                     uint64_t nodeTotalTime = (layer == this->pathGraph.size()-1) ? 0 : this->getTotalTime(layer-1, layerNode->params);
 
                                     uint64_t nLatency;
@@ -933,6 +1165,30 @@ namespace xilinx {
                     }
                 }
             }
+
+            // Nodes are only released by getParetoFrontierAndCleanGraph, so the graph is at its largest here
+            this->peakNodeMemory = std::max(this->peakNodeMemory, this->getPathGraphMemory());
+        }
+
+        // Bytes used by the nodes of the path graph and the paths they hold
+        uint64_t DataflowExplorer::getPathGraphMemory() {
+            uint64_t mem = 0;
+            for(std::vector<Node_t*> &layer : this->pathGraph) {
+                for(Node_t* node : layer) {
+                    mem += sizeof(Node_t) + node->ins.capacity() * sizeof(Node_t*);
+                    mem += (node->areaToThroughput.capacity() + node->areaToLatency.capacity()) * sizeof(PathInfo_t);
+
+                    for(PathInfo_t &info : node->areaToThroughput) {
+                        mem += info.path.capacity() * sizeof(ModelParams);
+                    }
+
+                    for(PathInfo_t &info : node->areaToLatency) {
+                        mem += info.path.capacity() * sizeof(ModelParams);
+                    }
+                }
+            }
+
+            return mem;
         }
 
         void DataflowExplorer::getParetoFrontierAndCleanGraph() {
@@ -959,14 +1215,161 @@ namespace xilinx {
             }
         }
 
-        void DataflowExplorer::enumerate() {
-            this->generateValidTopologies();
-            this->dumpValidTopologies();
-            this->generatePathGraph();
+        void DataflowExplorer::enumerate(llvm::function_ref<void(const char*, llvm::function_ref<void()>)> runPhase) {
+            runPhase("generateValidTopologies", [&]() { this->generateValidTopologies(); });
+            runPhase("generatePathGraph", [&]() { this->generatePathGraph(); });
             //this->dfs(true);
-            this->dumpMacs();
-            this->enumeratePaths();
-            this->getParetoFrontierAndCleanGraph();
+            runPhase("enumeratePaths", [&]() { this->enumeratePaths(); });
+            runPhase("getParetoFrontierAndCleanGraph", [&]() { this->getParetoFrontierAndCleanGraph(); });
+        }
+
+        void DataflowExplorer::enumerate() {
+            this->enumerate([](const char* phase, llvm::function_ref<void()> run) { run(); });
+        }
+
+        // Layer descriptors
+
+        // Keys of layerNameToSize, with the value used when a descriptor does not provide it
+        // A value of -1 means that the key is mandatory
+        static const std::vector<std::pair<std::string, int64_t>> descriptorKeys = {
+            {"C", -1}, {"M", -1}, {"N", -1}, {"COut", -1}, {"CIn", -1}, {"F0", -1}, {"F1", -1}, {"macs", -1},
+            {"width", 1}, {"DW", DW_FALSE}, {"eff", 100}, {"stride", 1}, {"weights", 1}, {"partial", 1}
+        };
+
+        static bool completeDescriptor(std::string name, std::map<std::string, int64_t> &sizes) {
+            for(auto key : descriptorKeys) {
+                if(sizes.count(key.first) == 0) {
+                    if(key.second < 0) {
+                        llvm::errs() << "Layer " << name << " is missing " << key.first << "\n";
+                        return false;
+                    }
+
+                    sizes[key.first] = key.second;
+                }
+            }
+
+            return true;
+        }
+
+        std::string DataflowExplorer::emitLayerDescriptors() {
+            llvm::json::Array layers;
+            for(uint64_t i = 0; i < this->layerNameToSize.size(); i++) {
+                llvm::json::Object layer;
+                layer["name"] = this->layerIdToName[i];
+                for(auto key : descriptorKeys) {
+                    layer[key.first] = this->layerNameToSize[i][key.first];
+                }
+
+                layers.push_back(llvm::json::Value(std::move(layer)));
+            }
+
+            llvm::json::Object top;
+            top["layers"] = llvm::json::Value(std::move(layers));
+
+            llvm::json::Value topv(std::move(top));
+            std::string ret;
+            llvm::raw_string_ostream ss(ret);
+            ss << llvm::formatv("{0:2}", topv) << "\n";
+            return ss.str();
+        }
+
+        // Reads the output of emitLayerDescriptors, or a CSV file whose first line names the columns
+        // Layers are expected in network order
+        bool parseLayerDescriptors(std::string filename, std::vector<std::pair<std::string, std::map<std::string, int64_t>>> &layers) {
+            auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(filename);
+            if(!buffer) {
+                llvm::errs() << "Cannot open " << filename << ": " << buffer.getError().message() << "\n";
+                return false;
+            }
+
+            StringRef content = (*buffer)->getBuffer();
+
+            if(content.ltrim().startswith("{")) {
+                llvm::Expected<llvm::json::Value> parsed = llvm::json::parse(content);
+                if(!parsed) {
+                    llvm::errs() << "Cannot parse " << filename << ": " << llvm::toString(parsed.takeError()) << "\n";
+                    return false;
+                }
+
+                llvm::json::Object* top = parsed->getAsObject();
+                llvm::json::Array* jLayers = (top == nullptr) ? nullptr : top->getArray("layers");
+                if(jLayers == nullptr) {
+                    llvm::errs() << filename << " does not contain a layers array\n";
+                    return false;
+                }
+
+                for(llvm::json::Value &v : *jLayers) {
+                    llvm::json::Object* jLayer = v.getAsObject();
+                    llvm::Optional<StringRef> name = (jLayer == nullptr) ? llvm::None : jLayer->getString("name");
+                    if(!name.hasValue()) {
+                        llvm::errs() << "Layer without a name in " << filename << "\n";
+                        return false;
+                    }
+
+                    std::map<std::string, int64_t> sizes;
+                    for(auto key : descriptorKeys) {
+                        llvm::Optional<int64_t> value = jLayer->getInteger(key.first);
+                        if(value.hasValue()) {
+                            sizes[key.first] = value.getValue();
+                        }
+                    }
+
+                    if(!completeDescriptor(name.getValue().str(), sizes)) {
+                        return false;
+                    }
+
+                    layers.push_back(std::make_pair(name.getValue().str(), sizes));
+                }
+            } else {
+                SmallVector<StringRef, 64> lines;
+                content.split(lines, '\n', -1, false);
+                if(lines.size() == 0) {
+                    llvm::errs() << filename << " is empty\n";
+                    return false;
+                }
+
+                SmallVector<StringRef, 16> header;
+                lines[0].split(header, ',');
+
+                for(uint64_t l = 1; l < lines.size(); l++) {
+                    if(lines[l].trim().empty()) {
+                        continue;
+                    }
+
+                    SmallVector<StringRef, 16> fields;
+                    lines[l].split(fields, ',');
+                    if(fields.size() != header.size()) {
+                        llvm::errs() << filename << ":" << l+1 << ": expected " << header.size() << " fields\n";
+                        return false;
+                    }
+
+                    std::string name;
+                    std::map<std::string, int64_t> sizes;
+                    for(uint64_t f = 0; f < fields.size(); f++) {
+                        StringRef key = header[f].trim();
+                        if(key == "name") {
+                            name = fields[f].trim().str();
+                        } else {
+                            int64_t value;
+                            if(fields[f].trim().getAsInteger(10, value)) {
+                                llvm::errs() << filename << ":" << l+1 << ": " << key << " is not an integer\n";
+                                return false;
+                            }
+
+                            sizes[key.str()] = value;
+                        }
+                    }
+
+                    if(name.empty() || !completeDescriptor(name, sizes)) {
+                        llvm::errs() << filename << ":" << l+1 << ": invalid layer descriptor\n";
+                        return false;
+                    }
+
+                    layers.push_back(std::make_pair(name, sizes));
+                }
+            }
+
+            return true;
         }
 
         // Visualisations stuff
@@ -988,7 +1391,7 @@ namespace xilinx {
             }
         }
 
-        void DataflowExplorer::dumpModelParam(ModelParams &params, std::ofstream &outputFile, std::string layerName, uint64_t i) {
+        void DataflowExplorer::dumpModelParam(ModelParams &params, llvm::raw_ostream &outputFile, std::string layerName, uint64_t i) {
             uint64_t K = this->getK(i, params);
             uint64_t mem = this->getTotalMemBanks(i, params);
             uint64_t compute = this->getComputeTime(i, params);
@@ -1004,105 +1407,100 @@ namespace xilinx {
 
         }
 
-        void DataflowExplorer::dumpValidTopologies() {
-            std::vector<std::string> names(this->layerNameToID.size(), "");
-            llvm::outs() << "ValidTopologies size: " << this->validTopologies.size() << " namesSize " << names.size() << "\n";
-
-            std::map<std::string, uint64_t>::iterator it;
-            for(it = this->layerNameToID.begin(); it != this->layerNameToID.end(); it++) {
-                names[it->second] = it->first;
-            }
+        void DataflowExplorer::dumpValidTopologies(llvm::raw_ostream &out) {
+            LLVM_DEBUG(llvm::outs() << "ValidTopologies size: " << this->validTopologies.size() << "\n");
 
-            std::ofstream configs;
-            configs.open("./output/configs.csv", std::ios::out);
-            configs << "layerName P Ca L W K Mem Compute ActCommunication WeightCommunication TotalTime MemActIn MemActOut MemWeight\n";
+            out << "# configs\n";
+            out << "layerName P Ca L W K Mem Compute ActCommunication WeightCommunication TotalTime MemActIn MemActOut MemWeight\n";
 
             for(uint64_t i = 0; i < this->validTopologies.size(); i++) {
-                llvm::outs() << "Layer: " << names[i] << ", with valid topologies: " << this->validTopologies.at(i).size() << "\n";
+                LLVM_DEBUG(llvm::outs() << "Layer: " << this->layerIdToName[i] << ", with valid topologies: " << this->validTopologies.at(i).size() << "\n");
                 for(ModelParams elem : this->validTopologies.at(i)) {
-                    this->dumpModelParam(elem, configs, names[i], i);
+                    this->dumpModelParam(elem, out, this->layerIdToName[i], i);
                 }
             }
-            configs.close();
         }
 
-        void DataflowExplorer::dumpParetoFrontiers() {
-            std::ofstream pareto;
-            pareto.open("./output/pareto_throughput.csv", std::ios::out);
-            pareto << "Area Throughput Utilization LocUtilization Latency\n";
+        void DataflowExplorer::dumpParetoFrontiers(llvm::raw_ostream &out) {
+            out << "# pareto_throughput\n";
+            out << "Area Throughput Utilization LocUtilization Latency\n";
 
             for(uint64_t i = 0; i < this->paretoThroughput.size(); i++) {
                 if(this->paretoThroughput.at(i).path.size() != 0) {
-                    //llvm::outs() << "For area: " << i << " has " << this->paretoThroughput.at(i).value << "\n";
-                    //for(uint64_t j = 0; j < this->paretoThroughput.at(i).size(); j++) {
-                    //    this->paretoThroughput.at(i).at(j).print();
-                    //}
                     double totUtilization = this->getUtilization(this->paretoThroughput.at(i).path, this->arch->getNumCores());
                     double usedUtilization = this->getUtilization(this->paretoThroughput.at(i).path, i);
                     double endToEndLatency = this->getEndToEndLatency(this->paretoThroughput.at(i).path);
 
-                    pareto << i << " " << this->paretoThroughput.at(i).value << " "
-                           << totUtilization << " " << usedUtilization << " " << endToEndLatency << "\n";
+                    out << i << " " << this->paretoThroughput.at(i).value << " "
+                        << totUtilization << " " << usedUtilization << " " << endToEndLatency << "\n";
                 }
             }
 
-            pareto.close();
-
-            pareto.open("./output/pareto_latency.csv", std::ios::out);
-            pareto << "Area Latency\n";
+            out << "# pareto_latency\n";
+            out << "Area Latency\n";
 
             for(uint64_t i = 0; i < paretoLatency.size(); i++) {
                 if(paretoLatency.at(i).path.size() != 0) {
-                    //llvm::outs() << "For area: " << i << " has " << this->getEndToEndLatency(this->paretoLatency.at(i)) << "\n";
-                    //for(uint64_t j = 0; j < this->paretoLatency.at(i).size(); j++) {
-                    //    this->paretoLatency.at(i).at(j).print();
-                    //}
                     double totUtilization = this->getUtilization(this->paretoLatency.at(i).path, this->arch->getNumCores());
                     uint64_t usedUtilization = this->getUtilization(this->paretoLatency.at(i).path, i);
 
-                    pareto << i << " " << paretoLatency.at(i).value << " "
-                           << totUtilization << " " << usedUtilization << "\n";
+                    out << i << " " << paretoLatency.at(i).value << " "
+                        << totUtilization << " " << usedUtilization << "\n";
                 }
             }
-
-            pareto.close();
         }
 
-        void DataflowExplorer::dumpPath(PathInfo_t &path, std::string fname) {
-            std::vector<std::string> names(this->layerNameToID.size(), "");
-            std::map<std::string, uint64_t>::iterator it;
-            for(it = this->layerNameToID.begin(); it != this->layerNameToID.end(); it++) {
-                names[it->second] = it->first;
-            }
-
-            std::ofstream outF;
-            outF.open(fname, std::ios::out);
-            outF << "layerName P Ca L W K Mem Compute ActCommunication WeightCommunication TotalTime MemActIn MemActOut MemWeight\n";
-
+        void DataflowExplorer::dumpPath(PathInfo_t &path, uint64_t area, llvm::raw_ostream &out) {
             uint64_t loc = 0;
             for(ModelParams p : path.path) {
                 if(p.nonZero()) {
-                    this->dumpModelParam(p, outF, names[loc], loc);
+                    out << area << " ";
+                    this->dumpModelParam(p, out, this->layerIdToName[loc], loc);
                     loc++;
                 }
-
             }
-
-            outF.close();
         }
 
-        void DataflowExplorer::dumpPathsFrom(std::vector<PathInfo_t> &paths, std::string prefix) {
+        // All paths of a frontier go in a single table, the area column tells which path a row belongs to
+        void DataflowExplorer::dumpPathsFrom(std::vector<PathInfo_t> &paths, std::string name, llvm::raw_ostream &out) {
+            out << "# " << name << "\n";
+            out << "Area layerName P Ca L W K Mem Compute ActCommunication WeightCommunication TotalTime MemActIn MemActOut MemWeight\n";
+
             for(uint64_t i = 0; i < paths.size(); i++) {
                 if(paths.at(i).path.size() != 0) {
-                    this->dumpPath(paths.at(i), prefix + std::to_string(i) + ".csv");
+                    this->dumpPath(paths.at(i), i, out);
                 }
             }
         }
 
-        std::map<std::string, ModelParams> DataflowExplorer::getMaxThroughput() {
+        // Writes macs, valid topologies, pareto frontiers and their paths to a single file
+        // Each table starts with a "# name" line followed by its column names
+        bool DataflowExplorer::dumpExploration(std::string filename) {
+            StringRef parent = llvm::sys::path::parent_path(filename);
+            if(!parent.empty()) {
+                llvm::sys::fs::create_directories(parent);
+            }
+
+            std::error_code EC;
+            llvm::raw_fd_ostream out(filename, EC);
+            if(EC) {
+                llvm::errs() << "Cannot open " << filename << ": " << EC.message() << "\n";
+                return false;
+            }
+
+            this->dumpMacs(out);
+            this->dumpValidTopologies(out);
+            this->dumpParetoFrontiers(out);
+            this->dumpPathsFrom(this->paretoThroughput, "throughput", out);
+            this->dumpPathsFrom(this->paretoLatency, "latency", out);
+
+            return true;
+        }
+
+        std::vector<ModelParams> DataflowExplorer::getMaxThroughputPath() {
             if(this->paretoThroughput.size() == 0) {
                 llvm::outs() << "Must run the exploration first before extracting the maximum throughput..\n";
-                return std::map<std::string, ModelParams>();
+                return std::vector<ModelParams>();
             }
 
             uint64_t maxValue = 0;
@@ -1114,23 +1512,128 @@ namespace xilinx {
                 }
             }
 
-            llvm::outs() << "Using: \n";
+            std::vector<ModelParams> layerPath;
             for(ModelParams p : bestPath) {
-                p.print();
+                if(p.nonZero()) {
+                    layerPath.push_back(p);
+                }
+            }
+
+            return layerPath;
+        }
+
+        std::map<std::string, ModelParams> DataflowExplorer::getMaxThroughput() {
+            std::vector<ModelParams> bestPath = this->getMaxThroughputPath();
+
+            LLVM_DEBUG(llvm::outs() << "Using: \n");
+            for(ModelParams p : bestPath) {
+                LLVM_DEBUG(p.print());
             }
 
             std::map<std::string, ModelParams> layerNameToParams;
-            uint64_t loc = 0;
             for(uint64_t i = 0; i < bestPath.size(); i++) {
-                if(bestPath.at(i).nonZero()) {
-                    layerNameToParams[this->layerIdToName[loc]] = bestPath.at(i);
-                    loc++;
-                }
+                layerNameToParams[this->layerIdToName[i]] = bestPath.at(i);
             }
 
             return layerNameToParams;
         }
 
+        // Marginal gain report of the max throughput design
+        // For each layer, look in the valid topologies for the fastest one that uses at most k more cores
+        // and that is still compatible with its neighbours in the chosen path
+        std::string DataflowExplorer::emitBottleneckReport(unsigned int maxExtraCores) {
+            llvm::json::Object top;
+            std::vector<ModelParams> path = this->getMaxThroughputPath();
+
+            if(path.size() == 0) {
+                return "{}\n";
+            }
+
+            std::vector<uint64_t> times;
+            uint64_t bottleneck = 0;
+            for(uint64_t i = 0; i < path.size(); i++) {
+                times.push_back(this->getTotalTime(i, path.at(i)));
+                if(times.at(i) > times.at(bottleneck)) {
+                    bottleneck = i;
+                }
+            }
+
+            uint64_t throughput = this->getThroughput(path);
+
+            llvm::json::Array layers;
+            for(uint64_t i = 0; i < path.size(); i++) {
+                ModelParams &params = path.at(i);
+
+                llvm::json::Object layer;
+                layer["name"] = this->layerIdToName[i];
+                layer["id"] = (int64_t)i;
+                layer["P"] = (int64_t)params.P;
+                layer["Ca"] = (int64_t)params.Ca;
+                layer["L"] = (int64_t)params.L;
+                layer["W"] = (int64_t)params.W;
+                layer["lineGranularity"] = params.lineGranularity;
+                layer["cores"] = (int64_t)params.cores();
+                layer["weightVolume"] = (int64_t)this->getWeightStreamVolume(i, params);
+                layer["totalTime"] = (int64_t)times.at(i);
+                layer["slack"] = (int64_t)(times.at(bottleneck) - times.at(i));
+                layer["slackRatio"] = 1.0 - (double)times.at(i) / times.at(bottleneck);
+
+                llvm::json::Array extraCores;
+                for(unsigned int k = 1; k <= maxExtraCores; k++) {
+                    ModelParams best = params;
+                    uint64_t bestTime = times.at(i);
+                    for(ModelParams candidate : this->validTopologies.at(i)) {
+                        if((candidate.cores() <= params.cores()) || (candidate.cores() > (params.cores() + k))) {
+                            continue;
+                        }
+
+                        bool prevFine = (i == 0) || this->canFollow(i, path.at(i-1), candidate);
+                        bool nextFine = (i == (path.size()-1)) || this->canFollow(i+1, candidate, path.at(i+1));
+                        if(!prevFine || !nextFine) {
+                            continue;
+                        }
+
+                        uint64_t candidateTime = this->getTotalTime(i, candidate);
+                        if(candidateTime < bestTime) {
+                            bestTime = candidateTime;
+                            best = candidate;
+                        }
+                    }
+
+                    std::vector<ModelParams> nPath = path;
+                    nPath.at(i) = best;
+                    uint64_t nThroughput = this->getThroughput(nPath);
+
+                    llvm::json::Object gain;
+                    gain["k"] = (int64_t)k;
+                    gain["cores"] = (int64_t)best.cores();
+                    gain["totalTime"] = (int64_t)bestTime;
+                    gain["throughput"] = (int64_t)nThroughput;
+                    gain["gain"] = (double)nThroughput / throughput;
+                    extraCores.push_back(llvm::json::Value(std::move(gain)));
+                }
+
+                layer["extraCores"] = llvm::json::Value(std::move(extraCores));
+                layers.push_back(llvm::json::Value(std::move(layer)));
+            }
+
+            llvm::json::Object bottleneckJSON;
+            bottleneckJSON["name"] = this->layerIdToName[bottleneck];
+            bottleneckJSON["id"] = (int64_t)bottleneck;
+            bottleneckJSON["totalTime"] = (int64_t)times.at(bottleneck);
+
+            top["throughput"] = (int64_t)throughput;
+            top["area"] = (int64_t)this->getArea(path);
+            top["bottleneck"] = llvm::json::Value(std::move(bottleneckJSON));
+            top["layers"] = llvm::json::Value(std::move(layers));
+
+            llvm::json::Value topv(std::move(top));
+            std::string ret;
+            llvm::raw_string_ostream ss(ret);
+            ss << llvm::formatv("{0:2}", topv) << "\n";
+            return ss.str();
+        }
+
         uint64_t pathArea(std::vector<ModelParams> &path) {
             uint64_t area = 0;
             for(ModelParams p : path) {
@@ -1140,23 +1643,17 @@ namespace xilinx {
             return area;
         }
 
-        void DataflowExplorer::dumpMacs() {
-            std::ofstream macs;
-            macs.open("./output/macs.csv", std::ios::out);
-
-            macs << this->layerNameToSize.at(0)["macs"];
-            for(uint64_t i = 1; i < this->layerNameToSize.size(); i++) {
-                macs << ", " << this->layerNameToSize.at(i)["macs"];
+        void DataflowExplorer::dumpMacs(llvm::raw_ostream &out) {
+            out << "# macs\n";
+            out << "layerName Macs\n";
 
+            for(uint64_t i = 0; i < this->layerNameToSize.size(); i++) {
+                out << this->layerIdToName[i] << " " << this->layerNameToSize.at(i)["macs"] << "\n";
             }
-
-            macs << "\n";
-
-            macs.close();
         }
 
         void DataflowExplorer::dfsRecFast(Node_t* node, std::vector<ModelParams> path, uint64_t loc,
-                                          std::ofstream &throughput, std::ofstream &latency) {
+                                          llvm::raw_ostream &throughput, llvm::raw_ostream &latency) {
             if(loc == 0) {
                 uint64_t area = pathArea(path);
                 if(area > this->arch->getNumCores()) {
@@ -1185,7 +1682,7 @@ namespace xilinx {
         }
 
         void DataflowExplorer::dfsRec(Node_t* node, std::vector<ModelParams> path, uint64_t loc,
-                                      std::ofstream &throughput, std::ofstream &latency) {
+                                      llvm::raw_ostream &throughput, llvm::raw_ostream &latency) {
             if(loc == 0) {
                 uint64_t area = pathArea(path);
                 if(area > this->arch->getNumCores()) {
@@ -1214,18 +1711,12 @@ namespace xilinx {
             }
         }
 
-        void DataflowExplorer::dfs(bool full) {
-
-            std::ofstream throughput;
-            throughput.open("./output/throughputs.csv", std::ios::out);
-
-            std::ofstream latency;
-            latency.open("./output/latency.csv", std::ios::out);
-
+        // Area of every path with its throughput and its latency, for debugging the path graph
+        void DataflowExplorer::dfs(bool full, llvm::raw_ostream &throughput, llvm::raw_ostream &latency) {
             throughput << "Area Throughput\n";
             latency << "Area Latency\n";
 
-            llvm::outs() << "PathGraphSize! " << this->pathGraph.size() << "\n";
+            LLVM_DEBUG(llvm::outs() << "PathGraphSize! " << this->pathGraph.size() << "\n");
 
             assert(this->pathGraph.at(this->pathGraph.size()-1).size() == 1);
             Node_t* sink = this->pathGraph.at(this->pathGraph.size()-1).at(0);
@@ -1250,9 +1741,6 @@ namespace xilinx {
                 }
             }
 
-            throughput.close();
-            latency.close();
-
         }
     }
 }
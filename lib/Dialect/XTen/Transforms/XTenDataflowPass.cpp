@@ -10,12 +10,18 @@
 
 #include "PassDetail.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/OperationSupport.h"
 #include "mlir/Pass/Pass.h"
 
 #include "mlir/IR/PatternMatch.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+
 #include "torch-mlir/Dialect/Torch/IR/TorchDialect.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
@@ -29,6 +35,7 @@
 #include <set>
 #include <algorithm>
 #include <string>
+#include <tuple>
 
 #define DEBUG_TYPE "xten-dataflow-pass"
 
@@ -49,75 +56,160 @@ namespace xilinx {
 
         struct XTenDataflowPass : public XTenDataflowBase<XTenDataflowPass> {
         private:
-            // TODO make the second thing here a map from id based on model params to AbsOpWrapper
-            std::map<std::string, std::vector<AbsOpWrapper*>> layerNameToOps;
-            std::map<std::string, ModelParams> layerNameToParams;
-            std::vector<std::string> layerOrdering; // TODO remove this field
+            typedef uint64_t TileKey;
+
+            // Layers in topological order, indexed by the same ids as in the explorer
+            // TODO make the ops of a layer a map from id based on model params to AbsOpWrapper
+            std::vector<std::vector<AbsOpWrapper*>> layerIdToOps;
+            std::vector<ModelParams> layerIdToParams;
+            std::vector<std::string> layerIdToName;
+
+            // Layer whose tiles the W rewiring reads, none for layers reading the graph inputs or several layers
+            std::vector<llvm::Optional<uint64_t>> layerIdToPrev;
 
         public:
+            Option<bool> expandW{*this, "expand-w",
+                                 llvm::cl::desc("Duplicate the layers W times along the lines and forward the halo lines between replicas"),
+                                 llvm::cl::init(true)};
+
             XTenDataflowPass() {}
+            XTenDataflowPass(const XTenDataflowPass &pass) {}
+
+            // Lines of a tile as seen by the W rewiring, a tile holds at least one line
+            uint64_t getLinesPerTile(uint64_t layerId, DataflowExplorer &expl) {
+                uint64_t linesPerTile = expl.getLinesPerTile(layerId, this->layerIdToParams[layerId]);
+                return std::max((uint64_t)1, linesPerTile);
+            }
+
+            // Key of the lines of tile produced for channel group by layer, packed so that the
+            // rewiring maps are DenseMaps: 16 bits of layer, 24 bits of tile and 24 bits of channel
+            TileKey tileKey(uint64_t layer, uint64_t tile, uint64_t channel) {
+                assert(layer < (1 << 16) && tile < (1 << 24) && channel < (1 << 24));
+                return (layer << 48) | (tile << 24) | channel;
+            }
+
+            // Key of a core of a W replica from its P, Ca and L location
+            TileKey coreKey(uint64_t locP, uint64_t locCa, uint64_t locL) {
+                assert(locP < (1 << 16) && locCa < (1 << 24) && locL < (1 << 24));
+                return (locP << 48) | (locCa << 24) | locL;
+            }
+
+            // MM, linear and elementwise ops have no partial variant: their cores compute disjoint parts of the
+            // output, so they are expanded by splitting operands and concatenating results
+            bool isParallelLayer(uint64_t layerId) {
+                Operation* op = this->layerIdToOps[layerId].at(0)->getUnderlyingOperation();
+                return llvm::isa<MMOp>(op) || llvm::isa<LinearReLUOp>(op) || llvm::isa<AddOp>(op) || llvm::isa<MulOp>(op);
+            }
+
+            // Dimension of the lines, the rows for matrices
+            unsigned int lineDim(uint64_t layerId) {
+                Operation* op = this->layerIdToOps[layerId].at(0)->getUnderlyingOperation();
+                auto type = op->getResult(0).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                return (type.getSizes().size() == 2) ? 0 : N_LOC;
+            }
+
+            // Every core must get at least one element of each split dimension, the expansion has no empty ops
+            LogicalResult checkSplitSizes(uint64_t layerId) {
+                AbsOpWrapper* layer = this->layerIdToOps[layerId].at(0);
+                Operation* op = layer->getUnderlyingOperation();
+                ModelParams &params = this->layerIdToParams[layerId];
+
+                auto sizesOf = [](Value v) {
+                    return v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes();
+                };
 
-            AbsOpWrapper* opToWrapper(Operation* op) {
-                if(auto conv = llvm::dyn_cast<Conv2dReLUOp>(op)) {
-                    return new Conv2dReLUOpWrapper(conv);
-                } else if(auto conv = llvm::dyn_cast<PartialConv2dReLUOp>(op)) {
-                    return new PartialConv2dReLUOpWrapper(conv);
-                } else if(auto maxpool = llvm::dyn_cast<torch::Torch::AtenMaxPool2dOp>(op)) {
-                    return new MaxPool2dOpWrapper(maxpool);
-                } else if(auto conv = llvm::dyn_cast<Conv2dOp>(op)) {
-                    return new Conv2dOpWrapper(conv);
-                } else if(auto conv = llvm::dyn_cast<PartialConv2dOp>(op)) {
-                    return new PartialConv2dOpWrapper(conv);
-                } else if(auto conv = llvm::dyn_cast<Conv2dBatchNormReLUOp>(op)) {
-                    return new Conv2dBatchNormReLUOpWrapper(conv);
-                } else if(auto conv = llvm::dyn_cast<PartialConv2dBatchNormReLUOp>(op)) {
-                    return new PartialConv2dBatchNormReLUOpWrapper(conv);
+                ArrayRef<int64_t> res = sizesOf(op->getResult(0));
+                ArrayRef<int64_t> in = sizesOf(layer->getInput());
+
+                std::vector<std::tuple<std::string, unsigned int, int64_t, std::string>> splits;
+                if(expandW) {
+                    splits.push_back(std::make_tuple("W", params.W, in[lineDim(layerId)], "input lines"));
+                }
+
+                if(this->isParallelLayer(layerId)) {
+                    splits.push_back(std::make_tuple("P", params.P, res[C_LOC], "output channels"));
+                } else if(layer->hasWeights()) {
+                    ArrayRef<int64_t> w = sizesOf(layer->getWeights());
+                    splits.push_back(std::make_tuple("P", params.P, w[COUT_LOC], "output channels"));
+                    splits.push_back(std::make_tuple("Ca", params.Ca, w[CIN_LOC], "input channels"));
+                    splits.push_back(std::make_tuple("L", params.L, w[F0_LOC], "kernel lines"));
                 } else {
-                    llvm::outs() << "Unsupported operation was used!\n";
-                    exit(1);
+                    splits.push_back(std::make_tuple("P", params.P, res[C_LOC], "output channels"));
+                    splits.push_back(std::make_tuple("Ca", params.Ca, in[C_LOC], "input channels"));
+                }
+
+                for(auto &split : splits) {
+                    if((int64_t)std::get<1>(split) > std::get<2>(split)) {
+                        op->emitError(std::get<0>(split) + " = " + std::to_string(std::get<1>(split)) + " is larger than the " +
+                                      std::to_string(std::get<2>(split)) + " " + std::get<3>(split) + " of the layer");
+                        return failure();
+                    }
                 }
+
+                return success();
             }
 
-            DataflowExplorer initializeLayerNameToOps(func::FuncOp graph) {
-                // TODO do we have the guarantee to be in network order?
+            DataflowExplorer initializeLayers(func::FuncOp graph) {
+                std::vector<std::vector<uint64_t>> producers;
+                std::vector<Operation*> layers = getLayersInTopologicalOrder(graph, producers);
+
                 std::vector<std::pair<std::string, AbsOpWrapper*>> explorerInit;
+                std::set<std::string> layerNames;
+                for(uint64_t id = 0; id < layers.size(); id++) {
+                    Operation* op = layers.at(id);
+                    std::string opName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+                    if(!layerNames.insert(opName).second) {
+                        llvm::outs() << "Cannot have multiple layer with the same name during initizalization\n";
+                        exit(1);
+                    }
 
-                graph.walk([&](Operation *op) {
-                        if(op->getAttr("layer_name") != nullptr) {
-                            auto opName = (op->getAttr("layer_name").dyn_cast<StringAttr>()).getValue();
-                            AbsOpWrapper* wrappedOp = opToWrapper(op);
-                            if(layerNameToOps.count(opName.str()) == 0) {
-                                layerNameToOps[opName.str()] = std::vector<AbsOpWrapper*>({wrappedOp});
-                                explorerInit.push_back(std::make_pair(opName.str(), wrappedOp));
-                                this->layerNameToParams[opName.str()] = ModelParams(0,0,0,0,false);
-                                this->layerOrdering.push_back(opName.str());
-                            } else {
-                                llvm::outs() << "Cannot have multiple layer with the same name during initizalization\n";
-                                exit(1);
-                            }
-                        }
-                    });
+                    AbsOpWrapper* wrappedOp = opToWrapper(op);
+                    this->layerIdToOps.push_back(std::vector<AbsOpWrapper*>({wrappedOp}));
+                    this->layerIdToName.push_back(opName);
+                    explorerInit.push_back(std::make_pair(opName, wrappedOp));
 
+                    ModelParams params;
+                    if(!getDataflowAttr(op, params)) {
+                        op->emitError("Missing or invalid " DATAFLOW_ATTR " attribute, run xten-annotate-dataflow first");
+                        params = ModelParams(0,0,0,0,false);
+                    }
+                    this->layerIdToParams.push_back(params);
+
+                    if(producers.at(id).size() == 1) {
+                        this->layerIdToPrev.push_back(producers.at(id).at(0));
+                    } else {
+                        this->layerIdToPrev.push_back(llvm::None);
+                    }
+                }
+
+                // The explorer is only used for its model of each layer, the decisions come from the attributes
+                // It gets the layers in the same order so that both share the layer ids
                 return DataflowExplorer(explorerInit);
             }
 
-            void clearLayerNameToOps() {
-                std::map<std::string, std::vector<AbsOpWrapper*>>::iterator it;
-                for(it = layerNameToOps.begin(); it != layerNameToOps.end(); it++) {
-                    while(!it->second.empty()) {
-                        delete it->second.back();
-                        it->second.pop_back();
+            void clearLayers() {
+                for(std::vector<AbsOpWrapper*> &ops : this->layerIdToOps) {
+                    while(!ops.empty()) {
+                        delete ops.back();
+                        ops.pop_back();
                     }
                 }
+
+                this->layerIdToOps.clear();
+                this->layerIdToParams.clear();
+                this->layerIdToName.clear();
+                this->layerIdToPrev.clear();
             }
 
             // TODO how to make that generic with respect to Conv Ops? As much as possible?
-            LogicalResult PTransform(std::string layerName, unsigned int into) {
+            LogicalResult PTransform(uint64_t layerId, unsigned int into) {
+                PhaseTimer timer(this->getAnalysisManager(), this->getOperation(), "PTransform");
+
                 if(into == 1) {
                     return success();
                 }
 
-                std::vector<AbsOpWrapper*> layerOps = layerNameToOps[layerName];
+                std::vector<AbsOpWrapper*> layerOps = layerIdToOps[layerId];
                 std::vector<Operation*> toDelete;
                 std::vector<AbsOpWrapper*> nLayerOps;
 
@@ -131,16 +223,17 @@ namespace xilinx {
                     std::vector<Value> nBiases;
                     std::vector<Value> nConvs;
                     std::vector<Value> nInputs;
+                    std::vector<Value> nResiduals;
                     std::vector<ArrayRef<Value>> nBN;
 
                     // Split weights
                     Operation* weights;
                     if(genOp->hasWeights()) {
                         weights = genOp->getWeights().getDefiningOp();
-                        if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(weights)) {
-                            splitConstantInto(constOp, nConsts, builder, PSplit, wSplitType, into);
+                        if(isConstantOrSlice(genOp->getWeights())) {
+                            sliceConstantInto(genOp->getWeights(), nConsts, builder, PSplit, wSplitType, into);
                         } else {
-                            llvm::outs() << "Cannot convert to ConstOp!\n";
+                            llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                             return failure();
                         }
                     }
@@ -149,10 +242,10 @@ namespace xilinx {
                     Operation* biases;
                     if(genOp->hasBias()) {
                         biases = genOp->getBiases()->getDefiningOp();
-                        if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(biases)) {
-                            splitConstantInto(constOp, nBiases, builder, PSplit, bSplitType, into);
+                        if(isConstantOrSlice(*genOp->getBiases())) {
+                            sliceConstantInto(*genOp->getBiases(), nBiases, builder, PSplit, bSplitType, into);
                         } else {
-                            llvm::outs() << "Cannot convert to ConstOp!\n";
+                            llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                             return failure();
                         }
                     }
@@ -161,12 +254,11 @@ namespace xilinx {
                         ArrayRef<Value> bnParams = genOp->getBN();
                         std::vector<std::vector<Value>> nBnVect;
                         for(unsigned int i = 0; i < 4; i++) {
-                            Operation* bnParam = bnParams[i].getDefiningOp();
                             std::vector<Value> nBnLoc;
-                            if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(bnParam)) {
-                                splitConstantInto(constOp, nBnLoc, builder, PSplit, bSplitType, into);
+                            if(isConstantOrSlice(bnParams[i])) {
+                                sliceConstantInto(bnParams[i], nBnLoc, builder, PSplit, bSplitType, into);
                             } else {
-                                llvm::outs() << "Cannot convert to ConstOp!\n";
+                                llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                                 return failure();
                             }
 
@@ -185,14 +277,16 @@ namespace xilinx {
                     }
 
 
-                    // Split Return Type shape
+                    // Split Return Type shape, parts might be uneven and follow the weights split
                     // TODO for Maxpool2d with indices, check other return types and check that assumption
-                    std::vector<Type> shapes = std::vector<Type>();
+                    std::vector<std::vector<Type>> shapes = std::vector<std::vector<Type>>(into, std::vector<Type>());
                     for(unsigned int i = 0; i < op->getNumResults(); i++) {
                         mlir::torch::Torch::BaseTensorType origType = op->getResult(i).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
                         assert(origType);
-                        mlir::torch::Torch::BaseTensorType nReturnType = breakShapeInto(origType, C_LOC, into);
-                        shapes.push_back(nReturnType);
+                        std::vector<int64_t> sizes = getSplitSizes(origType.getSizes()[C_LOC], into, CHANNEL_BLOCK);
+                        for(unsigned int j = 0; j < into; j++) {
+                            shapes.at(j).push_back(resizeShapeAt(origType, C_LOC, sizes.at(j)));
+                        }
                     }
 
                     if(genOp->isDepthWise()) {
@@ -203,11 +297,22 @@ namespace xilinx {
                         }
                     }
 
-                    ArrayRef<Type> nReturnType = ArrayRef<Type>(shapes);
+                    // The residual has the shape of the output and is split alike
+                    if(Value residual = genOp->getResidual()) {
+                        mlir::torch::Torch::BaseTensorType resType = residual.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                        std::vector<int64_t> sizes = getSplitSizes(resType.getSizes()[C_LOC], into, CHANNEL_BLOCK);
+                        if(isConstantOrSlice(residual)) {
+                            sliceConstantAlong(residual, nResiduals, builder, C_LOC, sizes);
+                        } else {
+                            insertSplit(builder, residual, nResiduals, C_LOC, sizes);
+                        }
+                    }
 
                     // Generate new convs
+                    int64_t channelOffset = 0;
                     for(unsigned int i = 0; i < into; i++) {
                         Operation* conv;
+                        ArrayRef<Type> nReturnType = ArrayRef<Type>(shapes.at(i));
 
                         Value input;
                         if(genOp->isDepthWise()) {
@@ -219,15 +324,20 @@ namespace xilinx {
                         auto nW = genOp->hasWeights() ? llvm::Optional<Value>(nConsts.at(i)) : llvm::Optional<Value>();
                         auto nB = genOp->hasBias() ? llvm::Optional<Value>(nBiases.at(i)) : llvm::Optional<Value>();
                         auto nBn = genOp->hasBN() ? llvm::Optional<ArrayRef<Value>>(nBN.at(i)) : llvm::Optional<ArrayRef<Value>>();
+                        auto nR = genOp->getResidual() ? llvm::Optional<Value>(nResiduals.at(i)) : llvm::Optional<Value>();
                         conv = genOp->buildOp(builder,
                                               TypeRange({nReturnType}),
                                               input,
                                               nW,
                                               nB,
-                                              llvm::Optional<Value>(), false, nBn);
+                                              llvm::Optional<Value>(), false, nBn, nR);
 
                         assert(conv != nullptr);
 
+                        int64_t channels = shapes.at(i).at(0).dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[C_LOC];
+                        sliceQuantAttr(conv, channelOffset, channels);
+                        channelOffset += channels;
+
                         // set location attribute
                         if(op->getAttr("locP") != nullptr) {
                             auto locP = (op->getAttr("locP").dyn_cast<IntegerAttr>()).getValue();
@@ -269,7 +379,7 @@ namespace xilinx {
                     }
                 }
 
-                layerNameToOps[layerName] = nLayerOps;
+                layerIdToOps[layerId] = nLayerOps;
 
                 // cleanup
                 deleteOpsFrom(layerOps);
@@ -278,12 +388,14 @@ namespace xilinx {
                 return success();
             }
 
-            LogicalResult CaTransform(std::string layerName, unsigned int into) {
+            LogicalResult CaTransform(uint64_t layerId, unsigned int into) {
+                PhaseTimer timer(this->getAnalysisManager(), this->getOperation(), "CaTransform");
+
                 if(into == 1) {
                     return success();
                 }
 
-                std::vector<AbsOpWrapper*> layerOps = layerNameToOps[layerName];
+                std::vector<AbsOpWrapper*> layerOps = layerIdToOps[layerId];
                 std::vector<Operation*> toDelete;
                 std::vector<AbsOpWrapper*> nLayerOps;
 
@@ -300,10 +412,10 @@ namespace xilinx {
                     Operation* weights;
                     if(genOp->hasWeights()) {
                          weights = genOp->getWeights().getDefiningOp();
-                        if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(weights)) {
-                            splitConstantInto(constOp, nConsts, builder, CaSplit, wSplitType, into);
+                        if(isConstantOrSlice(genOp->getWeights())) {
+                            sliceConstantInto(genOp->getWeights(), nConsts, builder, CaSplit, wSplitType, into);
                         } else {
-                            llvm::outs() << "Cannot convert to ConstOp!\n";
+                            llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                             return failure();
                         }
                     }
@@ -313,10 +425,10 @@ namespace xilinx {
                     Operation* biases;
                     if(genOp->hasBias()) {
                         biases = genOp->getBiases()->getDefiningOp();
-                        if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(biases)) {
-                            splitConstantInto(constOp, nBiases, builder, CaSplit, bSplitType, into);
+                        if(isConstantOrSlice(*genOp->getBiases())) {
+                            sliceConstantInto(*genOp->getBiases(), nBiases, builder, CaSplit, bSplitType, into);
                         } else {
-                            llvm::outs() << "Cannot convert to ConstOp!\n";
+                            llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                             return failure();
                         }
                     }
@@ -327,12 +439,11 @@ namespace xilinx {
                         ArrayRef<Value> bnParams = genOp->getBN();
                         std::vector<std::vector<Value>> nBnVect;
                         for(unsigned int i = 0; i < 4; i++) {
-                            Operation* bnParam = bnParams[i].getDefiningOp();
                             std::vector<Value> nBnLoc;
-                            if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(bnParam)) {
-                                splitConstantInto(constOp, nBnLoc, builder, CaSplit, bSplitType, into);
+                            if(isConstantOrSlice(bnParams[i])) {
+                                sliceConstantInto(bnParams[i], nBnLoc, builder, CaSplit, bSplitType, into);
                             } else {
-                                llvm::outs() << "Cannot convert to ConstOp!\n";
+                                llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                                 return failure();
                             }
 
@@ -351,8 +462,8 @@ namespace xilinx {
                     }
 
                     // split activations
-                    if(auto constOp = genOp->getInput().getDefiningOp<mlir::arith::ConstantOp>()) {
-                        splitConstantInto(constOp, nInputs, builder, CaSplit, aSplitType, into);
+                    if(isConstantOrSlice(genOp->getInput())) {
+                        sliceConstantInto(genOp->getInput(), nInputs, builder, CaSplit, aSplitType, into);
                     } else {
                         if(ConcatOp concatOp = genOp->getInput().getDefiningOp<ConcatOp>()) {
                             unsigned int locP = getAttrOrDefault(genOp->getUnderlyingOperation(), "locP", 0);
@@ -367,9 +478,13 @@ namespace xilinx {
                     auto w = genOp->hasWeights() ? llvm::Optional<Value>(nConsts.at(0)) : llvm::Optional<Value>();
                     auto bias = genOp->hasBias() ? llvm::Optional<Value>(nBiases.at(0)) : llvm::Optional<Value>();
                     auto bn = genOp->hasBN() ? llvm::Optional<ArrayRef<Value>>(nBN.at(0)) : llvm::Optional<ArrayRef<Value>>();
+                    // Partial sums travel along the chain at the width of the accumulators
+                    Type resType = op->getResult(0).getType();
+                    Type partialType = getPartialResultType(op, resType);
+
                     auto chainIn = llvm::Optional<Value>(genOp->getPartialInput());
-                    Operation* conv = genOp->buildOp(builder, TypeRange({op->getResult(0).getType()}),
-                                                     nInputs.at(0), w, bias, chainIn, true, bn);
+                    Operation* conv = genOp->buildOp(builder, TypeRange({partialType}),
+                                                     nInputs.at(0), w, bias, chainIn, true, bn, llvm::Optional<Value>());
 
                     // set location attribute
                     if(op->getAttr("locCa") != nullptr) {
@@ -389,8 +504,10 @@ namespace xilinx {
                         auto w = genOp->hasWeights() ? llvm::Optional<Value>(nConsts.at(i)) : llvm::Optional<Value>();
                         auto bias = genOp->hasBias() ? llvm::Optional<Value>(nBiases.at(i)) : llvm::Optional<Value>();
                         auto bn = genOp->hasBN() ? llvm::Optional<ArrayRef<Value>>(nBN.at(i)) : llvm::Optional<ArrayRef<Value>>();
-                        Operation* nConv = genOp->buildOp(builder, TypeRange({op->getResult(0).getType()}),
-                                                          nInputs.at(i), w, bias, llvm::Optional<Value>(conv->getResult(0)), true, bn);
+                        // Only the last op of the chain adds the residual to the complete sum
+                        auto r = (genOp->getResidual() && (i == (into-1))) ? llvm::Optional<Value>(genOp->getResidual()) : llvm::Optional<Value>();
+                        Operation* nConv = genOp->buildOp(builder, TypeRange({(i == (into-1)) ? resType : partialType}),
+                                                          nInputs.at(i), w, bias, llvm::Optional<Value>(conv->getResult(0)), true, bn, r);
 
                         // set location attribute
                         if(op->getAttr("locCa") != nullptr) {
@@ -428,7 +545,7 @@ namespace xilinx {
                     }
                 }
 
-                layerNameToOps[layerName] = nLayerOps;
+                layerIdToOps[layerId] = nLayerOps;
 
                 // cleanup
                 deleteOpsFrom(layerOps);
@@ -437,15 +554,17 @@ namespace xilinx {
                 return success();
             }
 
-            LogicalResult LTransform(std::string layerName, unsigned int into) {
+            LogicalResult LTransform(uint64_t layerId, unsigned int into) {
+                PhaseTimer timer(this->getAnalysisManager(), this->getOperation(), "LTransform");
+
                 if(into == 1) {
                     return success();
                 }
-                std::vector<AbsOpWrapper*> layerOps = layerNameToOps[layerName];
+                std::vector<AbsOpWrapper*> layerOps = layerIdToOps[layerId];
                 std::vector<Operation*> toDelete;
                 std::vector<AbsOpWrapper*> nLayerOps;
 
-                llvm::outs() << "LayerOps size: " << layerOps.size();
+                LLVM_DEBUG(llvm::outs() << "LayerOps size: " << layerOps.size());
 
                 for(AbsOpWrapper* genOp : layerOps) {
                     Operation* op = genOp->getUnderlyingOperation();
@@ -460,10 +579,10 @@ namespace xilinx {
                     Operation* weights;
                     if(genOp->hasWeights()) {
                         weights = genOp->getWeights().getDefiningOp();//->getName();
-                        if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(weights)) {
-                            splitConstantInto(constOp, nConsts, builder, LSplit, wSplitType, into);
+                        if(isConstantOrSlice(genOp->getWeights())) {
+                            sliceConstantInto(genOp->getWeights(), nConsts, builder, LSplit, wSplitType, into);
                         } else {
-                            llvm::outs() << "Cannot convert to ConstOp!\n";
+                            llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                             return failure();
                         }
                     }
@@ -473,10 +592,10 @@ namespace xilinx {
                     Operation* biases;
                     if(genOp->hasBias()) {
                         biases = genOp->getBiases()->getDefiningOp();
-                        if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(biases)) {
-                            splitConstantInto(constOp, nBiases, builder, LSplit, bSplitType, into);
+                        if(isConstantOrSlice(*genOp->getBiases())) {
+                            sliceConstantInto(*genOp->getBiases(), nBiases, builder, LSplit, bSplitType, into);
                         } else {
-                            llvm::outs() << "Cannot convert to ConstOp!\n";
+                            llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                             return failure();
                         }
                     }
@@ -486,12 +605,11 @@ namespace xilinx {
                         ArrayRef<Value> bnParams = genOp->getBN();
                         std::vector<std::vector<Value>> nBnVect;
                         for(unsigned int i = 0; i < 4; i++) {
-                            Operation* bnParam = bnParams[i].getDefiningOp();
                             std::vector<Value> nBnLoc;
-                            if(auto constOp = llvm::dyn_cast<mlir::arith::ConstantOp>(bnParam)) {
-                                splitConstantInto(constOp, nBnLoc, builder, LSplit, bSplitType, into);
+                            if(isConstantOrSlice(bnParams[i])) {
+                                sliceConstantInto(bnParams[i], nBnLoc, builder, LSplit, bSplitType, into);
                             } else {
-                                llvm::outs() << "Cannot convert to ConstOp!\n";
+                                llvm::outs() << "Cannot convert to ConstOp or slice of a ConstOp!\n";
                                 return failure();
                             }
 
@@ -512,14 +630,15 @@ namespace xilinx {
                     // Same return type here
                     mlir::torch::Torch::BaseTensorType retTypePartial = op->getResult(0).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
                     mlir::torch::Torch::BaseTensorType retTypeForward = genOp->getInput().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                    Type retTypeAcc = getPartialResultType(op, retTypePartial);
 
                     // Generate new convs
                     auto w = genOp->hasWeights() ? llvm::Optional<Value>(nConsts.at(0)) : llvm::Optional<Value>();
                     auto bias = genOp->hasBias() ? llvm::Optional<Value>(nBiases.at(0)) : llvm::Optional<Value>();
                     auto bn = genOp->hasBN() ? llvm::Optional<ArrayRef<Value>>(nBN.at(0)) : llvm::Optional<ArrayRef<Value>>();
                     auto chainIn = llvm::Optional<Value>(genOp->getPartialInput());
-                    Operation* nConv = genOp->buildOp(builder, TypeRange({retTypePartial, retTypeForward}),
-                                                      genOp->getInput(), w, bias, chainIn, true, bn);
+                    Operation* nConv = genOp->buildOp(builder, TypeRange({retTypeAcc, retTypeForward}),
+                                                      genOp->getInput(), w, bias, chainIn, true, bn, llvm::Optional<Value>());
 
                     // set location attribute
                     if(op->getAttr("locL") != nullptr) {
@@ -541,10 +660,11 @@ namespace xilinx {
                         auto w = genOp->hasWeights() ? llvm::Optional<Value>(nConsts.at(i)) : llvm::Optional<Value>();
                         auto bias = genOp->hasBias() ? llvm::Optional<Value>(nBiases.at(i)) : llvm::Optional<Value>();
                         auto bn = genOp->hasBN() ? llvm::Optional<ArrayRef<Value>>(nBN.at(i)) : llvm::Optional<ArrayRef<Value>>();
+                        auto r = (genOp->getResidual() && (i == (into-1))) ? llvm::Optional<Value>(genOp->getResidual()) : llvm::Optional<Value>();
                         // Same return type here
                         nConv = genOp->buildOp(builder,
-                                               (i == (into-1)) ? TypeRange({retTypePartial}) : TypeRange({retTypePartial, retTypeForward}),
-                                               forward, w, bias, llvm::Optional<Value>(partial), false, bn);
+                                               (i == (into-1)) ? TypeRange({retTypePartial}) : TypeRange({retTypeAcc, retTypeForward}),
+                                               forward, w, bias, llvm::Optional<Value>(partial), false, bn, r);
 
                         // set location attribute
                         if(op->getAttr("locL") != nullptr) {
@@ -586,7 +706,7 @@ namespace xilinx {
                 }
 
                 // Delete previous Csts and ConvolutionOp
-                layerNameToOps[layerName] = nLayerOps;
+                layerIdToOps[layerId] = nLayerOps;
 
                 // cleanup
                 deleteOpsFrom(layerOps);
@@ -595,10 +715,108 @@ namespace xilinx {
                 return success();
             }
 
+            // Partitions the output of a parallel layer along dim, each part is computed by a clone of the op
+            // MM splits y for the columns and x for the rows and reads the other operand whole,
+            // linear splits the rows of its weights and bias for the columns and x for the rows,
+            // elementwise ops split every operand that spans dim and read broadcast ones whole
+            LogicalResult parallelTransform(uint64_t layerId, unsigned int dim, std::string locAttr, unsigned int into) {
+                PhaseTimer timer(this->getAnalysisManager(), this->getOperation(), "parallelTransform");
+
+                if(into == 1) {
+                    return success();
+                }
+
+                std::vector<AbsOpWrapper*> layerOps = layerIdToOps[layerId];
+                std::vector<AbsOpWrapper*> nLayerOps;
+
+                for(AbsOpWrapper* genOp : layerOps) {
+                    Operation* op = genOp->getUnderlyingOperation();
+                    OpBuilder builder(op);
+
+                    mlir::torch::Torch::BaseTensorType resType = op->getResult(0).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                    std::vector<int64_t> sizes = getSplitSizes(resType.getSizes()[dim], into, (dim == C_LOC) ? CHANNEL_BLOCK : LINE_BLOCK);
+
+                    // Parts of each operand, empty when the operand is read whole
+                    std::vector<std::vector<Value>> nOperands(op->getNumOperands());
+                    for(unsigned int i = 0; i < op->getNumOperands(); i++) {
+                        Value operand = op->getOperand(i);
+                        mlir::torch::Torch::BaseTensorType type = operand.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+
+                        bool split;
+                        unsigned int operandDim = dim;
+                        if(llvm::isa<MMOp>(op)) {
+                            split = (dim == 0) ? (i == 0) : (i == 1);
+                        } else if(llvm::isa<LinearReLUOp>(op)) {
+                            split = (dim == 0) ? (i == 0) : ((i != 0) && type);
+                            operandDim = 0;
+                        } else {
+                            split = type && type.hasSizes() && (type.getSizes().size() == resType.getSizes().size()) &&
+                                (type.getSizes()[dim] == resType.getSizes()[dim]);
+                        }
+
+                        if(!split) {
+                            continue;
+                        }
+
+                        // x * x splits x once
+                        for(unsigned int k = 0; k < i; k++) {
+                            if((op->getOperand(k) == operand) && !nOperands.at(k).empty()) {
+                                nOperands.at(i) = nOperands.at(k);
+                                break;
+                            }
+                        }
+
+                        if(!nOperands.at(i).empty()) {
+                            continue;
+                        } else if(isConstantOrSlice(operand)) {
+                            sliceConstantAlong(operand, nOperands.at(i), builder, operandDim, sizes);
+                        } else {
+                            insertSplit(builder, operand, nOperands.at(i), operandDim, sizes);
+                        }
+                    }
+
+                    unsigned int loc = getAttrOrDefault(op, locAttr, 0);
+
+                    std::vector<Value> nParts;
+                    int64_t offset = 0;
+                    for(unsigned int j = 0; j < into; j++) {
+                        BlockAndValueMapping mapping;
+                        for(unsigned int i = 0; i < op->getNumOperands(); i++) {
+                            if(!nOperands.at(i).empty()) {
+                                mapping.map(op->getOperand(i), nOperands.at(i).at(j));
+                            }
+                        }
+
+                        Operation* nOp = builder.clone(*op, mapping);
+                        nOp->getResult(0).setType(resizeShapeAt(resType, dim, sizes.at(j)));
+
+                        if(dim == C_LOC) {
+                            sliceQuantAttr(nOp, offset, sizes.at(j));
+                        }
+                        offset += sizes.at(j);
+
+                        auto ty = IntegerType::get(builder.getContext(), 32);
+                        nOp->setAttr(llvm::StringRef(locAttr), IntegerAttr::get(ty, loc + j));
+
+                        nParts.push_back(nOp->getResult(0));
+                        nLayerOps.push_back(opToWrapper(nOp));
+                    }
+
+                    insertConcat(builder, op->getResult(0), nParts, dim, true);
+                }
+
+                layerIdToOps[layerId] = nLayerOps;
+
+                // cleanup
+                deleteOpsFrom(layerOps);
+
+                return success();
+            }
+
             // TODO take into account depthwise layers
             // TODO work at the tile grannularity
             // TODO Support correct line stuff
-            std::vector<std::string> workOn(AbsOpWrapper* absOp, DataflowExplorer &expl) {
+            std::vector<TileKey> workOn(AbsOpWrapper* absOp, uint64_t layerId, DataflowExplorer &expl) {
                 Operation* op = absOp->getUnderlyingOperation();
 
                 unsigned int locCa = getAttrOrDefault(op, "locCa", 0);
@@ -606,31 +824,29 @@ namespace xilinx {
                 unsigned int locW = getAttrOrDefault(op, "locW", 0);
                 //unsigned int locP = getAttrOrDefault(op, "locP", 0);
 
-                std::string layerName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
-
                 uint64_t F0 = absOp->getF0();
                 // TODO fix for F1
 
-                uint64_t linesPerTile = expl.getLinesPerTile(expl.layerNameToID[layerName], this->layerNameToParams[layerName]);
+                uint64_t linesPerTile = this->getLinesPerTile(layerId, expl);
 
                 uint64_t startLine = locL + locW * linesPerTile;
                 uint64_t endLine = startLine + linesPerTile - 1 + F0 - 1;
 
-                std::vector<std::string> locLines;
+                std::vector<TileKey> locLines;
                 uint64_t startTile = startLine / linesPerTile;
                 uint64_t endTile = endLine / linesPerTile;
 
-                llvm::outs() << "StartLine " << startLine << ", startTile: " << startTile << "\n";
-                llvm::outs() << "EndLIne: " << endLine << ", endTile: " << endLine / linesPerTile << "\n";
+                LLVM_DEBUG(llvm::outs() << "StartLine " << startLine << ", startTile: " << startTile << "\n");
+                LLVM_DEBUG(llvm::outs() << "EndLIne: " << endLine << ", endTile: " << endLine / linesPerTile << "\n");
 
                 for(uint64_t i = startTile; i <= endTile; i++) {
-                    locLines.push_back("tile" + std::to_string(i) + "C" + std::to_string(locCa));
+                    locLines.push_back(tileKey(layerId, i, locCa));
                 }
 
                 return locLines;
             }
 
-            std::vector<std::string> wantLoc(AbsOpWrapper* absOp, DataflowExplorer &expl) {
+            std::vector<TileKey> wantLoc(AbsOpWrapper* absOp, uint64_t layerId, DataflowExplorer &expl) {
                 Operation* op = absOp->getUnderlyingOperation();
 
                 unsigned int locCa = getAttrOrDefault(op, "locCa", 0);
@@ -638,16 +854,14 @@ namespace xilinx {
                 unsigned int locW = getAttrOrDefault(op, "locW", 0);
                 //unsigned int locP = getAttrOrDefault(op, "locP", 0);
 
-                std::string layerName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
-
                 uint64_t F0 = absOp->getF0();
                 // TODO fix for F1
 
-                uint64_t linesPerTile = expl.getLinesPerTile(expl.layerNameToID[layerName], this->layerNameToParams[layerName]);
+                uint64_t linesPerTile = this->getLinesPerTile(layerId, expl);
 
                 //llvm::outs() << "LinesPertile:  " << linesPerTile << "\n";
 
-                unsigned int W = this->layerNameToParams[layerName].W;
+                unsigned int W = this->layerIdToParams[layerId].W;
 
                 uint64_t startLine = locL + locW * linesPerTile;
                 uint64_t endLine = startLine + linesPerTile - 1 + F0 - 1;
@@ -660,39 +874,34 @@ namespace xilinx {
                 uint64_t nEndLineTile = nEndLine / linesPerTile;
 
                 //llvm::outs() << "startLine = " << startLine << ", endLine: " << endLine << "\n";
-                llvm::outs() << "start = " << startLine / linesPerTile << ", end: " << endLine / linesPerTile << "\n";
-                llvm::outs() << "nStart = " << nStartLineTile << ", nEnd: " << nEndLineTile << "\n";
+                LLVM_DEBUG(llvm::outs() << "start = " << startLine / linesPerTile << ", end: " << endLine / linesPerTile << "\n");
+                LLVM_DEBUG(llvm::outs() << "nStart = " << nStartLineTile << ", nEnd: " << nEndLineTile << "\n");
 
-                std::vector<std::string> wantLines;
+                std::vector<TileKey> wantLines;
                 for(uint64_t i = std::max(endLineTile+1, nStartLineTile); i <= nEndLineTile; i++) {
-                    wantLines.push_back("tile" + std::to_string(i) + "C" + std::to_string(locCa));
+                    wantLines.push_back(tileKey(layerId, i, locCa));
                 }
 
                 return wantLines;
             }
 
-            std::vector<std::string> wantPrev(AbsOpWrapper* absOp, DataflowExplorer &expl) {
+            std::vector<TileKey> wantPrev(AbsOpWrapper* absOp, uint64_t layerId, DataflowExplorer &expl) {
                 Operation* op = absOp->getUnderlyingOperation();
                 unsigned int locCa = getAttrOrDefault(op, "locCa", 0);
                 unsigned int locL = getAttrOrDefault(op, "locL", 0);
                 unsigned int locW = getAttrOrDefault(op, "locW", 0);
                 //unsigned int locP = getAttrOrDefault(op, "locP", 0);
 
-                std::string layerName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
-                unsigned int W = this->layerNameToParams[layerName].W;
-                unsigned int L = this->layerNameToParams[layerName].L;
+                unsigned int W = this->layerIdToParams[layerId].W;
+                unsigned int L = this->layerIdToParams[layerId].L;
 
-                unsigned int WPrev;
-                if(expl.layerNameToID[layerName] == 0) {
-                    WPrev = W;
-                } else {
-                    WPrev = this->layerNameToParams[expl.layerIdToName[expl.layerNameToID[layerName]-1]].W;
-                }
+                llvm::Optional<uint64_t> prev = this->layerIdToPrev[layerId];
+                unsigned int WPrev = prev.hasValue() ? this->layerIdToParams[prev.getValue()].W : W;
 
                 uint64_t F0 = absOp->getF0();
                 // TODO fix for F1
 
-                uint64_t linesPerTile = expl.getLinesPerTile(expl.layerNameToID[layerName], this->layerNameToParams[layerName]);
+                uint64_t linesPerTile = this->getLinesPerTile(layerId, expl);
 
                 //llvm::outs() << "LinesPertile:  " << linesPerTile << "\n";
 
@@ -713,15 +922,16 @@ namespace xilinx {
                 uint64_t nEndLineTile = nEndLine / linesPerTile;
 
                 //llvm::outs() << "startLine = " << startLine << ", endLine: " << endLine << "\n";
-                llvm::outs() << "start = " << startLine / linesPerTile << ", end: " << endLine / linesPerTile << "\n";
-                llvm::outs() << "nStart = " << nStartLineTile << ", nEnd: " << nEndLineTile << "\n";
+                LLVM_DEBUG(llvm::outs() << "start = " << startLine / linesPerTile << ", end: " << endLine / linesPerTile << "\n");
+                LLVM_DEBUG(llvm::outs() << "nStart = " << nStartLineTile << ", nEnd: " << nEndLineTile << "\n");
 
-                std::vector<std::string> wantLines;
+                uint64_t prevLayerId = prev.hasValue() ? prev.getValue() : 0;
+                std::vector<TileKey> wantLines;
                 for(uint64_t i = std::max(endLineTile+1, nStartLineTile); i <= nEndLineTile; i++) {
-                    if((i - highestLocTile - 1) >= 0) {
+                    if(i > highestLocTile) {
                         unsigned int target = (i - highestLocTile - 1) % WPrev;
                         //llvm::outs() << "want At: " << target << "\n";
-                        wantLines.push_back("tile" + std::to_string(target) + "C" + std::to_string(locCa));
+                        wantLines.push_back(tileKey(prevLayerId, target, locCa));
                     }
                 }
 
@@ -729,10 +939,10 @@ namespace xilinx {
             }
 
             // TODO Double check depth-wise handling
-            std::map<std::string, Value> findProducedTiles(std::string layerName) {
-                std::map<std::string, Value> producedLineToOp;
-                ModelParams params = this->layerNameToParams[layerName];
-                for(AbsOpWrapper* prevAbsOp : this->layerNameToOps[layerName]) {
+            llvm::DenseMap<TileKey, Value> findProducedTiles(uint64_t layerId, DataflowExplorer &expl) {
+                llvm::DenseMap<TileKey, Value> producedLineToOp;
+                ModelParams params = this->layerIdToParams[layerId];
+                for(AbsOpWrapper* prevAbsOp : this->layerIdToOps[layerId]) {
                     Operation* op = prevAbsOp->getUnderlyingOperation();
                     unsigned int locCa = getAttrOrDefault(op, "locCa", 0);
                     unsigned int locL = getAttrOrDefault(op, "locL", 0);
@@ -748,16 +958,15 @@ namespace xilinx {
                             unsigned int concatP = (unsigned int)-1;
                             bool isPConcat = true;
                             for(auto o : concat.getOperands()) {
-                                (void)o;
-                                //Operation* concatArg = o.getDefiningOp();
-                                unsigned int locW = getAttrOrDefault(op, "locW", 0);
-                                unsigned int locP = getAttrOrDefault(op, "locP", 0);
+                                Operation* concatArg = o.getDefiningOp();
+                                unsigned int locW = getAttrOrDefault(concatArg, "locW", 0);
+                                unsigned int locP = getAttrOrDefault(concatArg, "locP", 0);
 
                                 if(locP < concatP) {
                                     concatP = locP;
                                 }
 
-                                if(locW == (unsigned int)-1) {
+                                if(concatW == (unsigned int)-1) {
                                     concatW = locW;
                                 } else if(locW != concatW) {
                                     isPConcat = false;
@@ -767,8 +976,7 @@ namespace xilinx {
 
                             unsigned int concatSize = concat.getNumOperands();
                             if(isPConcat) {
-                                std::string hashString = "tile" + std::to_string(concatW) + "C" + std::to_string(concatP / concatSize);
-                                producedLineToOp[hashString] = concat.getResult();
+                                producedLineToOp[tileKey(layerId, concatW, concatP / concatSize)] = concat.getResult();
                             }
                         } else if(op->getResult(0).hasOneUse() && llvm::dyn_cast<SplitOp>(*(op->getResult(0).getUsers().begin()))) {
                             SplitOp split = llvm::dyn_cast<SplitOp>(*(op->getResult(0).getUsers().begin()));
@@ -779,7 +987,7 @@ namespace xilinx {
                             for(auto u : split->getUsers()) { // TODO double check this
                                 unsigned int locW = getAttrOrDefault(u, "locW", 0);
 
-                                if(locW == (unsigned int)-1) {
+                                if(splitW == (unsigned int)-1) {
                                     splitW = locW;
                                 } else if(locW != splitW) {
                                     isPSplit = false;
@@ -792,14 +1000,12 @@ namespace xilinx {
                             if(isPSplit) {
                                 for(unsigned int i = 0; i < splitSize; i++) {
                                     unsigned int pLoc = locP * splitSize + i;
-                                    std::string hashString = "tile" + std::to_string(splitW) + "C" + std::to_string(pLoc);
-                                    producedLineToOp[hashString] = split.getResult(i);
+                                    producedLineToOp[tileKey(layerId, splitW, pLoc)] = split.getResult(i);
                                 }
                             }
                         } else {
-                            std::string hashString = "tile" + std::to_string(locW) + "C" + std::to_string(locP);
-                            llvm::outs() << "Producing: " << hashString << "\n";
-                            producedLineToOp[hashString] = prevAbsOp->getUnderlyingOperation()->getResult(0);
+                            LLVM_DEBUG(llvm::outs() << "Producing: tile " << locW << " C " << locP << "\n");
+                            producedLineToOp[tileKey(layerId, locW, locP)] = prevAbsOp->getUnderlyingOperation()->getResult(0);
                         }
                     }
                 }
@@ -808,23 +1014,26 @@ namespace xilinx {
             }
 
             // TODO for now select arbitrary line from any core that has it, might change that
-            std::map<std::string, Value> findLocalTiles(std::string layerName, DataflowExplorer &expl) {
-                std::map<std::string, Value> localLines;
-                //ModelParams params = this->layerNameToParams[layerName];
-                std::vector<AbsOpWrapper*> absOps = this->layerNameToOps[layerName];
+            llvm::DenseMap<TileKey, Value> findLocalTiles(uint64_t layerId, DataflowExplorer &expl) {
+                llvm::DenseMap<TileKey, Value> localLines;
+                //ModelParams params = this->layerIdToParams[layerId];
+                std::vector<AbsOpWrapper*> absOps = this->layerIdToOps[layerId];
                 std::vector<AbsOpWrapper*> toDelete;
 
                 for(uint64_t i = 0; i < absOps.size(); i++) {
-                    printOperationLoc(this->layerNameToOps[layerName].at(i)->getUnderlyingOperation());
-                    std::vector<std::string> linesLoc = this->workOn(this->layerNameToOps[layerName].at(i), expl);
+                    printOperationLoc(this->layerIdToOps[layerId].at(i)->getUnderlyingOperation());
+                    std::vector<TileKey> linesLoc = this->workOn(this->layerIdToOps[layerId].at(i), layerId, expl);
 
-                    for(std::string s : linesLoc) {
-                        AbsOpWrapper* absOp = this->layerNameToOps[layerName].at(i);
+                    for(TileKey s : linesLoc) {
+                        AbsOpWrapper* absOp = this->layerIdToOps[layerId].at(i);
 
-                        llvm::outs() << "locTiles: " << s << "\n";
+                        LLVM_DEBUG(llvm::outs() << "locTiles: " << s << "\n");
 
                         if(absOp->getUnderlyingOperation()->getNumResults() == 2) {
                             localLines[s] = absOp->getUnderlyingOperation()->getResult(1);
+                        } else if(!absOp->hasWeights()) {
+                            // No partial variant to forward the lines, the next replica reads the same input lines
+                            localLines[s] = absOp->getInput();
                         } else {
                             unsigned int locW = getAttrOrDefault(absOp->getUnderlyingOperation(), "locW", 0);
                             mlir::torch::Torch::BaseTensorType partialRes = absOp->getUnderlyingOperation()->getResult(0).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
@@ -832,8 +1041,8 @@ namespace xilinx {
 
                             OpBuilder builder(absOp->getUnderlyingOperation());
 
-                            absOp->getUnderlyingOperation()->print(llvm::outs());
-                            llvm::outs() << "\n";
+                            LLVM_DEBUG(absOp->getUnderlyingOperation()->print(llvm::outs()));
+                            LLVM_DEBUG(llvm::outs() << "\n");
 
                             Operation* nOp = absOp->wCopy(builder, locW, llvm::Optional<TypeRange>(TypeRange{partialRes, forwardRes}));
 
@@ -842,7 +1051,7 @@ namespace xilinx {
                             absOp->getUnderlyingOperation()->erase();
                             toDelete.push_back(absOp);
 
-                            this->layerNameToOps[layerName].at(i) = opToWrapper(nOp);
+                            this->layerIdToOps[layerId].at(i) = opToWrapper(nOp);
 
                             localLines[s] = nOp->getResult(1);
                         }
@@ -854,21 +1063,22 @@ namespace xilinx {
                 }
                 toDelete.clear();
 
-                llvm::outs() << "Done\n";
+                LLVM_DEBUG(llvm::outs() << "Done\n");
 
                 return localLines;
             }
 
-            void wDuplicate(std::string layerName, unsigned int into) {
-                std::vector<AbsOpWrapper*> layerOps = layerNameToOps[layerName];
+            void wDuplicate(uint64_t layerId, unsigned int into, DataflowExplorer &expl) {
+                std::vector<AbsOpWrapper*> layerOps = layerIdToOps[layerId];
 
                 for(int64_t i = into-1; i >= 0; i--) {
-                    llvm::outs() << "IntoLoc: " << i << "\n";
-                    OpBuilder builder(layerNameToOps[layerName].at(0)->getUnderlyingOperation());
-                    std::map<std::string, AbsOpWrapper*> paramsToLayer;
-                    std::map<std::string, std::vector<Value>> concatLocToArg;
-                    std::map<std::string, Value> concatLocToRes;
-                    for(AbsOpWrapper* absOp : layerNameToOps[layerName]) {
+                    LLVM_DEBUG(llvm::outs() << "IntoLoc: " << i << "\n");
+                    OpBuilder builder(layerIdToOps[layerId].at(0)->getUnderlyingOperation());
+                    llvm::DenseMap<TileKey, AbsOpWrapper*> paramsToLayer;
+                    // Concats are instantiated in the order they were found to keep the output stable
+                    llvm::MapVector<TileKey, std::vector<Value>> concatLocToArg;
+                    llvm::DenseMap<TileKey, Value> concatLocToRes;
+                    for(AbsOpWrapper* absOp : layerIdToOps[layerId]) {
                         if(i == 0) {
                             auto ty = IntegerType::get(builder.getContext(), 32);
                             auto attr = IntegerAttr::get(ty, 0);
@@ -904,150 +1114,132 @@ namespace xilinx {
                                 unsigned int locP = getAttrOrDefault(op, "locP", 0);
                                 unsigned int vectorLoc = locP - concatP;
 
-                                std::string hashString = "tile" + std::to_string(concatW) + "C" + std::to_string(concatP);
-                                unsigned int concatLocToArgSize = concatLocToArg[hashString].size();
+                                TileKey key = tileKey(layerId, concatW, concatP);
+                                unsigned int concatLocToArgSize = concatLocToArg[key].size();
 
                                 if(concatLocToArgSize == vectorLoc) {
-                                    concatLocToArg[hashString].push_back(op->getResult(0));
+                                    concatLocToArg[key].push_back(op->getResult(0));
                                 } else if(concatLocToArgSize < vectorLoc) {
                                     for(unsigned int i = concatLocToArgSize; i < vectorLoc; i++) {
-                                        concatLocToArg[hashString].push_back(Value());
+                                        concatLocToArg[key].push_back(Value());
                                     }
 
-                                    concatLocToArg[hashString].push_back(op->getResult(0));
+                                    concatLocToArg[key].push_back(op->getResult(0));
                                 } else {
-                                    concatLocToArg[hashString][vectorLoc] = op->getResult(0);
+                                    concatLocToArg[key][vectorLoc] = op->getResult(0);
                                 }
 
-                                concatLocToRes[hashString] = concat.getResult();
+                                concatLocToRes[key] = concat.getResult();
                             }
 
                             unsigned int locCa = getAttrOrDefault(absOp->getUnderlyingOperation(), "locCa", 0);
                             unsigned int locL = getAttrOrDefault(absOp->getUnderlyingOperation(), "locL", 0);
                             unsigned int locP = getAttrOrDefault(absOp->getUnderlyingOperation(), "locP", 0);
-                            std::string hashString = "P" + std::to_string(locP) +
-                                "Ca" + std::to_string(locCa) +
-                                "L" + std::to_string(locL);
-
-                            paramsToLayer[hashString] = locAbsOp;
+                            paramsToLayer[coreKey(locP, locCa, locL)] = locAbsOp;
                         }
                     }
 
-                    llvm::outs() << "Generated stuff now re-wire..\n";
+                    LLVM_DEBUG(llvm::outs() << "Generated stuff now re-wire..\n");
 
                     // Re-wire duplicated one with inputs from same W group
-                    std::map<std::string, AbsOpWrapper*>::iterator it;
-                    for(it = paramsToLayer.begin(); it != paramsToLayer.end(); it++) {
-                        AbsOpWrapper* absOp = it->second;
+                    for(auto &it : paramsToLayer) {
+                        AbsOpWrapper* absOp = it.second;
                         Operation* op = absOp->getUnderlyingOperation();
 
                         unsigned int locCa = getAttrOrDefault(absOp->getUnderlyingOperation(), "locCa", 0);
                         unsigned int locL = getAttrOrDefault(absOp->getUnderlyingOperation(), "locL", 0);
                         unsigned int locP = getAttrOrDefault(absOp->getUnderlyingOperation(), "locP", 0);
 
-                        //unsigned int Ca = this->layerNameToParams[layerName].Ca;
-                        //unsigned int P = this->layerNameToParams[layerName].P;
-                        unsigned int L = this->layerNameToParams[layerName].L;
+                        //unsigned int Ca = this->layerIdToParams[layerId].Ca;
+                        //unsigned int P = this->layerIdToParams[layerId].P;
+                        unsigned int L = this->layerIdToParams[layerId].L;
 
                         if(locL != 0) {
-                            std::string hashString = "P" + std::to_string(locP)
-                                + "Ca" + std::to_string(locCa)
-                                + "L" + std::to_string(locL - 1);
-                            AbsOpWrapper* prevAbsOp = paramsToLayer[hashString];
+                            AbsOpWrapper* prevAbsOp = paramsToLayer[coreKey(locP, locCa, locL - 1)];
 
                             op->replaceUsesOfWith(absOp->getInput(), prevAbsOp->getUnderlyingOperation()->getResult(1));
                             op->replaceUsesOfWith(absOp->getPartialInput(), prevAbsOp->getUnderlyingOperation()->getResult(0));
                         } else if(locCa != 0  && locL == 0) {
-                            std::string hashString = "P" + std::to_string(locP)
-                                + "Ca" + std::to_string(locCa-1)
-                                + "L" + std::to_string(L-1);
-                            AbsOpWrapper* prevAbsOp = paramsToLayer[hashString];
+                            AbsOpWrapper* prevAbsOp = paramsToLayer[coreKey(locP, locCa - 1, L - 1)];
 
                             //op->replaceUsesOfWith(absOp->getInput(), prevAbsOp->getUnderlyingOperation()->getResult(1));
                             op->replaceUsesOfWith(absOp->getPartialInput(), prevAbsOp->getUnderlyingOperation()->getResult(0));
                         }
                     }
 
-                    llvm::outs() << "And finally instantiate the concats\n";
+                    LLVM_DEBUG(llvm::outs() << "And finally instantiate the concats\n");
 
                     // Instantiate the duplicated concats
-                    std::map<std::string, std::vector<Value>>:: iterator concatIt;
-                    for(concatIt = concatLocToArg.begin(); concatIt != concatLocToArg.end(); concatIt++) {
-                        insertConcat(builder, concatLocToRes[it->first], concatIt->second, C_LOC, true);
+                    for(auto &concatIt : concatLocToArg) {
+                        insertConcat(builder, concatLocToRes[concatIt.first], concatIt.second, C_LOC, true);
                     }
                 }
 
                 // Assign new layer
-                layerNameToOps[layerName] = layerOps;
+                layerIdToOps[layerId] = layerOps;
             }
 
-            void reWire(std::string layerName, DataflowExplorer &expl) {
-                //OpBuilder builder(layerNameToOps[layerName].at(0)->getUnderlyingOperation());
+            void reWire(uint64_t layerId, DataflowExplorer &expl) {
+                //OpBuilder builder(layerIdToOps[layerId].at(0)->getUnderlyingOperation());
 
                 // construct line location
-                std::vector<std::string>::iterator layerLoc;
-                layerLoc = std::find(this->layerOrdering.begin(), this->layerOrdering.end(), layerName);
-                bool firstLayer = layerLoc == this->layerOrdering.begin();
+                llvm::Optional<uint64_t> prev = this->layerIdToPrev[layerId];
+                bool firstLayer = !prev.hasValue() || this->isParallelLayer(prev.getValue());
 
-                std::map<std::string, Value> producedTiles;
+                llvm::DenseMap<TileKey, Value> producedTiles;
                 if(!firstLayer) {
-                    producedTiles = this->findProducedTiles(*(layerLoc-1));
+                    uint64_t prevLayerId = prev.getValue();
+                    producedTiles = this->findProducedTiles(prevLayerId, expl);
 
                     // Makes sure producedTile Shape matches with the one of the current layer
-                    ModelParams paramsCurr = this->layerNameToParams[layerName];
-                    ModelParams paramsPrev = this->layerNameToParams[expl.layerIdToName[expl.layerNameToID[layerName]-1]];
+                    ModelParams paramsCurr = this->layerIdToParams[layerId];
+                    ModelParams paramsPrev = this->layerIdToParams[prevLayerId];
 
                     if(paramsCurr.W > paramsPrev.W) { // Duplicate so that matches next
-                        unsigned int ratio = ceil((float)paramsCurr.W / paramsPrev.W);
+                        unsigned int ratio = ceilDiv(paramsCurr.W, paramsPrev.W);
 
                         for(unsigned int p = 0; p < paramsPrev.P; p++) {
                             for(unsigned int i = 0; i < ratio; i++) {
                                 for(unsigned int w = 0; w < paramsPrev.W; w++) {
-                                    std::string hashString = "tile" + std::to_string(w) + "C" + std::to_string(p);
-                                    std::string dupHashString = "tile" + std::to_string(w + i * ratio) + "C" + std::to_string(p);
-
-                                    producedTiles[dupHashString] = producedTiles[hashString];
+                                    Value produced = producedTiles[tileKey(prevLayerId, w, p)];
+                                    producedTiles[tileKey(prevLayerId, w + i * paramsPrev.W, p)] = produced;
                                 }
                             }
                         }
                     } else if(paramsCurr.W < paramsPrev.W) { // Insert concat on parallel tiles produced
-                        unsigned int ratio = ceil((float)paramsPrev.W / paramsCurr.W);
+                        unsigned int ratio = ceilDiv(paramsPrev.W, paramsCurr.W);
 
-                        llvm::outs() << "Ratio: " << ratio << "\n";
+                        LLVM_DEBUG(llvm::outs() << "Ratio: " << ratio << "\n");
 
                         std::vector<Value> concats;
                         std::vector<Value> concatsArgs;
 
-                        OpBuilder builder(this->layerNameToOps[layerName].at(0)->getUnderlyingOperation());
+                        OpBuilder builder(this->layerIdToOps[layerId].at(0)->getUnderlyingOperation());
                         for(unsigned int p = 0; p < paramsPrev.P; p++) {
+                            concats.clear();
                             for(unsigned int i = 0; i < paramsPrev.W; i++) {
                                 if((i != 0) && ((i % ratio) == 0)) {
-                                    //OpBuilder builder(concatsArgs.at(concatsArgs.size()-1).getDefiningOp());
                                     concats.push_back(insertConcat(builder, concatsArgs.at(0), concatsArgs, N_LOC, false)->getResult(0));
                                     concatsArgs.clear();
-                                } else {
-                                    std::string hashString = "tile" + std::to_string(i) + "C" + std::to_string(p);
-                                    llvm::outs() << "PushBack: " << hashString << "\n";
-                                    concatsArgs.push_back(producedTiles[hashString]);
                                 }
+
+                                LLVM_DEBUG(llvm::outs() << "PushBack: tile " << i << " C " << p << "\n");
+                                concatsArgs.push_back(producedTiles[tileKey(prevLayerId, i, p)]);
                             }
 
                             if(concatsArgs.size() != 0) {
-                                //OpBuilder builder(concatsArgs.at(concatsArgs.size()-1).getDefiningOp());
                                 concats.push_back(insertConcat(builder, concatsArgs.at(0), concatsArgs, N_LOC, false)->getResult(0));
                                 concatsArgs.clear();
                             }
 
                             for(unsigned int i = 0; i < concats.size(); i++) {
-                                std::string hashString = "tile" + std::to_string(i) + "C" + std::to_string(p);
-                                llvm::outs() << "Keep: "  << hashString << "\n";
-                                producedTiles[hashString] = concats.at(i);
+                                LLVM_DEBUG(llvm::outs() << "Keep: tile " << i << " C " << p << "\n");
+                                producedTiles[tileKey(prevLayerId, i, p)] = concats.at(i);
                             }
 
                             for(unsigned int i = concats.size(); i < paramsPrev.W; i++) {
-                                std::string hashString = "tile" + std::to_string(i) + "C" + std::to_string(p);
-                                llvm::outs() << "remove: "  << hashString << "\n";
-                                producedTiles.erase(hashString);
+                                LLVM_DEBUG(llvm::outs() << "remove: tile " << i << " C " << p << "\n");
+                                producedTiles.erase(tileKey(prevLayerId, i, p));
                             }
                         }
                     }
@@ -1056,53 +1248,50 @@ namespace xilinx {
                     // TODO or leave it to a potential clean pass
                 }
 
-                std::map<std::string, Value> locTiles = this->findLocalTiles(layerName, expl);
+                llvm::DenseMap<TileKey, Value> locTiles = this->findLocalTiles(layerId, expl);
 
-                llvm::outs() << "\n\nReplacing things..\n\n";
+                LLVM_DEBUG(llvm::outs() << "\n\nReplacing things..\n\n");
 
                 // really re-wire from reconstructed info
                 // Now easy because guarantee to find exactly what we need
-                for(AbsOpWrapper* absOp : this->layerNameToOps[layerName]) {
+                for(AbsOpWrapper* absOp : this->layerIdToOps[layerId]) {
                     Operation* op = absOp->getUnderlyingOperation();
 
                     printOperationLoc(op);
                     if(firstLayer) {
-                        // TODO link to input of network
+                        // Replicas of the first layer, or following a parallel layer, all read the whole input
                     } else {
-                        std::vector<std::string> wantLoc = this->wantLoc(absOp, expl);
-                        llvm::outs() << "WantLoSize: " << wantLoc.size() << "\n";
+                        std::vector<TileKey> wantLoc = this->wantLoc(absOp, layerId, expl);
+                        LLVM_DEBUG(llvm::outs() << "WantLoSize: " << wantLoc.size() << "\n");
 
-                        std::vector<Value> ins;
+                        // Keeps the order in which the tiles are wanted and dedups in constant time
+                        llvm::SmallSetVector<Value, 4> ins;
 
-                        for(std::string s : wantLoc) {
-                            llvm::outs() << "wantLoc: " << s << "\n";
-                            if(locTiles.find(s) != locTiles.end()) {
-                                llvm::outs() << "wantLoc found locally: " << s << "\n";
+                        for(TileKey s : wantLoc) {
+                            LLVM_DEBUG(llvm::outs() << "wantLoc: " << s << "\n");
+                            if(locTiles.count(s) != 0) {
+                                LLVM_DEBUG(llvm::outs() << "wantLoc found locally: " << s << "\n");
                                 //locTiles[s].print(llvm::outs());
                                 assert(absOp->getInput() != Value());
                                 assert(locTiles[s] != Value());
 
-                                llvm::outs() << "Replacing: ";
-                                absOp->getInput().print(llvm::outs());
-                                llvm::outs() << "\n with ";
-                                locTiles[s].print(llvm::outs());
-                                llvm::outs() << "\n";
+                                LLVM_DEBUG(llvm::outs() << "Replacing: ");
+                                LLVM_DEBUG(absOp->getInput().print(llvm::outs()));
+                                LLVM_DEBUG(llvm::outs() << "\n with ");
+                                LLVM_DEBUG(locTiles[s].print(llvm::outs()));
+                                LLVM_DEBUG(llvm::outs() << "\n");
 
-                                if(std::find(ins.begin(), ins.end(), locTiles[s]) == ins.end()) {
-                                    ins.push_back(locTiles[s]);
-                                }
+                                ins.insert(locTiles[s]);
 
                                 //op->replaceUsesOfWith(absOp->getInput(), locTiles[s]);
                             }
                         }
 
-                        std::vector<std::string> wantPrev = this->wantPrev(absOp, expl);
-                        llvm::outs() << "WantPrevSize: " << wantPrev.size() << "\n";
-                        for(std::string s : wantPrev) {
-                            llvm::outs() << "wantPrev: " << s << "\n";
-                            if(std::find(ins.begin(), ins.end(), producedTiles[s]) == ins.end()) {
-                                ins.push_back(producedTiles[s]);
-                            }
+                        std::vector<TileKey> wantPrev = this->wantPrev(absOp, layerId, expl);
+                        LLVM_DEBUG(llvm::outs() << "WantPrevSize: " << wantPrev.size() << "\n");
+                        for(TileKey s : wantPrev) {
+                            LLVM_DEBUG(llvm::outs() << "wantPrev: " << s << "\n");
+                            ins.insert(producedTiles[s]);
 
                             //op->replaceUsesOfWith(absOp->getInput(), producedTiles[s]);
                         }
@@ -1110,10 +1299,11 @@ namespace xilinx {
                         assert(ins.size() >= 1);
                         if(ins.size() > 1) {
                             OpBuilder builder(op);
-                            Operation* concatOp = insertConcat(builder, ins.at(0), ins, N_LOC, false);
+                            std::vector<Value> insVector(ins.begin(), ins.end());
+                            Operation* concatOp = insertConcat(builder, insVector.at(0), insVector, N_LOC, false);
                             op->replaceUsesOfWith(absOp->getInput(), concatOp->getResult(0));
                         } else {
-                            op->replaceUsesOfWith(absOp->getInput(), ins.at(0));
+                            op->replaceUsesOfWith(absOp->getInput(), ins[0]);
                         }
                     }
                 }
@@ -1122,25 +1312,31 @@ namespace xilinx {
 
             // TODO might generate chains of concat, or concat and then split on a different dim
             // TODO either need a simplify pass of handle things better
-            LogicalResult WTransform(std::string layerName, unsigned int into, DataflowExplorer &expl) {
+            LogicalResult WTransform(uint64_t layerId, unsigned int into, DataflowExplorer &expl) {
+                PhaseTimer timer(this->getAnalysisManager(), this->getOperation(), "WTransform");
+
                 if(into == 1) {
                     return success();
                 }
 
-                llvm::outs() << "wDuplicate\n";
+                LLVM_DEBUG(llvm::outs() << "wDuplicate\n");
 
                 // duplicate graph into times
-                wDuplicate(layerName, into);
+                wDuplicate(layerId, into, expl);
 
-                llvm::outs() << "reWrire\n";
+                LLVM_DEBUG(llvm::outs() << "reWrire\n");
 
                 // Re-wire
-                reWire(layerName, expl);
+                reWire(layerId, expl);
 
-                llvm::outs() << "reWrire 2 \n\n\n";
+                LLVM_DEBUG(llvm::outs() << "reWrire 2 \n\n\n");
 
-                if(expl.layerNameToID[layerName] != (expl.layerNameToID.size()-1)) {
-                    reWire(expl.layerIdToName[expl.layerNameToID[layerName]+1], expl);
+                // Consumers come later in topological order
+                for(uint64_t next = layerId + 1; next < this->layerIdToPrev.size(); next++) {
+                    llvm::Optional<uint64_t> nextPrev = this->layerIdToPrev[next];
+                    if(nextPrev.hasValue() && (nextPrev.getValue() == layerId) && !this->isParallelLayer(next)) {
+                        reWire(next, expl);
+                    }
                 }
 
                 return success();
@@ -1156,89 +1352,79 @@ namespace xilinx {
                     return;
                 }
 
-                DataflowExplorer dataflowExplorer = initializeLayerNameToOps(graph);
-                //initializeLayerNameToParams(graph);
-
-                // Explore topology space
-                llvm::outs() << "Total Compute is: " << dataflowExplorer.getTotalCompute() << "\n";
-                dataflowExplorer.enumerate();
-                //dataflowExplorer.printValidTopologies();
-                dataflowExplorer.dumpValidTopologies();
-                dataflowExplorer.dumpParetoFrontiers();
-                dataflowExplorer.dumpPathsFrom(dataflowExplorer.paretoThroughput, "./output/throughput");
-                dataflowExplorer.dumpPathsFrom(dataflowExplorer.paretoLatency, "./output/latency");
+                if(failed(checkLayerOps(graph))) {
+                    signalPassFailure();
+                    return;
+                }
 
-                llvm::outs() << "MaxThroughput...\n";
+                DataflowExplorer dataflowExplorer = initializeLayers(graph);
 
-                this->layerNameToParams = dataflowExplorer.getMaxThroughput();
+                for(uint64_t id = 0; id < this->layerIdToParams.size(); id++) {
+                    if(!this->layerIdToParams[id].nonZero() || failed(checkSplitSizes(id))) {
+                        clearLayers();
+                        signalPassFailure();
+                        return;
+                    }
+                }
 
-                llvm::outs() << "Running expansion...\n";
+                LLVM_DEBUG(llvm::outs() << "Running expansion...\n");
 
                 // Expand P, Ca, L for all layers
-                std::map<std::string, ModelParams>::iterator it;
-                unsigned int i = 0;
-                for(it = layerNameToParams.begin(); it != layerNameToParams.end(); it++) {
-                    unsigned int P = it->second.P;
-                    unsigned int Ca = it->second.Ca;
-                    unsigned int L = it->second.L;
+                for(uint64_t id = 0; id < this->layerIdToParams.size(); id++) {
+                    unsigned int P = this->layerIdToParams[id].P;
+                    unsigned int Ca = this->layerIdToParams[id].Ca;
+                    unsigned int L = this->layerIdToParams[id].L;
+
+                    LLVM_DEBUG(llvm::outs() << "P\n");
+
+                    // Ca and L are always 1 for parallel layers
+                    if(this->isParallelLayer(id)) {
+                        if(!parallelTransform(id, C_LOC, "locP", P).succeeded()) {
+                            llvm::outs() << "Failed to apply PTransform\n";
+                            exit(1);
+                        }
 
-                    llvm::outs() << "P\n";
+                        continue;
+                    }
 
-                    if(!PTransform(it->first, P).succeeded()) {
+                    if(!PTransform(id, P).succeeded()) {
                         llvm::outs() << "Failed to apply PTransform\n";
                         exit(1);
                     }
 
-                    llvm::outs() << "Ca\n";
+                    LLVM_DEBUG(llvm::outs() << "Ca\n");
 
-                    if(!CaTransform(it->first, Ca).succeeded()) {
+                    if(!CaTransform(id, Ca).succeeded()) {
                         llvm::outs() << "Failed to apply CaTransform\n";
                         exit(1);
                     }
 
-                    llvm::outs() << "L\n";
+                    LLVM_DEBUG(llvm::outs() << "L\n");
 
-                    if(!LTransform(it->first, L).succeeded()) {
+                    if(!LTransform(id, L).succeeded()) {
                         llvm::outs() << "Failed to apply LTransform\n";
                         exit(1);
                     }
-
-                    i += 1;
                 }
 
-                llvm::outs() << "W;;;\n";
-
-                // And then W
-                /*for(it = layerNameToParams.begin(); it != layerNameToParams.end(); it++) {
-                    unsigned int W = it->second.W;
-                    if(!WTransform(it->first, W, dataflowExplorer).succeeded()) {
-                        llvm::outs() << "Failed to apply WTransform\n";
-                        exit(1);
+                // And then W, in topological order as reWire links each layer to the tiles of its producer
+                if(expandW) {
+                    for(uint64_t id = 0; id < this->layerIdToParams.size(); id++) {
+                        unsigned int W = this->layerIdToParams[id].W;
+
+                        LogicalResult res = this->isParallelLayer(id) ?
+                            parallelTransform(id, lineDim(id), "locW", W) :
+                            WTransform(id, W, dataflowExplorer);
+                        if(!res.succeeded()) {
+                            llvm::outs() << "Failed to apply WTransform\n";
+                            exit(1);
+                        }
                     }
-                    }*/
-
-                /*this->layerNameToParams["conv2d_relu0"] = ModelParams(1,1,1,1,false);
-                this->layerNameToParams["conv2d_relu1"] = ModelParams(1,1,3,3,true);
-                this->layerNameToParams["conv2d_relu2"] = ModelParams(1,1,3,1,true);
-
-                this->layerNameToParams["max_pool2d_with_indices0"] = ModelParams(1,1,1,1,false);
-                this->layerNameToParams["max_pool2d_with_indices1"] = ModelParams(1,1,1,1,false);
-
-                //PTransform("conv2d_relu1", 4);
-                //PTransform("max_pool2d_with_indices1", 4);
-                //CaTransform("conv2d_relu2", 4);
-
-                LTransform("conv2d_relu1", 3);
-                LTransform("conv2d_relu2", 3);
-
-                llvm::outs() << "WTransform\n";
-
-                // W expand
-                WTransform("conv2d_relu1", 3, dataflowExplorer);*/
+                }
 
-                llvm::outs() << "Cleaning..\n";
+                LLVM_DEBUG(llvm::outs() << "Cleaning..\n");
 
-                clearLayerNameToOps();
+                clearLayers();
 
                 //exit(1);
             }
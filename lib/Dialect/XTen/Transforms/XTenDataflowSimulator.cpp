@@ -0,0 +1,402 @@
+//===- XTenDataflowSimulator.cpp --------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "xten/Dialect/XTen/XTenDataflowSimulator.h"
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+#include <algorithm>
+
+#define DEBUG_TYPE "xten-dataflow-simulator"
+
+// Lines are counted over the whole run: line l of sample s is s * lines + l
+// A tile of a layer reads its share of the input lines plus F0 - 1 halo lines, layers are
+// padded so that output line y reads input lines y - (F0 - 1) / 2 to y + F0 / 2
+
+namespace xilinx {
+    namespace xten {
+        enum SimState {SimIdle, SimRunning, SimInputStall, SimStreamStall, SimOutputStall};
+
+        DataflowSimulator::DataflowSimulator(DataflowExplorer &explorer, std::vector<ModelParams> &path) : explorer(explorer) {
+            this->path = path;
+            this->numSamples = 0;
+            this->endTime = 0;
+
+            for(uint64_t i = 0; i < path.size(); i++) {
+                ModelParams &params = this->path.at(i);
+                SimLayerStats_t stats;
+
+                stats.tiles = params.lineGranularity ? this->inLines(i) : explorer.getK(i, params);
+                stats.computeTileTime = std::max((uint64_t)1, explorer.getComputeTimePerTile(i, params));
+                stats.streamTime = explorer.getActCommunicationTime(i, params);
+                stats.weightTileTime = explorer.getWeightCommunicationTimePerTile(i, params);
+
+                uint64_t linesPerTile = explorer.getLinesPerTile(i, params);
+                uint64_t banksPerLine = std::max((uint64_t)1, explorer.getBanksPerLine(i, params));
+                uint64_t inBanks = explorer.getActivationInBanks(i, params);
+                uint64_t coreLines = (linesPerTile != 0) ? inBanks * linesPerTile : inBanks / banksPerLine;
+
+                // The L cores of a chain each read F0 / L filter rows, their buffers are shifted by
+                // that many lines and together hold F0 - F0 / L more lines than one of them
+                int64_t F0 = explorer.layerNameToSize.at(i)["F0"];
+                stats.bufferLines = coreLines + F0 - getMaxSplitSize(F0, params.L, LINE_BLOCK);
+
+                this->layers.push_back(stats);
+            }
+
+            for(uint64_t i = 0; i < path.size(); i++) {
+                this->layers.at(i).requiredLines = this->getRequiredLines(i);
+            }
+        }
+
+        uint64_t DataflowSimulator::inLines(uint64_t layerId) {
+            return this->explorer.layerNameToSize.at(layerId)["N"];
+        }
+
+        uint64_t DataflowSimulator::outLines(uint64_t layerId) {
+            if(layerId < (this->path.size() - 1)) {
+                return this->inLines(layerId + 1);
+            }
+
+            uint64_t stride = std::max((int64_t)1, this->explorer.layerNameToSize.at(layerId)["stride"]);
+            return std::max((uint64_t)1, this->inLines(layerId) / stride);
+        }
+
+        // Input lines that must have been produced before tile starts
+        uint64_t DataflowSimulator::neededLines(uint64_t layerId, uint64_t tile) {
+            uint64_t tiles = this->layers.at(layerId).tiles;
+            uint64_t N = this->inLines(layerId);
+            uint64_t F0 = this->explorer.layerNameToSize.at(layerId)["F0"];
+            uint64_t s = tile / tiles;
+            uint64_t t = tile % tiles;
+
+            return s * N + std::min(N, ((t + 1) * N) / tiles + F0 / 2);
+        }
+
+        // Input lines that are not needed anymore once tile is done
+        uint64_t DataflowSimulator::releasedLines(uint64_t layerId, uint64_t tile) {
+            uint64_t tiles = this->layers.at(layerId).tiles;
+            uint64_t N = this->inLines(layerId);
+            uint64_t F0 = this->explorer.layerNameToSize.at(layerId)["F0"];
+            uint64_t s = tile / tiles;
+            uint64_t t = tile % tiles;
+
+            if(t == (tiles - 1)) {
+                return (s + 1) * N;
+            }
+
+            uint64_t end = ((t + 1) * N) / tiles;
+            uint64_t pad = (F0 - 1) / 2;
+            return s * N + ((end >= pad) ? (end - pad) : 0);
+        }
+
+        // Output lines available to the next layer once tile is done
+        uint64_t DataflowSimulator::producedLines(uint64_t layerId, uint64_t tile) {
+            uint64_t tiles = this->layers.at(layerId).tiles;
+            uint64_t NOut = this->outLines(layerId);
+            uint64_t s = tile / tiles;
+            uint64_t t = tile % tiles;
+
+            return s * NOut + ((t + 1) * NOut) / tiles;
+        }
+
+        // Largest number of lines a tile needs in the input buffer, counting what the previous tile did
+        // not release and the whole producer tile that makes the last needed line available
+        uint64_t DataflowSimulator::getRequiredLines(uint64_t layerId) {
+            SimLayerStats_t &stats = this->layers.at(layerId);
+
+            uint64_t required = 0;
+            for(uint64_t t = 0; t < stats.tiles; t++) {
+                uint64_t needed = this->neededLines(layerId, t);
+                uint64_t released = (t == 0) ? 0 : this->releasedLines(layerId, t - 1);
+
+                uint64_t covering = needed;
+                if(layerId > 0) {
+                    uint64_t producerTiles = this->layers.at(layerId - 1).tiles;
+                    uint64_t j = 0;
+                    while(this->producedLines(layerId - 1, j) < needed && j < (producerTiles - 1)) {
+                        j++;
+                    }
+
+                    covering = this->producedLines(layerId - 1, j);
+                }
+
+                required = std::max(required, covering - std::min(covering, released));
+            }
+
+            return required;
+        }
+
+        // Cycles to stream lines input lines to the layer
+        uint64_t DataflowSimulator::getStreamTime(uint64_t layerId, uint64_t lines) {
+            SimLayerStats_t &stats = this->layers.at(layerId);
+            uint64_t N = this->inLines(layerId);
+
+            return (lines * stats.streamTime + N - 1) / N;
+        }
+
+        bool DataflowSimulator::run(uint64_t numSamples) {
+            this->numSamples = std::max((uint64_t)1, numSamples);
+            this->failure = "";
+
+            uint64_t n = this->path.size();
+            for(uint64_t i = 0; i < n; i++) {
+                SimLayerStats_t &stats = this->layers.at(i);
+                if(stats.bufferLines < stats.requiredLines) {
+                    this->failure = "input buffer of " + this->explorer.layerIdToName[i] + " holds " +
+                        std::to_string(stats.bufferLines) + " lines but its tiles need " +
+                        std::to_string(stats.requiredLines);
+                    return false;
+                }
+            }
+
+            std::vector<SimState> state(n, SimIdle);
+            std::vector<uint64_t> nextTile(n, 0);
+            std::vector<uint64_t> finish(n, 0);
+            std::vector<uint64_t> produced(n, 0);
+            std::vector<uint64_t> released(n, 0);
+            std::vector<double> occupancyArea(n, 0);
+
+            // Input link of each layer, lines sent over it and lines that reached the input buffer
+            std::vector<bool> linkBusy(n, false);
+            std::vector<uint64_t> linkFinish(n, 0);
+            std::vector<uint64_t> sent(n, 0);
+            std::vector<uint64_t> arrived(n, 0);
+
+            // Weight link of each layer, counted in tiles
+            std::vector<bool> weightBusy(n, false);
+            std::vector<uint64_t> weightFinish(n, 0);
+            std::vector<uint64_t> weightsSent(n, 0);
+            std::vector<uint64_t> weightsArrived(n, 0);
+
+            uint64_t time = 0;
+            while(true) {
+                bool anyActive = false;
+                for(uint64_t i = 0; i < n; i++) {
+                    SimLayerStats_t &stats = this->layers.at(i);
+                    uint64_t total = stats.tiles * this->numSamples;
+                    uint64_t N = this->inLines(i);
+
+                    // Stream what the producer made available, at most one tile of lines at a time
+                    // so that the first lines of a chunk are not held back by the last ones
+                    uint64_t available = (i == 0) ? std::min(N * this->numSamples, released.at(i) + stats.bufferLines) : produced.at(i-1);
+                    if(!linkBusy.at(i) && sent.at(i) < available) {
+                        uint64_t chunk = std::min(available - sent.at(i), (N + stats.tiles - 1) / stats.tiles);
+                        sent.at(i) += chunk;
+                        linkBusy.at(i) = true;
+                        linkFinish.at(i) = time + this->getStreamTime(i, chunk);
+                    }
+
+                    if(state.at(i) != SimRunning && nextTile.at(i) < total) {
+                        uint64_t tile = nextTile.at(i);
+                        uint64_t needed = this->neededLines(i, tile);
+                        bool inputReady = arrived.at(i) >= needed;
+                        bool weightsReady = (stats.weightTileTime == 0) || (weightsArrived.at(i) > tile);
+                        bool outputFree = (i == (n - 1)) ||
+                            (this->producedLines(i, tile) <= (released.at(i+1) + this->layers.at(i+1).bufferLines));
+
+                        if(inputReady && weightsReady && outputFree) {
+                            state.at(i) = SimRunning;
+                            finish.at(i) = time + stats.computeTileTime;
+                            stats.busy += stats.computeTileTime;
+                        } else if(!outputFree) {
+                            state.at(i) = SimOutputStall;
+                        } else if(!inputReady && (i > 0) && (produced.at(i-1) < needed)) {
+                            state.at(i) = SimInputStall;
+                        } else {
+                            state.at(i) = SimStreamStall;
+                        }
+                    }
+
+                    // Weights of the next tile are streamed while the current one computes
+                    if(stats.weightTileTime != 0 && !weightBusy.at(i) && weightsSent.at(i) < total &&
+                       weightsSent.at(i) <= (nextTile.at(i) + ((state.at(i) == SimRunning) ? 1 : 0))) {
+                        weightsSent.at(i)++;
+                        weightBusy.at(i) = true;
+                        weightFinish.at(i) = time + stats.weightTileTime;
+                    }
+
+                    anyActive |= (state.at(i) == SimRunning) || linkBusy.at(i) || weightBusy.at(i);
+                }
+
+                if(!anyActive) {
+                    break;
+                }
+
+                uint64_t next = (uint64_t)-1;
+                for(uint64_t i = 0; i < n; i++) {
+                    if(state.at(i) == SimRunning) {
+                        next = std::min(next, finish.at(i));
+                    }
+                    if(linkBusy.at(i)) {
+                        next = std::min(next, linkFinish.at(i));
+                    }
+                    if(weightBusy.at(i)) {
+                        next = std::min(next, weightFinish.at(i));
+                    }
+                }
+
+                // Account for what happened until the next event
+                for(uint64_t i = 0; i < n; i++) {
+                    SimLayerStats_t &stats = this->layers.at(i);
+                    if(state.at(i) == SimInputStall) {
+                        stats.inputStall += next - time;
+                    } else if(state.at(i) == SimStreamStall) {
+                        stats.streamStall += next - time;
+                    } else if(state.at(i) == SimOutputStall) {
+                        stats.outputStall += next - time;
+                    }
+
+                    uint64_t held = (i == 0) ? sent.at(i) : produced.at(i-1);
+                    uint64_t occupancy = held - std::min(held, released.at(i));
+                    stats.maxOccupancy = std::max(stats.maxOccupancy, occupancy);
+                    occupancyArea.at(i) += (double)occupancy * (next - time);
+                }
+
+                time = next;
+
+                for(uint64_t i = 0; i < n; i++) {
+                    if(linkBusy.at(i) && linkFinish.at(i) == time) {
+                        arrived.at(i) = sent.at(i);
+                        linkBusy.at(i) = false;
+                    }
+
+                    if(weightBusy.at(i) && weightFinish.at(i) == time) {
+                        weightsArrived.at(i) = weightsSent.at(i);
+                        weightBusy.at(i) = false;
+                    }
+
+                    if(state.at(i) == SimRunning && finish.at(i) == time) {
+                        SimLayerStats_t &stats = this->layers.at(i);
+                        uint64_t tile = nextTile.at(i);
+
+                        produced.at(i) = this->producedLines(i, tile);
+                        released.at(i) = this->releasedLines(i, tile);
+                        state.at(i) = SimIdle;
+                        nextTile.at(i)++;
+
+                        if((tile % stats.tiles) == (stats.tiles - 1)) {
+                            if(tile / stats.tiles == 0) {
+                                stats.firstDone = time;
+                            }
+                            stats.lastDone = time;
+                        }
+                    }
+                }
+            }
+
+            this->endTime = time;
+
+            bool done = true;
+            for(uint64_t i = 0; i < n; i++) {
+                SimLayerStats_t &stats = this->layers.at(i);
+                stats.avgOccupancy = (time == 0) ? 0 : occupancyArea.at(i) / time;
+                done &= (nextTile.at(i) == stats.tiles * this->numSamples);
+            }
+
+            if(!done) {
+                LLVM_DEBUG(llvm::outs() << "Simulation deadlocked at cycle " << time << "\n");
+                this->failure = "pipeline deadlocked at cycle " + std::to_string(time);
+            }
+
+            return done;
+        }
+
+        uint64_t DataflowSimulator::getInterval() {
+            if(this->layers.size() == 0) {
+                return 0;
+            }
+
+            SimLayerStats_t &last = this->layers.back();
+            if(this->numSamples < 2) {
+                return last.lastDone;
+            }
+
+            return (last.lastDone - last.firstDone) / (this->numSamples - 1);
+        }
+
+        uint64_t DataflowSimulator::getLatency() {
+            if(this->layers.size() == 0) {
+                return 0;
+            }
+
+            return this->layers.back().firstDone;
+        }
+
+        std::string DataflowSimulator::emitReport() {
+            llvm::json::Object top;
+
+            uint64_t interval = this->getInterval();
+            uint64_t throughput = (interval == 0) ? 0 : (uint64_t)(1e9 / interval);
+            uint64_t predictedThroughput = this->explorer.getThroughput(this->path);
+            uint64_t latency = this->getLatency();
+            uint64_t predictedLatency = this->explorer.getEndToEndLatency(this->path);
+
+            top["valid"] = this->failure.empty();
+            if(!this->failure.empty()) {
+                top["failure"] = this->failure;
+            }
+            top["samples"] = (int64_t)this->numSamples;
+            top["cycles"] = (int64_t)this->endTime;
+            top["interval"] = (int64_t)interval;
+            top["throughput"] = (int64_t)throughput;
+            top["predictedThroughput"] = (int64_t)predictedThroughput;
+            top["throughputError"] = (predictedThroughput == 0) ? 0.0 : ((double)throughput - predictedThroughput) / predictedThroughput;
+            top["latency"] = (int64_t)latency;
+            top["predictedLatency"] = (int64_t)predictedLatency;
+            top["latencyError"] = (predictedLatency == 0) ? 0.0 : ((double)latency - predictedLatency) / predictedLatency;
+
+            llvm::json::Array layersJSON;
+            for(uint64_t i = 0; i < this->layers.size(); i++) {
+                SimLayerStats_t &stats = this->layers.at(i);
+                ModelParams &params = this->path.at(i);
+
+                uint64_t simulatedTime = (this->numSamples < 2) ? stats.lastDone :
+                    (stats.lastDone - stats.firstDone) / (this->numSamples - 1);
+
+                llvm::json::Object layer;
+                layer["name"] = this->explorer.layerIdToName[i];
+                layer["id"] = (int64_t)i;
+                layer["tiles"] = (int64_t)stats.tiles;
+                layer["computeTileTime"] = (int64_t)stats.computeTileTime;
+                layer["streamTime"] = (int64_t)stats.streamTime;
+                layer["weightTileTime"] = (int64_t)stats.weightTileTime;
+                layer["predictedTotalTime"] = (int64_t)this->explorer.getTotalTime(i, params);
+                layer["simulatedTotalTime"] = (int64_t)simulatedTime;
+                layer["utilization"] = (this->endTime == 0) ? 0.0 : (double)stats.busy / this->endTime;
+
+                llvm::json::Object stalls;
+                stalls["input"] = (int64_t)stats.inputStall;
+                stalls["output"] = (int64_t)stats.outputStall;
+                stalls["stream"] = (int64_t)stats.streamStall;
+                layer["stalls"] = llvm::json::Value(std::move(stalls));
+
+                llvm::json::Object buffer;
+                buffer["lines"] = (int64_t)stats.bufferLines;
+                buffer["requiredLines"] = (int64_t)stats.requiredLines;
+                buffer["maxOccupancy"] = (int64_t)stats.maxOccupancy;
+                buffer["avgOccupancy"] = stats.avgOccupancy;
+                layer["buffer"] = llvm::json::Value(std::move(buffer));
+
+                layersJSON.push_back(llvm::json::Value(std::move(layer)));
+            }
+
+            top["layers"] = llvm::json::Value(std::move(layersJSON));
+
+            llvm::json::Value topv(std::move(top));
+            std::string ret;
+            llvm::raw_string_ostream ss(ret);
+            ss << llvm::formatv("{0:2}", topv) << "\n";
+            return ss.str();
+        }
+    }
+}
@@ -10,12 +10,23 @@
 
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/OperationSupport.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
 #include "torch-mlir/Dialect/Torch/IR/TorchTypes.h"
 
 #include "xten/Dialect/XTen/XTenDataflowUtils.h"
 #include "xten/Dialect/XTen/XTenDataflowConsts.h"
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
 #define DEBUG_TYPE "xten-dataflow-utils"
 
 using namespace mlir;
@@ -52,172 +63,230 @@ namespace xilinx {
             return baseShapeManupulation(initShape, at, into, false);
         }
 
-        // TODO most likely factor some code here
-        void splitConstantActivationsInto(mlir::arith::ConstantOp op, std::vector<Value> &ops, OpBuilder &builder, unsigned int loc,
-                                          DenseElementsAttr at, unsigned int into) {
-            mlir::torch::Torch::BaseTensorType initialShape = at.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>(); // NOLF NEED CHECK
-            ArrayRef<int64_t> s = initialShape.getSizes();
+        mlir::torch::Torch::BaseTensorType resizeShapeAt(mlir::torch::Torch::BaseTensorType initShape, unsigned int at, int64_t size) {
+            std::vector<long> newShape = std::vector<long>(initShape.getSizes());
+            assert(size > 0);
+            newShape[at] = size;
 
-            uint64_t C = s[CIN_LOC];
-            uint64_t N = s[N_LOC];
-            uint64_t M = s[M_LOC];
+            ArrayRef<long> nShape = ArrayRef<long>(newShape);
+            auto tmpType = initShape.getWithSizesAndDtype(nShape, initShape.getDtype());
+            return tmpType.dyn_cast<mlir::torch::Torch::BaseTensorType>();
+        }
 
-            uint64_t C_switch = C;
-            uint64_t N_switch = N;
-            uint64_t M_switch = M;
+        // Splits size into parts that are multiple of granularity, the first parts get the
+        // remaining blocks and the last one gets what is left if size is not a multiple of granularity
+        // This is consistent with the getMissmatch* functions of the explorer
+        std::vector<int64_t> getSplitSizes(int64_t size, unsigned int into, int64_t granularity) {
+            if((into == 0) || (size < (int64_t)into)) {
+                return std::vector<int64_t>();
+            }
 
-            if(loc == 0) {
-                C_switch = C / into;
-            } else if(loc == 1) {
-                N_switch = N / into;
-            } else if(loc == 2) {
-                M_switch = M / into;
-            }
-
-            //if(initialShape.getElementType().isF32()) { // TODO more types
-            if(initialShape.getDtype().isF32()) { // TODO more types  NOLF NEED CHECK 
-                std::vector<std::vector<APFloat>> vects;
-                for(unsigned int i = 0; i < into; i++) {
-                    vects.push_back(std::vector<APFloat>());
-                }
+            if((granularity <= 0) || ((size / granularity) < (int64_t)into)) {
+                granularity = 1;
+            }
 
-                uint64_t i = 0;
-                for(auto it =  at.value_begin<APFloat>(); it != at.value_end<APFloat>(); it++) {
-                    //llvm::outs() << "Got this value: ";
-                    //(*it).print(llvm::outs());
-                    uint64_t loc_c = i / (M * N);
-                    uint64_t loc_N = (i / M) % N;
-                    uint64_t loc_M = i % M;
+            int64_t blocks = size / granularity;
+            int64_t tail = size % granularity;
 
-                    uint64_t vectsId = std::max(std::max(loc_c / C_switch, loc_N / N_switch),
-                                                loc_M / M_switch);
+            std::vector<int64_t> sizes;
+            for(unsigned int i = 0; i < into; i++) {
+                int64_t locBlocks = blocks / into + (((int64_t)i < (blocks % into)) ? 1 : 0);
+                sizes.push_back(locBlocks * granularity);
+            }
 
-                    vects.at(vectsId).push_back(*it);
-                    i++;
-                }
+            sizes.back() += tail;
 
-                for(uint64_t i = 0; i < into; i++) {
-                    assert(vects.at(i).size() == (size_t)(at.getType().getNumElements() / into));
-                }
+            return sizes;
+        }
 
-                mlir::torch::Torch::BaseTensorType ttype = breakShapeInto(initialShape, loc, into);
+        // Closed form of the largest part of getSplitSizes, the first parts get the extra blocks and the last one the tail
+        int64_t getMaxSplitSize(int64_t size, unsigned int into, int64_t granularity) {
+            if((into == 0) || (size < (int64_t)into)) {
+                return std::min(size, (int64_t)1);
+            }
 
-                for(uint64_t i = 0; i < into; i++) {
-                    DenseElementsAttr attr = DenseElementsAttr::get(ttype, vects.at(i));
-                    Operation* cst = builder.create<mlir::arith::ConstantOp>(builder.getUnknownLoc(), ttype, attr);
-                    ops.push_back(cst->getResult(0));
-                }
+            if((granularity <= 0) || ((size / granularity) < (int64_t)into)) {
+                granularity = 1;
             }
-        }
 
-        // Splits weights into according to dim given by loc
-        void splitConstantWeightsInto(mlir::arith::ConstantOp op, std::vector<Value> &ops, OpBuilder &builder, unsigned int loc,
-                                  DenseElementsAttr at, unsigned int into) {
-            mlir::torch::Torch::BaseTensorType initialShape = at.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>(); // NOLF NEED CHECK
-            ArrayRef<int64_t> s = initialShape.getSizes();
+            int64_t blocks = size / granularity;
+            int64_t tail = size % granularity;
 
-            uint64_t COut = s[COUT_LOC];
-            uint64_t CIn = s[CIN_LOC];
-            uint64_t F0 = s[F0_LOC];
-            uint64_t F1 = s[F1_LOC];
+            int64_t first = ceilDiv(blocks, into) * granularity;
+            int64_t last = (blocks / into) * granularity + tail;
 
-            uint64_t COut_switch = COut;
-            uint64_t CIn_switch = CIn;
-            uint64_t F0_switch = F0;
-            uint64_t F1_switch = F1;
+            return std::max(first, last);
+        }
 
-            if(loc == 0) {
-                COut_switch = COut / into;
-            } else if(loc == 1) {
-                CIn_switch = CIn / into;
-            } else if(loc == 2) {
-                F0_switch = F0 / into;
-            } else if(loc == 3) {
-                F1_switch = F1 / into;
-            }
-
-            //if(initialShape.getElementType().isF32()) { // TODO is this the only choice?
-            if(initialShape.getDtype().isF32()) { // TODO more types  NOLF NEED CHECK 
-                std::vector<std::vector<APFloat>> vects;
-                for(unsigned int i = 0; i < into; i++) {
-                    vects.push_back(std::vector<APFloat>());
+        // Bytes per element in the raw buffer of a dense attribute, 0 if elements are not byte addressable
+        uint64_t rawElementBytes(Type elementType) {
+            if(elementType.isa<IntegerType>() || elementType.isa<FloatType>()) {
+                unsigned int width = elementType.getIntOrFloatBitWidth();
+                if((width % 8) == 0) {
+                    return width / 8;
                 }
+            }
 
-                uint64_t i = 0;
-                for(auto it =  at.value_begin<APFloat>(); it != at.value_end<APFloat>(); it++) {
-                    //llvm::outs() << "Got this value: ";
-                    //(*it).print(llvm::outs());
+            return 0;
+        }
 
-                    uint64_t loc_cout = i / (F0 * F1 * CIn);
-                    uint64_t loc_cin = (i / (F0 * F1)) % CIn;
-                    uint64_t loc_F0 = (i / F1) % F0;
-                    uint64_t loc_F1 = i % F1;
+        // Copies the region of at starting at offsets of shape sizes from the raw buffer
+        // Trailing dimensions taken whole are contiguous with the first partial one before them,
+        // so the region is copied as runs of that size
+        // Null when the elements are not byte addressable, this runs in the workers of xten-materialize-slices
+        DenseElementsAttr sliceDense(DenseElementsAttr at, ArrayRef<int64_t> offsets, ArrayRef<int64_t> sizes) {
+            ArrayRef<int64_t> shape = at.getType().getShape();
+            uint64_t elemBytes = rawElementBytes(at.getType().getElementType());
+            if(elemBytes == 0) {
+                return DenseElementsAttr();
+            }
 
-                    uint64_t vectsId = std::max(std::max(loc_cout / COut_switch, loc_cin / CIn_switch),
-                                                std::max(loc_F0 / F0_switch, loc_F1 / F1_switch));
+            RankedTensorType type = RankedTensorType::get(sizes, at.getType().getElementType());
+            ArrayRef<char> raw = at.getRawData();
+            if(at.isSplat()) {
+                return DenseElementsAttr::getFromRawBuffer(type, raw);
+            }
 
-                    vects.at(vectsId).push_back(*it);
-                    i++;
-                }
+            uint64_t rank = shape.size();
+            assert((rank > 0) && (offsets.size() == rank) && (sizes.size() == rank));
+
+            std::vector<uint64_t> strides(rank, elemBytes);
+            for(int64_t d = (int64_t)rank - 2; d >= 0; d--) {
+                strides[d] = strides[d+1] * shape[d+1];
+            }
+
+            uint64_t d = rank - 1;
+            while((d > 0) && (sizes[d] == shape[d])) {
+                d--;
+            }
+
+            uint64_t run = sizes[d] * strides[d];
+            uint64_t numRuns = 1;
+            for(uint64_t i = 0; i < d; i++) {
+                numRuns *= sizes[i];
+            }
 
-                for(uint64_t i = 0; i < into; i++) {
-                    assert(vects.at(i).size() == (size_t)(at.getType().getNumElements() / into));
+            std::vector<char> buffer(numRuns * run);
+            std::vector<int64_t> idx(d, 0);
+            for(uint64_t r = 0; r < numRuns; r++) {
+                uint64_t src = offsets[d] * strides[d];
+                for(uint64_t i = 0; i < d; i++) {
+                    src += (offsets[i] + idx[i]) * strides[i];
                 }
 
-                mlir::torch::Torch::BaseTensorType ttype = breakShapeInto(initialShape, loc, into);
+                std::memcpy(buffer.data() + r * run, raw.data() + src, run);
 
-                for(uint64_t i = 0; i < into; i++) {
-                    DenseElementsAttr attr = DenseElementsAttr::get(ttype, vects.at(i));
-                    Operation* cst = builder.create<mlir::arith::ConstantOp>(builder.getUnknownLoc(), ttype, attr);
-                    ops.push_back(cst->getResult(0));
+                for(int64_t i = (int64_t)d - 1; i >= 0; i--) {
+                    if(++idx[i] < sizes[i]) {
+                        break;
+                    }
+                    idx[i] = 0;
                 }
             }
+
+            return DenseElementsAttr::getFromRawBuffer(type, buffer);
         }
 
-        // loc = 0 split
-        // loc > 0 generate some other 0 biases
-        void splitConstantBiasInto(mlir::arith::ConstantOp op, std::vector<Value> &ops, OpBuilder &builder, unsigned int loc, DenseElementsAttr at, unsigned int into) {
-            mlir::torch::Torch::BaseTensorType initialShape = at.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>(); // NOLF NEED CHECK
-            //if(initialShape.getElementType().isF32()) { // TODO extend to more types
-            if(initialShape.getDtype().isF32()) {
-                std::vector<std::vector<APFloat>> vects;
-                for(unsigned int i = 0; i < into; i++) {
-                    vects.push_back(std::vector<APFloat>());
-                }
+        // Constant v refers to and where in it, v being either the constant or a slice of it
+        // The constant is an arith.constant or a torch.vtensor.literal, see getConstantData
+        bool getConstantSlice(Value v, Value &root, std::vector<int64_t> &offsets) {
+            if(getConstantData(v)) {
+                root = v;
+                offsets = std::vector<int64_t>(v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes().size(), 0);
+                return true;
+            }
 
-                uint64_t i = 0;
-                for(auto it =  at.value_begin<APFloat>(); it != at.value_end<APFloat>(); it++) {
-                    if(loc == 0) {
-                        unsigned int index = i / (at.getType().getNumElements() / into);
-                        vects.at(index).push_back(*it);
-                    } else {
-                        vects.at(0).push_back(*it);
-                        // NOTE assume that same kernel with 0 bias from the compiler point of view
-                        // NOTE create duplicate constants here
-                        for(unsigned int j = 1; j < into; j++) {
-                            vects.at(j).push_back(APFloat((float)0));
-                        }
+            if(auto slice = v.getDefiningOp<SliceOp>()) {
+                if(getConstantData(slice.input())) {
+                    root = slice.input();
+                    offsets.clear();
+                    for(Attribute attr : slice.offsets()) {
+                        offsets.push_back(attr.cast<IntegerAttr>().getInt());
                     }
-                    i++;
+                    return true;
                 }
+            }
 
-                for(uint64_t i = 0; i < vects.size(); i++) {
-                    assert(vects.at(i).size() == (size_t)((loc == 0) ? at.getType().getNumElements() / into : at.getType().getNumElements()));
-                }
+            return false;
+        }
 
-                // now splitted the dense in into parts, need to regenerate it
-                mlir::torch::Torch::BaseTensorType ttype;
-                if(loc == 0) {
-                    ttype = breakShapeInto(initialShape, 0, into);
-                } else {
-                    ttype = initialShape;
-                }
+        DenseElementsAttr materializeSlice(SliceOp slice) {
+            Value root;
+            std::vector<int64_t> offsets;
+            if(!getConstantSlice(slice.getResult(), root, offsets)) {
+                return DenseElementsAttr();
+            }
 
-                for(uint64_t i = 0; i < into; i++) {
-                    DenseElementsAttr attr = DenseElementsAttr::get(ttype, vects.at(i));
-                    Operation* cst = builder.create<mlir::arith::ConstantOp>(builder.getUnknownLoc(), ttype, attr);
-                    ops.push_back(cst->getResult(0));
-                }
+            ArrayRef<int64_t> sizes = slice.getResult().getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes();
+            return sliceDense(getConstantData(root), offsets, sizes);
+        }
+
+        // Emits one slice of the underlying constant per part of v along dim, slices of slices
+        // are folded so that every slice refers to the original constant
+        void sliceConstantAlong(Value v, std::vector<Value> &ops, OpBuilder &builder, unsigned int dim, std::vector<int64_t> &sizes) {
+            Value root;
+            std::vector<int64_t> offsets;
+            bool isConst = getConstantSlice(v, root, offsets);
+            assert(isConst);
+
+            mlir::torch::Torch::BaseTensorType initialShape = v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            for(int64_t size : sizes) {
+                mlir::torch::Torch::BaseTensorType ttype = resizeShapeAt(initialShape, dim, size);
+                Operation* slice = builder.create<SliceOp>(builder.getUnknownLoc(), ttype, root, builder.getI64ArrayAttr(offsets));
+                ops.push_back(slice->getResult(0));
+                offsets[dim] += size;
+            }
+        }
+
+        // loc = 0 splits C, loc = 1 splits N and loc = 2 splits M
+        void sliceConstantActivationsInto(Value v, std::vector<Value> &ops, OpBuilder &builder, unsigned int loc, unsigned int into) {
+            ArrayRef<int64_t> s = v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes();
+
+            unsigned int dim = C_LOC + loc;
+            std::vector<int64_t> sizes = getSplitSizes(s[dim], into, (dim == C_LOC) ? CHANNEL_BLOCK : LINE_BLOCK);
+            sliceConstantAlong(v, ops, builder, dim, sizes);
+        }
+
+        // Splits weights into according to dim given by loc
+        void sliceConstantWeightsInto(Value v, std::vector<Value> &ops, OpBuilder &builder, unsigned int loc, unsigned int into) {
+            ArrayRef<int64_t> s = v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes();
+
+            bool channelDim = (loc == COUT_LOC) || (loc == CIN_LOC);
+            std::vector<int64_t> sizes = getSplitSizes(s[loc], into, channelDim ? CHANNEL_BLOCK : LINE_BLOCK);
+            sliceConstantAlong(v, ops, builder, loc, sizes);
+        }
+
+        // loc = 0 split
+        // loc > 0 generate some other 0 biases
+        void sliceConstantBiasInto(Value v, std::vector<Value> &ops, OpBuilder &builder, unsigned int loc, unsigned int into) {
+            mlir::torch::Torch::BaseTensorType initialShape = v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+
+            if(loc == 0) {
+                std::vector<int64_t> sizes = getSplitSizes(initialShape.getSizes()[0], into, CHANNEL_BLOCK);
+                sliceConstantAlong(v, ops, builder, 0, sizes);
+                return;
+            }
+
+            Value root;
+            std::vector<int64_t> offsets;
+            bool isConst = getConstantSlice(v, root, offsets);
+            assert(isConst);
+
+            Type elementType = getConstantData(root).getType().getElementType();
+            uint64_t elemBytes = rawElementBytes(elementType);
+            assert((elemBytes != 0) && "bias element types are checked by checkLayerOps");
+
+            // NOTE assume that same kernel with 0 bias from the compiler point of view
+            // Zero is all bits cleared for every int and float type, so one splat is shared by all other biases
+            std::vector<char> zero(elemBytes, 0);
+            RankedTensorType type = RankedTensorType::get(initialShape.getSizes(), elementType);
+            DenseElementsAttr zeros = DenseElementsAttr::getFromRawBuffer(type, zero);
+            Operation* cst = builder.create<mlir::arith::ConstantOp>(builder.getUnknownLoc(), initialShape, zeros);
+
+            std::vector<int64_t> whole = std::vector<int64_t>({initialShape.getSizes()[0]});
+            sliceConstantAlong(v, ops, builder, 0, whole);
+            for(unsigned int j = 1; j < into; j++) {
+                ops.push_back(cst->getResult(0));
             }
         }
 
@@ -248,34 +317,46 @@ namespace xilinx {
             return (unsigned int )-1;
         }
 
-        void splitConstantInto(mlir::arith::ConstantOp op, std::vector<Value> &ops, OpBuilder &builder, Split split, SplitType t, unsigned int into) {
-            for(NamedAttribute attr: op->getAttrs()) {
-                // We Look for the Dense Attribute
-                auto at = attr.getValue().dyn_cast<DenseElementsAttr>();
-                if(at) {
-                    if(t == bSplitType) {
-                        unsigned int splitDim = splitToDim(split, t);
-                        splitConstantBiasInto(op, ops, builder, splitDim, at, into);
-                    } else if(t == aSplitType) {
-                        unsigned int splitDim = splitToDim(split, t);
-                        if(splitDim == (unsigned int)-1) {
-                            // TODO maybe fail silently if top level is fine with that
-                            llvm::outs() << "Only Ca split is supported to split activation tensors";
-                            exit(1);
-                        } else {
-                            splitConstantActivationsInto(op, ops, builder, splitDim, at, into);
-                        }
-                    } else {
-                        unsigned int splitDim = splitToDim(split, t);
-                        splitConstantWeightsInto(op, ops, builder, splitDim, at, into);
-                    }
+        bool isConstantOrSlice(Value v) {
+            Value root;
+            std::vector<int64_t> offsets;
+            return getConstantSlice(v, root, offsets);
+        }
+
+        DenseElementsAttr getConstantData(Value v) {
+            Operation* def = v.getDefiningOp();
+            if(def == nullptr || !(llvm::isa<mlir::arith::ConstantOp>(def) || llvm::isa<mlir::torch::Torch::ValueTensorLiteralOp>(def))) {
+                return DenseElementsAttr();
+            }
+
+            return def->getAttrOfType<DenseElementsAttr>("value");
+        }
+
+        void sliceConstantInto(Value v, std::vector<Value> &ops, OpBuilder &builder, Split split, SplitType t, unsigned int into) {
+            unsigned int splitDim = splitToDim(split, t);
+            if(t == bSplitType) {
+                sliceConstantBiasInto(v, ops, builder, splitDim, into);
+            } else if(t == aSplitType) {
+                if(splitDim == (unsigned int)-1) {
+                    // TODO maybe fail silently if top level is fine with that
+                    llvm::outs() << "Only Ca split is supported to split activation tensors";
+                    exit(1);
+                } else {
+                    sliceConstantActivationsInto(v, ops, builder, splitDim, into);
                 }
+            } else {
+                sliceConstantWeightsInto(v, ops, builder, splitDim, into);
             }
         }
 
         void deleteOpsFrom(std::vector<Operation*> &ops) {
             for(unsigned int i = 0; i < ops.size(); i++) {
-                llvm::outs() << "Deleting.. " << i << "\n";
+                // Constants stay alive as long as slices refer to them
+                if(llvm::isa<mlir::arith::ConstantOp>(ops.at(i)) && !ops.at(i)->use_empty()) {
+                    continue;
+                }
+
+                LLVM_DEBUG(llvm::outs() << "Deleting.. " << i << "\n");
                 ops.at(i)->erase();
             }
             ops.clear();
@@ -289,15 +370,36 @@ namespace xilinx {
             ops.clear();
         }
 
-        // TODO double check shape propagation here
-        Operation* insertConcat(OpBuilder &builder, Value prevRes, std::vector<Value> &values, unsigned int dim, bool clearPrev) {
+        // Result shape is the sum of the values along dim, falls back to the shape of prevRes if unknown
+        mlir::torch::Torch::BaseTensorType concatShapeOf(Value prevRes, std::vector<Value> &values, unsigned int dim) {
             mlir::torch::Torch::BaseTensorType prevResType = prevRes.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
 
+            int64_t size = 0;
+            for(Value v : values) {
+                mlir::torch::Torch::BaseTensorType vType = v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                if(!vType || !vType.hasSizes() || (vType.getSizes()[dim] < 0)) {
+                    return prevResType;
+                }
+
+                size += vType.getSizes()[dim];
+            }
+
+            mlir::torch::Torch::BaseTensorType firstType = values.at(0).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            return resizeShapeAt(firstType, dim, size);
+        }
+
+        int64_t sizeAt(Value v, unsigned int dim) {
+            return v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>().getSizes()[dim];
+        }
+
+        Operation* insertConcat(OpBuilder &builder, Value prevRes, std::vector<Value> &values, unsigned int dim, bool clearPrev) {
+            mlir::torch::Torch::BaseTensorType resType = concatShapeOf(prevRes, values, dim);
+
             ArrayRef<Value> valuesRef = ArrayRef<Value>(values);
             ValueRange valuesRange(valuesRef);
 
             Operation* cstDim = builder.create<mlir::arith::ConstantIntOp>(builder.getUnknownLoc(), dim, 32);
-            Operation* res = builder.create<xilinx::xten::ConcatOp>(builder.getUnknownLoc(), prevResType, valuesRange, cstDim->getResult(0));
+            Operation* res = builder.create<xilinx::xten::ConcatOp>(builder.getUnknownLoc(), resType, valuesRange, cstDim->getResult(0));
             if(clearPrev) {
                 // Replace output of old convolution usage by concat value
                 prevRes.replaceAllUsesWith(res->getResult(0));
@@ -307,8 +409,19 @@ namespace xilinx {
         }
 
         void insertSplit(OpBuilder &builder, Value prevInput, std::vector<Value> &nInputs, unsigned int dim, unsigned int into) {
-            mlir::torch::Torch::BaseTensorType nShape = breakShapeInto(prevInput.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>(), dim, into);
-            std::vector<Type> shapes = std::vector<Type>(into, nShape);
+            int64_t size = sizeAt(prevInput, dim);
+            std::vector<int64_t> sizes = getSplitSizes(size, into, (dim == C_LOC) ? CHANNEL_BLOCK : LINE_BLOCK);
+            insertSplit(builder, prevInput, nInputs, dim, sizes);
+        }
+
+        void insertSplit(OpBuilder &builder, Value prevInput, std::vector<Value> &nInputs, unsigned int dim,
+                         std::vector<int64_t> &sizes) {
+            mlir::torch::Torch::BaseTensorType prevType = prevInput.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            std::vector<Type> shapes;
+            for(int64_t s : sizes) {
+                shapes.push_back(resizeShapeAt(prevType, dim, s));
+            }
+
             ArrayRef<Type> tShapes = ArrayRef<Type>(shapes);
 
             Operation* cstDim = builder.create<mlir::arith::ConstantIntOp>(builder.getUnknownLoc(), dim, 32);
@@ -319,82 +432,114 @@ namespace xilinx {
             }
         }
 
+        // Groups consecutive sizes in from so that each group sums to the matching entry of to
+        // Returns false if parts do not align
+        bool groupSizes(std::vector<int64_t> &from, std::vector<int64_t> &to, std::vector<unsigned int> &groups) {
+            unsigned int consumed = 0;
+            for(int64_t target : to) {
+                int64_t acc = 0;
+                unsigned int n = 0;
+                while((acc < target) && (consumed < from.size())) {
+                    acc += from.at(consumed);
+                    consumed++;
+                    n++;
+                }
+
+                if(acc != target) {
+                    return false;
+                }
+
+                groups.push_back(n);
+            }
+
+            return consumed == from.size();
+        }
+
         void replaceSplit(OpBuilder &builder, xilinx::xten::SplitOp split, std::vector<Value> &values,
                           std::vector<Operation*> &toDelete, unsigned int dim) {
             unsigned int into = values.size();
-            llvm::outs() << "Split number of operands: " << split.getNumOperands() << "\n";
-            if(split.getNumResults() == into) {
-                for(unsigned int i = 0; i < into; i++) {
-                    split.getResult(i).replaceAllUsesWith(values.at(i));
-                }
+            LLVM_DEBUG(llvm::outs() << "Split number of operands: " << split.getNumOperands() << "\n");
 
-                // Delete split
-                toDelete.push_back(split);
-            } else {
-                unsigned int splitResults = split.getNumResults();
-                unsigned int resPerConv = splitResults / into;
-                unsigned int rem = splitResults % into;
-
-                unsigned int consumed = 0;
-                for(unsigned int i = 0; i < into; i++) {
-                    unsigned int shouldHandle = resPerConv + ((i > rem ) ? 1 : 0);
-                    if(shouldHandle == 1) {
-                        split.getResult(consumed).replaceAllUsesWith(values.at(i));
+            std::vector<int64_t> splitSizes;
+            for(Value v : split.getResults()) {
+                splitSizes.push_back(sizeAt(v, dim));
+            }
+
+            std::vector<int64_t> valuesSizes;
+            for(Value v : values) {
+                valuesSizes.push_back(sizeAt(v, dim));
+            }
+
+            // Each new value must cover a whole number of split results, otherwise keep the split
+            // and feed it with the concatenation of the new values
+            std::vector<unsigned int> groups;
+            if(!groupSizes(splitSizes, valuesSizes, groups)) {
+                Operation* concat = insertConcat(builder, split.input(), values, dim, false);
+                split->replaceUsesOfWith(split.input(), concat->getResult(0));
+                return;
+            }
+
+            unsigned int consumed = 0;
+            for(unsigned int i = 0; i < into; i++) {
+                unsigned int shouldHandle = groups.at(i);
+                if(shouldHandle == 1) {
+                    split.getResult(consumed).replaceAllUsesWith(values.at(i));
+                    consumed++;
+                } else {
+                    std::vector<int64_t> locSizes(splitSizes.begin() + consumed, splitSizes.begin() + consumed + shouldHandle);
+                    std::vector<Value> locRes;
+                    insertSplit(builder, values.at(i), locRes, dim, locSizes);
+                    for(unsigned int j = 0; j < shouldHandle; j++) {
+                        split.getResult(consumed).replaceAllUsesWith(locRes.at(j));
                         consumed++;
-                    } else {
-                        ArrayRef<Value> af = ArrayRef<Value>(values);
-                        Operation* cstDim = builder.create<mlir::arith::ConstantIntOp>(builder.getUnknownLoc(), dim, 32);
-                        Operation* splitOp = builder.create<xilinx::xten::SplitOp>(builder.getUnknownLoc(), TypeRange(af), values.at(i), cstDim->getResult(0));
-                        for(unsigned int j = 0; j < shouldHandle; j++) {
-                            split.getResult(consumed).replaceAllUsesWith(splitOp->getResult(j));
-                            consumed++;
-                        }
                     }
                 }
-
-                toDelete.push_back(split);
             }
 
+            toDelete.push_back(split);
         }
 
         void replaceConcat(OpBuilder &builder, xilinx::xten::ConcatOp concat, std::vector<Value> &nInputs,
                            std::vector<Operation*> &toDelete, unsigned int dim, unsigned int into) {
-            if(into == (concat.getNumOperands() - 1)) { // because there is the dim argument as well
-                for(unsigned int i = 0; i < into; i++) {
-                    nInputs.push_back(concat.getOperand(i));
-                }
+            std::vector<Value> concatInputs(concat.inputs().begin(), concat.inputs().end());
 
-                toDelete.push_back(concat);
-            } else {
-                unsigned int concatOperands = concat.getNumOperands();
-                unsigned int operandsPerConv = concatOperands / into;
-                unsigned int rem = concatOperands % into;
-
-                unsigned int consumed = 0;
-                for(unsigned int i = 0; i < into; i++) {
-                    unsigned int shouldHandle = operandsPerConv + ((i > rem) ? 1 : 0);
-                    if(shouldHandle == 1) {
-                        nInputs.push_back(concat.getOperand(consumed));
-                        consumed++;
-                    } else {
-                        mlir::torch::Torch::BaseTensorType opShape = concat.getOperand(consumed).getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
-                        Type nShape = mergeShapeInto(opShape, 0, shouldHandle);
-                        std::vector<Value> values;
+            std::vector<int64_t> concatSizes;
+            for(Value v : concatInputs) {
+                concatSizes.push_back(sizeAt(v, dim));
+            }
 
-                        for(unsigned int j = 0; j < shouldHandle; j++) {
-                            values.push_back(concat.getOperand(consumed));
-                            consumed++;
-                        }
+            int64_t total = 0;
+            for(int64_t s : concatSizes) {
+                total += s;
+            }
 
-                        ArrayRef<Value> af = ArrayRef<Value>(values);
+            std::vector<int64_t> sizes = getSplitSizes(total, into, (dim == C_LOC) ? CHANNEL_BLOCK : LINE_BLOCK);
 
-                        Operation* cstDim = builder.create<mlir::arith::ConstantIntOp>(builder.getUnknownLoc(), dim, 32);
-                        Operation* res = builder.create<xilinx::xten::ConcatOp>(builder.getUnknownLoc(), nShape, ValueRange(af), cstDim->getResult(0));
+            // Concat operands do not line up with the wanted partition, split the concatenated value instead
+            std::vector<unsigned int> groups;
+            if(!groupSizes(concatSizes, sizes, groups)) {
+                insertSplit(builder, concat.getResult(), nInputs, dim, sizes);
+                return;
+            }
 
-                        nInputs.push_back(res->getResult(0));
-                    }
+            unsigned int consumed = 0;
+            for(unsigned int i = 0; i < into; i++) {
+                unsigned int shouldHandle = groups.at(i);
+                if(shouldHandle == 1) {
+                    nInputs.push_back(concatInputs.at(consumed));
+                    consumed++;
+                } else {
+                    std::vector<Value> values(concatInputs.begin() + consumed, concatInputs.begin() + consumed + shouldHandle);
+                    consumed += shouldHandle;
+
+                    Operation* res = insertConcat(builder, concat.getResult(), values, dim, false);
+                    nInputs.push_back(res->getResult(0));
                 }
             }
+
+            if(concat.getResult().hasOneUse()) {
+                toDelete.push_back(concat);
+            }
         }
 
         unsigned int getAttrOrDefault(Operation* op, std::string attrName, unsigned int defVal) {
@@ -405,14 +550,286 @@ namespace xilinx {
             }
         }
 
+        AbsOpWrapper* opToWrapper(Operation* op) {
+            if(auto conv = llvm::dyn_cast<Conv2dReLUOp>(op)) {
+                return new Conv2dReLUOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<PartialConv2dReLUOp>(op)) {
+                return new PartialConv2dReLUOpWrapper(conv);
+            } else if(auto maxpool = llvm::dyn_cast<torch::Torch::AtenMaxPool2dOp>(op)) {
+                return new MaxPool2dOpWrapper(maxpool);
+            } else if(auto conv = llvm::dyn_cast<Conv2dOp>(op)) {
+                return new Conv2dOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<PartialConv2dOp>(op)) {
+                return new PartialConv2dOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<Conv2dBatchNormReLUOp>(op)) {
+                return new Conv2dBatchNormReLUOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<PartialConv2dBatchNormReLUOp>(op)) {
+                return new PartialConv2dBatchNormReLUOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<Conv2dBatchNormOp>(op)) {
+                return new Conv2dBatchNormOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<PartialConv2dBatchNormOp>(op)) {
+                return new PartialConv2dBatchNormOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<Conv2dBatchNormAddReLUOp>(op)) {
+                return new Conv2dBatchNormAddReLUOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<PartialConv2dBatchNormAddReLUOp>(op)) {
+                return new PartialConv2dBatchNormAddReLUOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<Conv2dHardswishOp>(op)) {
+                return new Conv2dHardswishOpWrapper(conv);
+            } else if(auto conv = llvm::dyn_cast<PartialConv2dHardswishOp>(op)) {
+                return new PartialConv2dHardswishOpWrapper(conv);
+            } else if(auto mm = llvm::dyn_cast<MMOp>(op)) {
+                return new MMOpWrapper(mm);
+            } else if(auto linear = llvm::dyn_cast<LinearReLUOp>(op)) {
+                return new LinearReLUOpWrapper(linear);
+            } else if(auto add = llvm::dyn_cast<AddOp>(op)) {
+                return new AddOpWrapper(add);
+            } else if(auto mul = llvm::dyn_cast<MulOp>(op)) {
+                return new MulOpWrapper(mul);
+            } else {
+                op->emitError("Unsupported operation in the dataflow graph");
+                return nullptr;
+            }
+        }
+
+        // Ca and L splits give zero biases to all but the first op of a chain, built on the raw buffer of the bias
+        LogicalResult checkLayerOps(func::FuncOp graph) {
+            bool supported = true;
+            graph.walk([&](Operation *op) {
+                    if(op->getAttr("layer_name") != nullptr) {
+                        AbsOpWrapper* wrapped = opToWrapper(op);
+                        supported = supported && (wrapped != nullptr);
+
+                        Value root;
+                        std::vector<int64_t> offsets;
+                        if(wrapped != nullptr && wrapped->hasBias() && getConstantSlice(*wrapped->getBiases(), root, offsets)) {
+                            Type elementType = getConstantData(root).getType().getElementType();
+                            if(rawElementBytes(elementType) == 0) {
+                                op->emitError("Unsupported bias element type in the dataflow graph: ") << elementType;
+                                supported = false;
+                            }
+                        }
+
+                        delete wrapped;
+                    }
+                });
+
+            return success(supported);
+        }
+
+        void sliceQuantAttr(Operation* op, int64_t offset, int64_t size) {
+            DictionaryAttr quant = op->getAttrOfType<DictionaryAttr>(QUANT_ATTR);
+            if(!quant) {
+                return;
+            }
+
+            ArrayAttr scales = quant.getAs<ArrayAttr>("weight_scales");
+            assert(scales && ((offset + size) <= (int64_t)scales.size()));
+
+            std::vector<Attribute> nScales(scales.begin() + offset, scales.begin() + offset + size);
+
+            Builder builder(op->getContext());
+            std::vector<NamedAttribute> attrs;
+            for(NamedAttribute attr : quant) {
+                if(attr.getName() == "weight_scales") {
+                    attrs.push_back(builder.getNamedAttr("weight_scales", builder.getArrayAttr(nScales)));
+                } else {
+                    attrs.push_back(attr);
+                }
+            }
+
+            op->setAttr(QUANT_ATTR, builder.getDictionaryAttr(attrs));
+        }
+
+        // Only the last op of a chain rescales its sum to int8, the others pass on the int32 sums
+        Type getPartialResultType(Operation* op, Type resultType) {
+            mlir::torch::Torch::BaseTensorType tensorType = resultType.dyn_cast<mlir::torch::Torch::BaseTensorType>();
+            if(op->getAttr(QUANT_ATTR) == nullptr || !tensorType) {
+                return resultType;
+            }
+
+            Type accType = IntegerType::get(op->getContext(), 32, IntegerType::Signed);
+            return tensorType.getWithSizesAndDtype(tensorType.getSizes(), accType);
+        }
+
+        void setDataflowAttr(Operation* op, ModelParams &params, uint64_t computeTime, uint64_t totalTimePerTile, uint64_t totalTime) {
+            Builder builder(op->getContext());
+            std::vector<NamedAttribute> attrs;
+
+            attrs.push_back(builder.getNamedAttr("P", builder.getI64IntegerAttr(params.P)));
+            attrs.push_back(builder.getNamedAttr("Ca", builder.getI64IntegerAttr(params.Ca)));
+            attrs.push_back(builder.getNamedAttr("L", builder.getI64IntegerAttr(params.L)));
+            attrs.push_back(builder.getNamedAttr("W", builder.getI64IntegerAttr(params.W)));
+            attrs.push_back(builder.getNamedAttr("lineGranularity", builder.getBoolAttr(params.lineGranularity)));
+            attrs.push_back(builder.getNamedAttr("computeTime", builder.getI64IntegerAttr(computeTime)));
+            attrs.push_back(builder.getNamedAttr("totalTimePerTile", builder.getI64IntegerAttr(totalTimePerTile)));
+            attrs.push_back(builder.getNamedAttr("totalTime", builder.getI64IntegerAttr(totalTime)));
+
+            op->setAttr(DATAFLOW_ATTR, builder.getDictionaryAttr(attrs));
+        }
+
+        bool getDataflowAttr(Operation* op, ModelParams &params) {
+            auto dict = op->getAttrOfType<DictionaryAttr>(DATAFLOW_ATTR);
+            if(!dict) {
+                return false;
+            }
+
+            auto P = dict.getAs<IntegerAttr>("P");
+            auto Ca = dict.getAs<IntegerAttr>("Ca");
+            auto L = dict.getAs<IntegerAttr>("L");
+            auto W = dict.getAs<IntegerAttr>("W");
+            auto lineGranularity = dict.getAs<BoolAttr>("lineGranularity");
+            if(!P || !Ca || !L || !W || !lineGranularity) {
+                return false;
+            }
+
+            params = ModelParams(P.getInt(), Ca.getInt(), L.getInt(), W.getInt(), lineGranularity.getValue());
+            return params.nonZero();
+        }
+
         void printOperationLoc(Operation* op) {
             unsigned int locCa = getAttrOrDefault(op, "locCa", 0);
             unsigned int locL = getAttrOrDefault(op, "locL", 0);
             unsigned int locW = getAttrOrDefault(op, "locW", 0);
             unsigned int locP = getAttrOrDefault(op, "locP", 0);
 
-            llvm::outs() << "Op is at: P: " << locP << ", Ca: " << locCa << ", W: " << locW << ", L: " << locL << "\n";
+            LLVM_DEBUG(llvm::outs() << "Op is at: P: " << locP << ", Ca: " << locCa << ", W: " << locW << ", L: " << locL << "\n");
+        }
+
+        std::string getOpLabel(Operation* op) {
+            std::string label = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+            for(std::string loc : {"locP", "locCa", "locL", "locW"}) {
+                label += "_" + std::to_string(getAttrOrDefault(op, loc, 0));
+            }
+
+            return label;
+        }
+
+        LogicalResult writeReport(std::string filename, std::string report, Location loc) {
+            if(filename == "-") {
+                llvm::outs() << report;
+                return success();
+            }
+
+            std::error_code EC;
+            llvm::raw_fd_ostream reportStream(filename, EC);
+            if(EC) {
+                emitError(loc, "Cannot open " + filename + ": " + EC.message());
+                return failure();
+            }
+
+            reportStream << report;
+            return success();
+        }
+
+        PhaseTimer::PhaseTimer(AnalysisManager am, Operation* op, const char* name) {
+            this->instrumentor = am.getPassInstrumentor();
+            this->op = op;
+            this->name = name;
+
+            if(this->instrumentor != nullptr) {
+                this->instrumentor->runBeforeAnalysis(name, TypeID::getFromOpaquePointer(name), op);
+            }
+        }
+
+        PhaseTimer::~PhaseTimer() {
+            if(this->instrumentor != nullptr) {
+                this->instrumentor->runAfterAnalysis(this->name, TypeID::getFromOpaquePointer(this->name), this->op);
+            }
+        }
+
+        void findProducerOps(Value v, llvm::SmallSetVector<Operation*, 4> &producers) {
+            Operation* def = v.getDefiningOp();
+            if(def == nullptr) {
+                return;
+            }
+
+            if(def->getAttr("layer_name") != nullptr) {
+                producers.insert(def);
+            } else if(auto concat = llvm::dyn_cast<ConcatOp>(def)) {
+                for(Value in : concat.inputs()) {
+                    findProducerOps(in, producers);
+                }
+            } else if(llvm::isa<SplitOp>(def) || llvm::isa<SliceOp>(def) || llvm::isa<NoOp>(def)) {
+                findProducerOps(def->getOperand(0), producers);
+            }
+        }
+    
+        std::vector<Operation*> getLayersInTopologicalOrder(func::FuncOp graph, std::vector<std::vector<uint64_t>> &producers) {
+            std::vector<Operation*> layers;
+            llvm::DenseMap<Operation*, uint64_t> layerToIndex;
+            graph.walk([&](Operation *op) {
+                    if(op->getAttr("layer_name") != nullptr) {
+                        layerToIndex[op] = layers.size();
+                        layers.push_back(op);
+                    }
+                });
+
+            // Layers read by each layer, through any op that is not a layer
+            std::vector<llvm::SmallSetVector<uint64_t, 4>> ins(layers.size());
+            std::vector<std::vector<uint64_t>> outs(layers.size());
+            for(uint64_t i = 0; i < layers.size(); i++) {
+                llvm::SmallPtrSet<Operation*, 16> visited;
+                std::vector<Value> worklist(layers.at(i)->getOperands().begin(), layers.at(i)->getOperands().end());
+                while(!worklist.empty()) {
+                    Operation* def = worklist.back().getDefiningOp();
+                    worklist.pop_back();
+
+                    if(def == nullptr || !visited.insert(def).second) {
+                        continue;
+                    }
+
+                    auto layer = layerToIndex.find(def);
+                    if(layer != layerToIndex.end()) {
+                        if(ins.at(i).insert(layer->second)) {
+                            outs.at(layer->second).push_back(i);
+                        }
+                    } else {
+                        worklist.insert(worklist.end(), def->getOperands().begin(), def->getOperands().end());
+                    }
+                }
+            }
+
+            // Kahn's algorithm, always releasing the earliest layer of the graph that is ready
+            std::vector<uint64_t> pending(layers.size());
+            std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> ready;
+            for(uint64_t i = 0; i < layers.size(); i++) {
+                pending.at(i) = ins.at(i).size();
+                if(pending.at(i) == 0) {
+                    ready.push(i);
+                }
+            }
+
+            std::vector<uint64_t> order;
+            std::vector<uint64_t> indexToPos(layers.size());
+            while(!ready.empty()) {
+                uint64_t i = ready.top();
+                ready.pop();
+
+                indexToPos.at(i) = order.size();
+                order.push_back(i);
+                for(uint64_t next : outs.at(i)) {
+                    pending.at(next)--;
+                    if(pending.at(next) == 0) {
+                        ready.push(next);
+                    }
+                }
+            }
+
+            assert(order.size() == layers.size() && "SSA graph of the layers has a cycle");
+
+            std::vector<Operation*> sorted;
+            producers.clear();
+            for(uint64_t i : order) {
+                sorted.push_back(layers.at(i));
+
+                std::vector<uint64_t> layerProducers;
+                for(uint64_t in : ins.at(i)) {
+                    layerProducers.push_back(indexToPos.at(in));
+                }
+                producers.push_back(layerProducers);
+            }
+
+            return sorted;
         }
     }
 }
-
@@ -0,0 +1,320 @@
+//===- XTenEmitGraphPass.cpp ------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+#include "xten/Dialect/XTen/XTenEmitGraphPass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowExplorer.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-emit-graph-pass"
+
+using namespace mlir;
+
+// Describes the expanded graph as the kernel graph the hardware flow instantiates:
+// one kernel per expanded op with its type, location, tile parameters and buffer sizes, and the
+// connections between kernels, graph inputs and graph outputs. Concat, split and slice ops are
+// only routing, so connections go from the ops producing the data to the ops consuming it.
+// A partial input fed directly by its producer is a cascade, weights, biases and BN parameters
+// coming from the graph inputs are weights connections and everything else is a stream.
+// Kernels reading the same value from the same source, like the W replicas of a layer and their
+// shared weights, are fed by a single broadcast connection listing all of them.
+// The core and banks of each kernel are included when xten-place-cores and xten-allocate-banks ran.
+
+namespace xilinx {
+    namespace xten {
+        class GraphConnection {
+        public:
+            std::string from;
+            std::vector<std::string> to;
+            std::string kind;
+            uint64_t bytes;
+        };
+
+        struct XTenEmitGraphPass : public XTenEmitGraphBase<XTenEmitGraphPass> {
+        public:
+            Option<std::string> graphFilename{*this, "graph-file",
+                                              llvm::cl::desc("Write the kernel graph to this file, \"-\" for stdout"),
+                                              llvm::cl::init("-")};
+
+            Statistic numKernels{this, "kernels", "Number of kernels in the graph"};
+            Statistic numConnections{this, "connections", "Number of connections in the graph"};
+
+            XTenEmitGraphPass() {}
+            XTenEmitGraphPass(const XTenEmitGraphPass &pass) {}
+
+            // Bytes of a tensor value, 0 when its shape or element type is unknown
+            uint64_t tensorBytes(Value v) {
+                auto type = v.getType().dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                if(!type || !type.hasSizes() || !type.hasDtype()) {
+                    return 0;
+                }
+
+                uint64_t bytes = rawElementBytes(type.getDtype());
+                for(int64_t size : type.getSizes()) {
+                    bytes *= (size < 0) ? 0 : size;
+                }
+
+                return bytes;
+            }
+
+            // Graph inputs reaching v, seen through the concat, split and slice ops of the expansion
+            void findGraphInputs(Value v, llvm::SmallSetVector<Value, 4> &inputs) {
+                Operation* def = v.getDefiningOp();
+                if(def == nullptr) {
+                    inputs.insert(v);
+                } else if(auto concat = llvm::dyn_cast<ConcatOp>(def)) {
+                    for(Value in : concat.inputs()) {
+                        findGraphInputs(in, inputs);
+                    }
+                } else if(llvm::isa<SplitOp>(def) || llvm::isa<SliceOp>(def) || llvm::isa<NoOp>(def)) {
+                    findGraphInputs(def->getOperand(0), inputs);
+                }
+            }
+
+            // The data of source read as value by a kernel, or by a graph output
+            void addConnection(std::vector<GraphConnection> &connections, llvm::DenseMap<std::pair<Value, Value>, uint64_t> &sourceToConnection,
+                               Value source, std::string from, Value value, std::string to, std::string kind) {
+                std::pair<Value, Value> key = std::make_pair(source, value);
+                if(sourceToConnection.count(key) != 0) {
+                    connections.at(sourceToConnection[key]).to.push_back(to);
+                    return;
+                }
+
+                // A source only sends the part of its data that is read, so the smallest of the two
+                GraphConnection connection;
+                connection.from = from;
+                connection.to.push_back(to);
+                connection.kind = kind;
+                connection.bytes = std::min(this->tensorBytes(source), this->tensorBytes(value));
+
+                sourceToConnection[key] = connections.size();
+                connections.push_back(connection);
+            }
+
+            llvm::json::Value connectionJSON(GraphConnection &connection) {
+                llvm::json::Object connectionObj;
+                connectionObj["from"] = connection.from;
+                connectionObj["to"] = llvm::json::Array(connection.to);
+                connectionObj["kind"] = connection.kind;
+                connectionObj["bytes"] = (int64_t)connection.bytes;
+
+                numConnections++;
+                return llvm::json::Value(std::move(connectionObj));
+            }
+
+            std::string connectionKind(AbsOpWrapper* wrapped, Value operand) {
+                if(operand == wrapped->getPartialInput()) {
+                    return "cascade";
+                }
+
+                bool isWeights = wrapped->hasWeights() && (operand == wrapped->getWeights());
+                bool isBias = wrapped->hasBias() && (operand == *wrapped->getBiases());
+                bool isBN = wrapped->hasBN() && llvm::is_contained(wrapped->getBN(), operand);
+
+                return (isWeights || isBias || isBN) ? "weights" : "stream";
+            }
+
+            llvm::json::Value kernelJSON(Operation* op, DataflowExplorer &explorer, uint64_t id, ModelParams &params) {
+                ModelParams local(1, 1, 1, params.W, params.lineGranularity);
+                uint64_t bankSize = explorer.arch->getBankSize();
+
+                llvm::json::Object kernel;
+                kernel["name"] = getOpLabel(op);
+                kernel["kernel"] = op->getName().getStringRef().str();
+                kernel["layer"] = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+
+                llvm::json::Object loc;
+                loc["P"] = (int64_t)getAttrOrDefault(op, "locP", 0);
+                loc["Ca"] = (int64_t)getAttrOrDefault(op, "locCa", 0);
+                loc["L"] = (int64_t)getAttrOrDefault(op, "locL", 0);
+                loc["W"] = (int64_t)getAttrOrDefault(op, "locW", 0);
+                kernel["loc"] = llvm::json::Value(std::move(loc));
+
+                kernel["K"] = (int64_t)explorer.getK(id, local);
+                kernel["linesPerTile"] = (int64_t)explorer.getLinesPerTile(id, local);
+                kernel["tilesPerCore"] = (int64_t)explorer.getTilesPerCore(id, local);
+
+                BufferBanks banks = explorer.getLocalBufferBanks(id, params);
+                llvm::json::Object buffers;
+                buffers["weights"] = (int64_t)(banks.weights * bankSize);
+                buffers["input"] = (int64_t)(banks.input * bankSize);
+                buffers["forward"] = (int64_t)(banks.forward * bankSize);
+                buffers["output"] = (int64_t)(banks.output * bankSize);
+                kernel["buffers"] = llvm::json::Value(std::move(buffers));
+
+                if(auto core = op->getAttrOfType<ArrayAttr>(CORE_ATTR)) {
+                    llvm::json::Array coreJSON;
+                    for(Attribute c : core) {
+                        coreJSON.push_back(c.cast<IntegerAttr>().getInt());
+                    }
+                    kernel["core"] = llvm::json::Value(std::move(coreJSON));
+                }
+
+                if(auto banks = op->getAttrOfType<DictionaryAttr>(BANKS_ATTR)) {
+                    llvm::json::Object banksJSON;
+                    for(NamedAttribute buffer : banks) {
+                        llvm::json::Array bankIds;
+                        for(Attribute b : buffer.getValue().cast<ArrayAttr>()) {
+                            bankIds.push_back(b.cast<IntegerAttr>().getInt());
+                        }
+                        banksJSON[buffer.getName().getValue()] = llvm::json::Value(std::move(bankIds));
+                    }
+                    kernel["banks"] = llvm::json::Value(std::move(banksJSON));
+                }
+
+                numKernels++;
+                return llvm::json::Value(std::move(kernel));
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                auto graph = module.lookupSymbol<func::FuncOp>("forward");
+                if(!graph) {
+                    emitError(UnknownLoc::get(module.getContext()), "Cant find graph func\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                if(failed(checkLayerOps(graph))) {
+                    signalPassFailure();
+                    return;
+                }
+
+                // Expanded ops in topological order, the explorer works on the local shapes of the first op of each layer
+                std::vector<std::vector<uint64_t>> producers;
+                std::vector<Operation*> ops = getLayersInTopologicalOrder(graph, producers);
+
+                std::vector<std::pair<std::string, AbsOpWrapper*>> explorerInit;
+                std::map<std::string, uint64_t> layerNameToId;
+                for(Operation* op : ops) {
+                    std::string opName = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+                    if(layerNameToId.count(opName) == 0) {
+                        layerNameToId[opName] = explorerInit.size();
+                        explorerInit.push_back(std::make_pair(opName, opToWrapper(op)));
+                    }
+                }
+
+                DataflowExplorer explorer(explorerInit);
+
+                llvm::json::Array kernels;
+                std::vector<GraphConnection> connections;
+                llvm::DenseMap<std::pair<Value, Value>, uint64_t> sourceToConnection;
+                bool invalid = false;
+                for(Operation* op : ops) {
+                    ModelParams params;
+                    if(!getDataflowAttr(op, params)) {
+                        op->emitError("Missing or invalid " DATAFLOW_ATTR " attribute, run xten-annotate-dataflow first");
+                        invalid = true;
+                        break;
+                    }
+
+                    uint64_t id = layerNameToId[op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str()];
+                    kernels.push_back(this->kernelJSON(op, explorer, id, params));
+
+                    AbsOpWrapper* wrapped = opToWrapper(op);
+                    for(Value operand : op->getOperands()) {
+                        if(!operand.getType().isa<mlir::torch::Torch::BaseTensorType>()) {
+                            continue;
+                        }
+
+                        std::string kind = this->connectionKind(wrapped, operand);
+
+                        llvm::SmallSetVector<Operation*, 4> producers;
+                        findProducerOps(operand, producers);
+                        for(Operation* producer : producers) {
+                            this->addConnection(connections, sourceToConnection, producer->getResult(0), getOpLabel(producer),
+                                                operand, getOpLabel(op), kind);
+                        }
+
+                        llvm::SmallSetVector<Value, 4> inputs;
+                        this->findGraphInputs(operand, inputs);
+                        for(Value input : inputs) {
+                            std::string from = "arg" + std::to_string(input.cast<BlockArgument>().getArgNumber());
+                            this->addConnection(connections, sourceToConnection, input, from, operand, getOpLabel(op), kind);
+                        }
+                    }
+                    delete wrapped;
+                }
+
+                // Graph outputs
+                graph.walk([&](func::ReturnOp ret) {
+                        for(unsigned int i = 0; i < ret.getNumOperands(); i++) {
+                            llvm::SmallSetVector<Operation*, 4> producers;
+                            findProducerOps(ret.getOperand(i), producers);
+                            for(Operation* producer : producers) {
+                                this->addConnection(connections, sourceToConnection, producer->getResult(0), getOpLabel(producer),
+                                                    ret.getOperand(i), "out" + std::to_string(i), "stream");
+                            }
+                        }
+                    });
+
+                if(invalid) {
+                    signalPassFailure();
+                } else {
+                    llvm::json::Object arch;
+                    arch["rows"] = (int64_t)explorer.arch->getNumRows();
+                    arch["cols"] = (int64_t)explorer.arch->getNumCols();
+                    arch["banks"] = (int64_t)explorer.arch->getNumBanks();
+                    arch["bankSize"] = (int64_t)explorer.arch->getBankSize();
+
+                    llvm::json::Array connectionsJSON;
+                    for(GraphConnection &connection : connections) {
+                        connectionsJSON.push_back(this->connectionJSON(connection));
+                    }
+
+                    llvm::json::Object top;
+                    top["arch"] = llvm::json::Value(std::move(arch));
+                    top["kernels"] = llvm::json::Value(std::move(kernels));
+                    top["connections"] = llvm::json::Value(std::move(connectionsJSON));
+
+                    llvm::json::Value topv(std::move(top));
+                    std::string ret;
+                    llvm::raw_string_ostream ss(ret);
+                    ss << llvm::formatv("{0:2}", topv) << "\n";
+                    if(failed(writeReport(graphFilename, ss.str(), graph.getLoc()))) {
+                        signalPassFailure();
+                    }
+                }
+
+                for(auto &init : explorerInit) {
+                    delete init.second;
+                }
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenEmitGraphPass() {
+    return std::make_unique<XTenEmitGraphPass>();
+}
+
+} // namespace xten
+} // namespace xilinx
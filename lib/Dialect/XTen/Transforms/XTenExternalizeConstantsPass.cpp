@@ -0,0 +1,128 @@
+//===- XTenExternalizeConstantsPass.cpp -------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "xten/Dialect/XTen/XTenExternalizeConstantsPass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
+
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-externalize-constants-pass"
+
+using namespace mlir;
+
+// Moves the data of the large constants to a single binary file, each constant being replaced by an
+// xten.external_constant giving where its raw data starts in that file and how long it is.
+// Every constant starts at a multiple of the alignment so that the file can be mapped and each
+// constant used in place. Splats stay in the module as they are already small.
+// Slices of constants are only understood on top of arith.constant, so this runs after
+// xten-materialize-slices.
+
+namespace xilinx {
+    namespace xten {
+
+        struct XTenExternalizeConstantsPass : public XTenExternalizeConstantsBase<XTenExternalizeConstantsPass> {
+        public:
+            Option<std::string> blobFilename{*this, "blob",
+                                             llvm::cl::desc("File the data of the constants is written to"),
+                                             llvm::cl::init("")};
+
+            Option<unsigned> threshold{*this, "threshold",
+                                       llvm::cl::desc("Constants of at least that many bytes are moved to the file"),
+                                       llvm::cl::init(1024)};
+
+            Option<unsigned> alignment{*this, "alignment",
+                                       llvm::cl::desc("Alignment in bytes of each constant in the file"),
+                                       llvm::cl::init(64)};
+
+            Statistic numConstants{this, "constants", "Number of constants moved to the file"};
+            Statistic numBytes{this, "bytes", "Size of the file in bytes"};
+
+            XTenExternalizeConstantsPass() {}
+            XTenExternalizeConstantsPass(const XTenExternalizeConstantsPass &pass) {}
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                if(blobFilename == "" || alignment == 0) {
+                    emitError(module.getLoc(), "xten-externalize-constants needs a blob file and a non zero alignment");
+                    signalPassFailure();
+                    return;
+                }
+
+                std::vector<mlir::arith::ConstantOp> constants;
+                module.walk([&](mlir::arith::ConstantOp constOp) {
+                        DenseElementsAttr attr = constOp.getValue().dyn_cast<DenseElementsAttr>();
+                        if(!attr || attr.isSplat() || rawElementBytes(attr.getType().getElementType()) == 0) {
+                            return;
+                        }
+
+                        if(attr.getRawData().size() >= threshold) {
+                            constants.push_back(constOp);
+                        }
+                    });
+
+                std::error_code EC;
+                llvm::raw_fd_ostream blobStream(blobFilename, EC);
+                if(EC) {
+                    emitError(module.getLoc(), "Cannot open " + blobFilename + ": " + EC.message());
+                    signalPassFailure();
+                    return;
+                }
+
+                uint64_t offset = 0;
+                for(mlir::arith::ConstantOp constOp : constants) {
+                    ArrayRef<char> raw = constOp.getValue().cast<DenseElementsAttr>().getRawData();
+
+                    uint64_t padding = (alignment - (offset % alignment)) % alignment;
+                    blobStream.write_zeros(padding);
+                    offset += padding;
+
+                    blobStream.write(raw.data(), raw.size());
+
+                    OpBuilder builder(constOp);
+                    Operation* external = builder.create<ExternalConstantOp>(constOp.getLoc(), constOp.getResult().getType(),
+                                                                             builder.getI64IntegerAttr(offset),
+                                                                             builder.getI64IntegerAttr(raw.size()));
+                    constOp.getResult().replaceAllUsesWith(external->getResult(0));
+                    constOp.erase();
+
+                    offset += raw.size();
+                    numConstants++;
+                }
+
+                numBytes += offset;
+                module->setAttr(WEIGHTS_BLOB_ATTR, StringAttr::get(module.getContext(), blobFilename));
+
+                LLVM_DEBUG(llvm::outs() << "Wrote " << constants.size() << " constants, " << offset << " bytes\n");
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenExternalizeConstantsPass() {
+    return std::make_unique<XTenExternalizeConstantsPass>();
+}
+
+} // namespace xten
+} // namespace xilinx
@@ -0,0 +1,200 @@
+//===- XTenFoldBatchNormPass.cpp --------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+
+#include "xten/Dialect/XTen/XTenFoldBatchNormPass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+
+#include <cmath>
+#include <vector>
+
+#define DEBUG_TYPE "xten-fold-batchnorm-pass"
+
+using namespace mlir;
+
+// Folds the inference batch norm of conv2d_bn_relu and conv2d_bn into the weights and biases of the
+// convolution: with s = bn_weight / sqrt(running_var + eps), each output channel c gets weight * s[c]
+// and bias (bias - running_mean) * s[c] + bn_bias, and the op becomes a conv2d_relu or a conv2d.
+// Runs before xten-annotate-dataflow, so the explorer, the splits and the kernels never see the
+// batch norm parameters. Layers in training mode or with non constant parameters are left as they are.
+
+namespace xilinx {
+    namespace xten {
+
+        struct XTenFoldBatchNormPass : public XTenFoldBatchNormBase<XTenFoldBatchNormPass> {
+        public:
+            Statistic numFolded{this, "folded", "Number of batch norms folded into their convolution"};
+
+            XTenFoldBatchNormPass() {}
+            XTenFoldBatchNormPass(const XTenFoldBatchNormPass &pass) {}
+
+            // Values of a constant f32 tensor, false if v is anything else
+            bool getFloatValues(Value v, std::vector<double> &values) {
+                DenseElementsAttr attr = getConstantData(v);
+                if(!attr || !attr.getType().getElementType().isF32()) {
+                    return false;
+                }
+
+                values.clear();
+                for(float f : attr.getValues<float>()) {
+                    values.push_back(f);
+                }
+
+                return true;
+            }
+
+            Value createFloatConstant(OpBuilder &builder, Location loc, mlir::torch::Torch::BaseTensorType like,
+                                      ArrayRef<int64_t> shape, std::vector<float> &values) {
+                Type f32 = builder.getF32Type();
+                DenseElementsAttr attr = DenseElementsAttr::get(RankedTensorType::get(shape, f32), llvm::makeArrayRef(values));
+                Operation* cst = builder.create<mlir::arith::ConstantOp>(loc, like.getWithSizesAndDtype(shape, f32), attr);
+                return cst->getResult(0);
+            }
+
+            // BNOp is replaced by the ConvOp without batch norm
+            template<class BNOp, class ConvOp>
+            bool fold(BNOp op, llvm::SmallSetVector<Operation*, 16> &oldConstants) {
+                auto training = op.training().template getDefiningOp<mlir::torch::Torch::ConstantBoolOp>();
+                auto eps = op.eps().template getDefiningOp<mlir::torch::Torch::ConstantFloatOp>();
+                if(!training || training.value() || !eps) {
+                    return false;
+                }
+
+                std::vector<double> weights;
+                std::vector<double> gamma;
+                std::vector<double> beta;
+                std::vector<double> mean;
+                std::vector<double> var;
+                if(!this->getFloatValues(op.weight(), weights) || !this->getFloatValues(op.bn_weight(), gamma) ||
+                   !this->getFloatValues(op.bn_bias(), beta) || !this->getFloatValues(op.running_mean(), mean) ||
+                   !this->getFloatValues(op.running_var(), var)) {
+                    return false;
+                }
+
+                uint64_t channels = gamma.size();
+                std::vector<double> bias(channels, 0);
+                bool hasBias = !op.bias().getType().template isa<mlir::torch::Torch::NoneType>();
+                if(hasBias && (!this->getFloatValues(op.bias(), bias) || bias.size() != channels)) {
+                    return false;
+                }
+
+                if(beta.size() != channels || mean.size() != channels || var.size() != channels ||
+                   channels == 0 || (weights.size() % channels) != 0) {
+                    return false;
+                }
+
+                double epsValue = eps.value().convertToDouble();
+                std::vector<double> scales;
+                for(uint64_t c = 0; c < channels; c++) {
+                    scales.push_back(gamma.at(c) / std::sqrt(var.at(c) + epsValue));
+                }
+
+                // Weights are laid out with the output channel first
+                uint64_t perChannel = weights.size() / channels;
+                std::vector<float> nWeights;
+                for(uint64_t i = 0; i < weights.size(); i++) {
+                    nWeights.push_back(weights.at(i) * scales.at(i / perChannel));
+                }
+
+                std::vector<float> nBias;
+                for(uint64_t c = 0; c < channels; c++) {
+                    nBias.push_back((bias.at(c) - mean.at(c)) * scales.at(c) + beta.at(c));
+                }
+
+                OpBuilder builder(op);
+                mlir::torch::Torch::BaseTensorType weightType = op.weight().getType().template dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                Value w = this->createFloatConstant(builder, op.getLoc(), weightType, weightType.getSizes(), nWeights);
+                Value b = this->createFloatConstant(builder, op.getLoc(), weightType, {(int64_t)channels}, nBias);
+
+                Operation* conv = builder.create<ConvOp>(op.getLoc(),
+                                                         op.getResult().getType(),
+                                                         op.input(),
+                                                         w,
+                                                         b,
+                                                         op.stride(),
+                                                         op.padding(),
+                                                         op.dilation(),
+                                                         op.groups());
+                conv->setAttrs(op->getAttrs());
+
+                for(Value param : {op.weight(), op.bias(), op.bn_weight(), op.bn_bias(), op.running_mean(), op.running_var()}) {
+                    if(param.getDefiningOp() != nullptr) {
+                        oldConstants.insert(param.getDefiningOp());
+                    }
+                }
+
+                op.getResult().replaceAllUsesWith(conv->getResult(0));
+                op.erase();
+
+                return true;
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                auto graph = module.lookupSymbol<func::FuncOp>("forward");
+                if(!graph) {
+                    emitError(UnknownLoc::get(module.getContext()), "Cant find graph func\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                std::vector<Operation*> convs;
+                graph.walk([&](Operation* op) {
+                        if(llvm::isa<Conv2dBatchNormReLUOp>(op) || llvm::isa<Conv2dBatchNormOp>(op)) {
+                            convs.push_back(op);
+                        }
+                    });
+
+                llvm::SmallSetVector<Operation*, 16> oldConstants;
+                for(Operation* op : convs) {
+                    bool folded;
+                    if(auto bnRelu = llvm::dyn_cast<Conv2dBatchNormReLUOp>(op)) {
+                        folded = this->fold<Conv2dBatchNormReLUOp, Conv2dReLUOp>(bnRelu, oldConstants);
+                    } else {
+                        folded = this->fold<Conv2dBatchNormOp, Conv2dOp>(llvm::cast<Conv2dBatchNormOp>(op), oldConstants);
+                    }
+
+                    if(folded) {
+                        numFolded++;
+                    } else {
+                        LLVM_DEBUG(llvm::outs() << "Cannot fold the batch norm of " << op->getName() << "\n");
+                    }
+                }
+
+                // Parameters no longer read by anyone, including the none bias
+                for(Operation* cst : oldConstants) {
+                    if(cst->use_empty()) {
+                        cst->erase();
+                    }
+                }
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenFoldBatchNormPass() {
+    return std::make_unique<XTenFoldBatchNormPass>();
+}
+
+} // namespace xten
+} // namespace xilinx
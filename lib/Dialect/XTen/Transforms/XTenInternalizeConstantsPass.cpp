@@ -0,0 +1,138 @@
+//===- XTenInternalizeConstantsPass.cpp -------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "xten/Dialect/XTen/XTenInternalizeConstantsPass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-internalize-constants-pass"
+
+using namespace mlir;
+
+// Turns the xten.external_constant ops back into constants with the data read from the weights blob
+// The blob is mapped rather than read, so only the pages of the constants in the module are loaded
+
+namespace xilinx {
+    namespace xten {
+
+        struct XTenInternalizeConstantsPass : public XTenInternalizeConstantsBase<XTenInternalizeConstantsPass> {
+        public:
+            Option<std::string> blobFilename{*this, "blob",
+                                             llvm::cl::desc("File to read the data from, defaults to the " WEIGHTS_BLOB_ATTR " attribute of the module"),
+                                             llvm::cl::init("")};
+
+            Statistic numConstants{this, "constants", "Number of constants read from the file"};
+
+            XTenInternalizeConstantsPass() {}
+            XTenInternalizeConstantsPass(const XTenInternalizeConstantsPass &pass) {}
+
+            // Type of the dense attribute holding the data of a constant of type t
+            RankedTensorType storageType(Type t) {
+                if(auto ranked = t.dyn_cast<RankedTensorType>()) {
+                    return ranked;
+                }
+
+                if(auto tensorType = t.dyn_cast<mlir::torch::Torch::BaseTensorType>()) {
+                    if(tensorType.hasSizes() && tensorType.hasDtype()) {
+                        return RankedTensorType::get(tensorType.getSizes(), tensorType.getDtype());
+                    }
+                }
+
+                return RankedTensorType();
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                std::vector<ExternalConstantOp> externals;
+                module.walk([&](ExternalConstantOp external) {
+                        externals.push_back(external);
+                    });
+
+                std::string filename = blobFilename;
+                if(filename == "") {
+                    if(auto attr = module->getAttrOfType<StringAttr>(WEIGHTS_BLOB_ATTR)) {
+                        filename = attr.getValue().str();
+                    }
+                }
+
+                if(externals.size() == 0) {
+                    module->removeAttr(WEIGHTS_BLOB_ATTR);
+                    return;
+                }
+
+                if(filename == "") {
+                    emitError(module.getLoc(), "No weights blob given and no " WEIGHTS_BLOB_ATTR " attribute on the module");
+                    signalPassFailure();
+                    return;
+                }
+
+                // No null terminator so that large files are mapped
+                llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> blob =
+                    llvm::MemoryBuffer::getFile(filename, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+                if(!blob) {
+                    emitError(module.getLoc(), "Cannot open " + filename + ": " + blob.getError().message());
+                    signalPassFailure();
+                    return;
+                }
+
+                uint64_t blobSize = (*blob)->getBufferSize();
+                for(ExternalConstantOp external : externals) {
+                    uint64_t offset = external.offset();
+                    uint64_t size = external.size();
+
+                    RankedTensorType type = this->storageType(external.getResult().getType());
+                    if(!type || (offset + size) > blobSize ||
+                       (type.getNumElements() * rawElementBytes(type.getElementType())) != size) {
+                        external.emitError("Does not match the data in " + filename);
+                        signalPassFailure();
+                        return;
+                    }
+
+                    ArrayRef<char> raw((*blob)->getBufferStart() + offset, size);
+                    DenseElementsAttr attr = DenseElementsAttr::getFromRawBuffer(type, raw);
+
+                    OpBuilder builder(external);
+                    Operation* cst = builder.create<mlir::arith::ConstantOp>(external.getLoc(), external.getResult().getType(), attr);
+                    external.getResult().replaceAllUsesWith(cst->getResult(0));
+                    external.erase();
+                    numConstants++;
+                }
+
+                module->removeAttr(WEIGHTS_BLOB_ATTR);
+
+                LLVM_DEBUG(llvm::outs() << "Read " << externals.size() << " constants from " << filename << "\n");
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenInternalizeConstantsPass() {
+    return std::make_unique<XTenInternalizeConstantsPass>();
+}
+
+} // namespace xten
+} // namespace xilinx
@@ -0,0 +1,119 @@
+//===- XTenMaterializeSlicesPass.cpp ----------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/Threading.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/Support/Debug.h"
+
+#include "torch-mlir/Dialect/Torch/IR/TorchOps.h"
+
+#include "xten/Dialect/XTen/XTenMaterializeSlicesPass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#define DEBUG_TYPE "xten-materialize-slices-pass"
+
+using namespace mlir;
+
+// The dataflow transforms only reference parts of the weights through xten.slice ops
+// This replaces each slice of a constant by its own constant, to run right before lowering or serialization
+// Copying the parts out of the constants is the heavy part and every slice is independent, so the new
+// attributes are built in parallel over all layers and only the rewriting of the IR is sequential
+
+namespace xilinx {
+    namespace xten {
+
+        struct XTenMaterializeSlicesPass : public XTenMaterializeSlicesBase<XTenMaterializeSlicesPass> {
+        public:
+            Statistic numSlices{this, "slices", "Number of slices materialized"};
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                std::vector<std::pair<SliceOp, DenseElementsAttr>> slices;
+                module.walk([&](SliceOp slice) {
+                        slices.push_back(std::make_pair(slice, DenseElementsAttr()));
+                    });
+
+                // Only reads the IR, attributes are uniqued by the context in a thread safe way
+                parallelForEach(&getContext(), slices, [](std::pair<SliceOp, DenseElementsAttr> &slice) {
+                        slice.second = materializeSlice(slice.first);
+                    });
+
+                // Diagnostics are emitted here rather than from the workers, nothing is rewritten if one fails
+                bool failed = false;
+                for(auto &sliceAndAttr : slices) {
+                    SliceOp slice = sliceAndAttr.first;
+                    if(sliceAndAttr.second) {
+                        continue;
+                    }
+
+                    if(!getConstantData(slice.input())) {
+                        slice.emitError("Cannot materialize a slice of a value that is not a constant");
+                    } else {
+                        slice.emitError("Cannot materialize a slice of a constant whose elements are not byte addressable");
+                    }
+                    failed = true;
+                }
+
+                if(failed) {
+                    signalPassFailure();
+                    return;
+                }
+
+                std::set<Operation*> roots;
+                for(auto &sliceAndAttr : slices) {
+                    SliceOp slice = sliceAndAttr.first;
+                    DenseElementsAttr attr = sliceAndAttr.second;
+
+                    // The part keeps the kind of constant it comes from
+                    OpBuilder builder(slice);
+                    Operation* root = slice.input().getDefiningOp();
+                    roots.insert(root);
+                    Operation* cst;
+                    if(llvm::isa<mlir::torch::Torch::ValueTensorLiteralOp>(root)) {
+                        cst = builder.create<mlir::torch::Torch::ValueTensorLiteralOp>(slice.getLoc(), slice.getResult().getType(), attr);
+                    } else {
+                        cst = builder.create<mlir::arith::ConstantOp>(slice.getLoc(), slice.getResult().getType(), attr);
+                    }
+                    slice.getResult().replaceAllUsesWith(cst->getResult(0));
+                    slice.erase();
+                    numSlices++;
+                }
+
+                for(Operation* root : roots) {
+                    if(root->use_empty()) {
+                        root->erase();
+                    }
+                }
+
+                LLVM_DEBUG(llvm::outs() << "Materialized " << slices.size() << " slices\n");
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenMaterializeSlicesPass() {
+    return std::make_unique<XTenMaterializeSlicesPass>();
+}
+
+} // namespace xten
+} // namespace xilinx
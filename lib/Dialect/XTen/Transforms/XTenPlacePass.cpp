@@ -0,0 +1,398 @@
+//===- XTenPlacePass.cpp ----------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+#include "xten/Dialect/XTen/XTenPlacePass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-place-pass"
+
+using namespace mlir;
+
+// Places each op of the expanded graph on one core and records it as xten.core = [row, col]
+// Cores are visited along a snake through the grid, so consecutive cores are always neighbours.
+// A chain is a run of ops of the same layer feeding each other directly (Ca and L cascades,
+// W forwarding), a depth wise op is appended to the chain of its producer. Chains are laid out
+// along the snake in graph order, then chains of the same length are swapped as long as
+// it reduces the total Manhattan distance of the streams between ops.
+
+namespace xilinx {
+    namespace xten {
+        // Consecutive slots of the snake, an empty chain is a free core
+        class PlaceChain {
+        public:
+            std::vector<unsigned int> ops;
+            uint64_t start;
+            uint64_t length;
+
+            PlaceChain(uint64_t start, uint64_t length) : start(start), length(length) {}
+        };
+
+        class PlaceEdge {
+        public:
+            unsigned int producer;
+            unsigned int consumer;
+            bool adjacent; // cascade or depth wise handoff, expects neighbour cores
+        };
+
+        struct XTenPlacePass : public XTenPlaceBase<XTenPlacePass> {
+        public:
+            Option<std::string> reportFilename{*this, "placement-report",
+                                               llvm::cl::desc("Write the wirelength and congestion of the placement to this file, \"-\" for stdout"),
+                                               llvm::cl::init("")};
+
+            Option<unsigned> gridRows{*this, "rows",
+                                      llvm::cl::desc("Rows of the core grid, 0 to use the architecture"),
+                                      llvm::cl::init(0)};
+
+            Option<unsigned> gridCols{*this, "cols",
+                                      llvm::cl::desc("Columns of the core grid, 0 to use the architecture"),
+                                      llvm::cl::init(0)};
+
+            Option<unsigned> maxSweeps{*this, "sweeps",
+                                       llvm::cl::desc("Maximum number of improvement sweeps over all pairs of chains"),
+                                       llvm::cl::init(8)};
+
+            Statistic wirelength{this, "wirelength", "Sum of the Manhattan distances of the streams"};
+            Statistic maxCongestion{this, "max-congestion", "Largest number of streams routed over one link"};
+            Statistic numNonAdjacent{this, "non-adjacent", "Number of cascade or depth wise streams between non neighbour cores"};
+            Statistic numSwaps{this, "swaps", "Number of chain swaps kept"};
+
+            XTenPlacePass() {}
+            XTenPlacePass(const XTenPlacePass &pass) {}
+
+            uint64_t rows;
+            uint64_t cols;
+
+            std::vector<Operation*> ops;
+            llvm::DenseMap<Operation*, unsigned int> opToId;
+            std::vector<PlaceEdge> edges;
+            std::vector<std::vector<unsigned int>> opToEdges;
+
+            std::vector<PlaceChain> chains;
+            std::vector<unsigned int> opToChain;
+            std::vector<uint64_t> opToOffset;
+
+            std::pair<uint64_t, uint64_t> slotToCore(uint64_t slot) {
+                uint64_t row = slot / this->cols;
+                uint64_t col = slot % this->cols;
+                if((row % 2) == 1) {
+                    col = this->cols - 1 - col;
+                }
+
+                return std::make_pair(row, col);
+            }
+
+            uint64_t slotOf(unsigned int op) {
+                return this->chains.at(this->opToChain.at(op)).start + this->opToOffset.at(op);
+            }
+
+            uint64_t distance(unsigned int a, unsigned int b) {
+                std::pair<uint64_t, uint64_t> ca = this->slotToCore(this->slotOf(a));
+                std::pair<uint64_t, uint64_t> cb = this->slotToCore(this->slotOf(b));
+
+                uint64_t dRow = (ca.first > cb.first) ? (ca.first - cb.first) : (cb.first - ca.first);
+                uint64_t dCol = (ca.second > cb.second) ? (ca.second - cb.second) : (cb.second - ca.second);
+                return dRow + dCol;
+            }
+
+            // Producer of the same layer directly feeding op, if any
+            Optional<unsigned int> cascadeProducer(unsigned int op) {
+                Operation* consumer = this->ops.at(op);
+                for(Value operand : consumer->getOperands()) {
+                    Operation* def = operand.getDefiningOp();
+                    if(def == nullptr || this->opToId.count(def) == 0) {
+                        continue;
+                    }
+
+                    if(def->getAttr("layer_name") == consumer->getAttr("layer_name")) {
+                        return this->opToId[def];
+                    }
+                }
+
+                return llvm::None;
+            }
+
+            void addEdge(unsigned int producer, unsigned int consumer, bool adjacent) {
+                PlaceEdge edge;
+                edge.producer = producer;
+                edge.consumer = consumer;
+                edge.adjacent = adjacent;
+
+                this->opToEdges.at(producer).push_back(this->edges.size());
+                this->opToEdges.at(consumer).push_back(this->edges.size());
+                this->edges.push_back(edge);
+            }
+
+            void buildChains() {
+                this->opToChain.resize(this->ops.size());
+                this->opToOffset.resize(this->ops.size());
+                this->opToEdges.resize(this->ops.size());
+
+                for(unsigned int i = 0; i < this->ops.size(); i++) {
+                    llvm::SmallSetVector<Operation*, 4> producerOps;
+                    for(Value operand : this->ops.at(i)->getOperands()) {
+                        findProducerOps(operand, producerOps);
+                    }
+
+                    std::vector<unsigned int> producers;
+                    for(Operation* p : producerOps) {
+                        producers.push_back(this->opToId[p]);
+                    }
+
+                    AbsOpWrapper* wrapped = opToWrapper(this->ops.at(i));
+                    bool depthWise = wrapped->isDepthWise();
+                    delete wrapped;
+
+                    // Extend the chain of the producer when op can follow it on the next core
+                    Optional<unsigned int> cascade = this->cascadeProducer(i);
+                    Optional<unsigned int> follows;
+                    if(cascade.hasValue()) {
+                        follows = cascade;
+                    } else if(depthWise && producers.size() == 1) {
+                        follows = producers[0];
+                    }
+
+                    for(unsigned int p : producers) {
+                        this->addEdge(p, i, follows.hasValue() && (p == follows.getValue()));
+                    }
+
+                    if(follows.hasValue()) {
+                        PlaceChain &chain = this->chains.at(this->opToChain.at(follows.getValue()));
+                        if(chain.ops.back() == follows.getValue()) {
+                            this->opToChain.at(i) = this->opToChain.at(follows.getValue());
+                            this->opToOffset.at(i) = chain.ops.size();
+                            chain.ops.push_back(i);
+                            chain.length++;
+                            continue;
+                        }
+                    }
+
+                    this->opToChain.at(i) = this->chains.size();
+                    this->opToOffset.at(i) = 0;
+                    this->chains.push_back(PlaceChain(0, 1));
+                    this->chains.back().ops.push_back(i);
+                }
+
+                // Chains follow the graph order along the snake, the remaining cores are free
+                uint64_t slot = 0;
+                for(PlaceChain &chain : this->chains) {
+                    chain.start = slot;
+                    slot += chain.length;
+                }
+
+                for(; slot < this->rows * this->cols; slot++) {
+                    this->chains.push_back(PlaceChain(slot, 1));
+                }
+            }
+
+            uint64_t swapCost(unsigned int a, unsigned int b) {
+                llvm::SmallSetVector<unsigned int, 16> incident;
+                for(unsigned int c : {a, b}) {
+                    for(unsigned int op : this->chains.at(c).ops) {
+                        incident.insert(this->opToEdges.at(op).begin(), this->opToEdges.at(op).end());
+                    }
+                }
+
+                uint64_t cost = 0;
+                for(unsigned int e : incident) {
+                    cost += this->distance(this->edges.at(e).producer, this->edges.at(e).consumer);
+                }
+
+                return cost;
+            }
+
+            void improve() {
+                for(unsigned int sweep = 0; sweep < maxSweeps; sweep++) {
+                    bool changed = false;
+                    for(unsigned int a = 0; a < this->chains.size(); a++) {
+                        if(this->chains.at(a).ops.size() == 0) {
+                            continue;
+                        }
+
+                        for(unsigned int b = 0; b < this->chains.size(); b++) {
+                            if(a == b || this->chains.at(a).length != this->chains.at(b).length) {
+                                continue;
+                            }
+
+                            uint64_t before = this->swapCost(a, b);
+                            std::swap(this->chains.at(a).start, this->chains.at(b).start);
+                            if(this->swapCost(a, b) < before) {
+                                changed = true;
+                                numSwaps++;
+                            } else {
+                                std::swap(this->chains.at(a).start, this->chains.at(b).start);
+                            }
+                        }
+                    }
+
+                    if(!changed) {
+                        break;
+                    }
+                }
+            }
+
+            // Streams are routed along the row of their producer first, then along the column
+            void route(PlaceEdge &edge, std::vector<uint64_t> &rowLinks, std::vector<uint64_t> &colLinks) {
+                std::pair<uint64_t, uint64_t> from = this->slotToCore(this->slotOf(edge.producer));
+                std::pair<uint64_t, uint64_t> to = this->slotToCore(this->slotOf(edge.consumer));
+
+                uint64_t row = from.first;
+                uint64_t col = from.second;
+                while(col != to.second) {
+                    uint64_t next = (col < to.second) ? (col + 1) : (col - 1);
+                    rowLinks.at(row * this->cols + std::min(col, next))++;
+                    col = next;
+                }
+
+                while(row != to.first) {
+                    uint64_t next = (row < to.first) ? (row + 1) : (row - 1);
+                    colLinks.at(std::min(row, next) * this->cols + col)++;
+                    row = next;
+                }
+            }
+
+            std::string emitReport() {
+                std::vector<uint64_t> rowLinks(this->rows * this->cols, 0);
+                std::vector<uint64_t> colLinks(this->rows * this->cols, 0);
+
+                uint64_t totalLength = 0;
+                uint64_t maxHops = 0;
+                uint64_t nonAdjacent = 0;
+                for(PlaceEdge &edge : this->edges) {
+                    uint64_t hops = this->distance(edge.producer, edge.consumer);
+                    totalLength += hops;
+                    maxHops = std::max(maxHops, hops);
+                    nonAdjacent += (edge.adjacent && hops > 1) ? 1 : 0;
+
+                    this->route(edge, rowLinks, colLinks);
+                }
+
+                uint64_t maxLoad = 0;
+                uint64_t usedLinks = 0;
+                uint64_t totalLoad = 0;
+                for(std::vector<uint64_t>* links : {&rowLinks, &colLinks}) {
+                    for(uint64_t load : *links) {
+                        maxLoad = std::max(maxLoad, load);
+                        usedLinks += (load != 0) ? 1 : 0;
+                        totalLoad += load;
+                    }
+                }
+
+                wirelength = totalLength;
+                maxCongestion = maxLoad;
+                numNonAdjacent = nonAdjacent;
+
+                llvm::json::Object top;
+                top["rows"] = (int64_t)this->rows;
+                top["cols"] = (int64_t)this->cols;
+                top["cores"] = (int64_t)this->ops.size();
+                top["streams"] = (int64_t)this->edges.size();
+                top["wirelength"] = (int64_t)totalLength;
+                top["maxHops"] = (int64_t)maxHops;
+                top["nonAdjacent"] = (int64_t)nonAdjacent;
+                top["maxCongestion"] = (int64_t)maxLoad;
+                top["avgCongestion"] = (usedLinks == 0) ? 0.0 : (double)totalLoad / usedLinks;
+
+                llvm::json::Value topv(std::move(top));
+                std::string ret;
+                llvm::raw_string_ostream ss(ret);
+                ss << llvm::formatv("{0:2}", topv) << "\n";
+                return ss.str();
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                auto graph = module.lookupSymbol<func::FuncOp>("forward");
+                if(!graph) {
+                    emitError(UnknownLoc::get(module.getContext()), "Cant find graph func\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                if(failed(checkLayerOps(graph))) {
+                    signalPassFailure();
+                    return;
+                }
+
+                AIEv1 arch(1, 1);
+                this->rows = (gridRows != 0) ? (uint64_t)gridRows : arch.getNumRows();
+                this->cols = (gridCols != 0) ? (uint64_t)gridCols : arch.getNumCols();
+
+                this->ops.clear();
+                this->opToId.clear();
+                this->edges.clear();
+                this->opToEdges.clear();
+                this->chains.clear();
+                this->opToChain.clear();
+                this->opToOffset.clear();
+
+                graph.walk([&](Operation *op) {
+                        if(op->getAttr("layer_name") != nullptr) {
+                            this->opToId[op] = this->ops.size();
+                            this->ops.push_back(op);
+                        }
+                    });
+
+                if(this->ops.size() > this->rows * this->cols) {
+                    emitError(graph.getLoc(), "Expanded graph needs " + std::to_string(this->ops.size()) +
+                              " cores but the grid only has " + std::to_string(this->rows * this->cols) + "\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                this->buildChains();
+                this->improve();
+
+                Builder builder(module.getContext());
+                for(unsigned int i = 0; i < this->ops.size(); i++) {
+                    std::pair<uint64_t, uint64_t> core = this->slotToCore(this->slotOf(i));
+                    this->ops.at(i)->setAttr(CORE_ATTR, builder.getI64ArrayAttr({(int64_t)core.first, (int64_t)core.second}));
+
+                    LLVM_DEBUG(llvm::outs() << "Placed " << this->ops.at(i)->getName() << " on core (" << core.first << ", " << core.second << ")\n");
+                }
+
+                std::string report = this->emitReport();
+                if(reportFilename != "") {
+                    if(failed(writeReport(reportFilename, report, graph.getLoc()))) {
+                        signalPassFailure();
+                    }
+                }
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenPlacePass() {
+    return std::make_unique<XTenPlacePass>();
+}
+
+} // namespace xten
+} // namespace xilinx
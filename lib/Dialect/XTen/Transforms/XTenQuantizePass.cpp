@@ -0,0 +1,291 @@
+//===- XTenQuantizePass.cpp -------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Pass/Pass.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "xten/Dialect/XTen/XTenQuantizePass.h"
+#include "xten/Dialect/XTen/XTenDataflowUtils.h"
+#include "xten/Dialect/XTen/XTenDataflowConsts.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define DEBUG_TYPE "xten-quantize-pass"
+
+using namespace mlir;
+
+// Rewrites the conv2d, conv2d_relu, conv2d_hardswish, mm and linear_relu layers to int8 so that
+// the design built matches the int8 model of the explorer. The calibration file gives the absolute
+// maximum of the input and output of each layer by layer name, {"conv2d_relu0": {"input": 2.5, "output": 6.0}, ...}.
+// Weights get a symmetric scale per output channel and biases become int32 at the scale of the
+// accumulators. Each quantized layer carries its scales in QUANT_ATTR, which the expansion slices
+// along with the output channels. Quantized layers read the int8 result of a quantized producer
+// directly, xten.quantize and xten.dequantize ops are only inserted at the boundaries with float ops.
+// Layers with batch norm stay in float, xten-fold-batchnorm turns them into conv2d and conv2d_relu beforehand.
+
+namespace xilinx {
+    namespace xten {
+
+        struct XTenQuantizePass : public XTenQuantizeBase<XTenQuantizePass> {
+        public:
+            Option<std::string> calibrationFilename{*this, "calibration",
+                                                    llvm::cl::desc("JSON file giving the absolute maximum of the input and output of each layer"),
+                                                    llvm::cl::init("")};
+
+            Statistic numLayers{this, "layers", "Number of layers quantized"};
+            Statistic numConversions{this, "conversions", "Number of quantize and dequantize ops inserted"};
+
+            XTenQuantizePass() {}
+            XTenQuantizePass(const XTenQuantizePass &pass) {}
+
+            bool isQuantizable(Operation* op) {
+                return llvm::isa<Conv2dOp>(op) || llvm::isa<Conv2dReLUOp>(op) || llvm::isa<Conv2dHardswishOp>(op) ||
+                    llvm::isa<MMOp>(op) || llvm::isa<LinearReLUOp>(op);
+            }
+
+            // Dense f32 data of a constant weight or bias, null for anything else
+            DenseElementsAttr getFloatData(Value v) {
+                DenseElementsAttr attr = getConstantData(v);
+                if(!attr || !attr.getType().getElementType().isF32()) {
+                    return DenseElementsAttr();
+                }
+
+                return attr;
+            }
+
+            Type withDtype(Type t, Type dtype) {
+                mlir::torch::Torch::BaseTensorType tensorType = t.dyn_cast<mlir::torch::Torch::BaseTensorType>();
+                return tensorType.getWithSizesAndDtype(tensorType.getSizes(), dtype);
+            }
+
+            double scaleOf(double absMax) {
+                return (absMax > 0) ? (absMax / 127.0) : 1.0;
+            }
+
+            int64_t roundAndClamp(double v, int64_t bound) {
+                return (int64_t)std::max(std::min(std::round(v), (double)bound), (double)-bound);
+            }
+
+            // int8 copy of the weights with one scale per slice along channelDim
+            Value quantizeWeights(OpBuilder &builder, Value weights, DenseElementsAttr data, unsigned int channelDim,
+                                  std::vector<double> &scales) {
+                ArrayRef<int64_t> shape = data.getType().getShape();
+                int64_t channels = shape[channelDim];
+                int64_t inner = 1;
+                for(unsigned int d = channelDim + 1; d < shape.size(); d++) {
+                    inner *= shape[d];
+                }
+
+                std::vector<float> values(data.getValues<float>().begin(), data.getValues<float>().end());
+
+                std::vector<double> absMax(channels, 0);
+                for(uint64_t i = 0; i < values.size(); i++) {
+                    int64_t c = (i / inner) % channels;
+                    absMax.at(c) = std::max(absMax.at(c), (double)std::abs(values.at(i)));
+                }
+
+                scales.clear();
+                for(int64_t c = 0; c < channels; c++) {
+                    scales.push_back(this->scaleOf(absMax.at(c)));
+                }
+
+                std::vector<APInt> quantized;
+                for(uint64_t i = 0; i < values.size(); i++) {
+                    int64_t c = (i / inner) % channels;
+                    quantized.push_back(APInt(8, this->roundAndClamp(values.at(i) / scales.at(c), 127), true));
+                }
+
+                Type i8 = IntegerType::get(builder.getContext(), 8, IntegerType::Signed);
+                DenseElementsAttr attr = DenseElementsAttr::get(RankedTensorType::get(shape, i8), quantized);
+                Operation* cst = builder.create<mlir::arith::ConstantOp>(weights.getLoc(), this->withDtype(weights.getType(), i8), attr);
+                return cst->getResult(0);
+            }
+
+            // int32 copy of the biases at the scale of the accumulators of each channel
+            Value quantizeBiases(OpBuilder &builder, Value biases, DenseElementsAttr data, double inScale,
+                                 std::vector<double> &weightScales) {
+                std::vector<float> values(data.getValues<float>().begin(), data.getValues<float>().end());
+                assert(values.size() == weightScales.size());
+
+                std::vector<APInt> quantized;
+                for(uint64_t c = 0; c < values.size(); c++) {
+                    quantized.push_back(APInt(32, this->roundAndClamp(values.at(c) / (inScale * weightScales.at(c)), INT32_MAX), true));
+                }
+
+                Type i32 = IntegerType::get(builder.getContext(), 32, IntegerType::Signed);
+                DenseElementsAttr attr = DenseElementsAttr::get(RankedTensorType::get(data.getType().getShape(), i32), quantized);
+                Operation* cst = builder.create<mlir::arith::ConstantOp>(biases.getLoc(), this->withDtype(biases.getType(), i32), attr);
+                return cst->getResult(0);
+            }
+
+            void runOnOperation() override {
+                ModuleOp module = getOperation();
+
+                auto graph = module.lookupSymbol<func::FuncOp>("forward");
+                if(!graph) {
+                    emitError(UnknownLoc::get(module.getContext()), "Cant find graph func\n");
+                    signalPassFailure();
+                    return;
+                }
+
+                llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file = llvm::MemoryBuffer::getFile(calibrationFilename);
+                if(!file) {
+                    emitError(module.getLoc(), "Cannot open calibration file " + calibrationFilename + ": " + file.getError().message());
+                    signalPassFailure();
+                    return;
+                }
+
+                llvm::Expected<llvm::json::Value> calibration = llvm::json::parse((*file)->getBuffer());
+                if(!calibration || calibration->getAsObject() == nullptr) {
+                    if(!calibration) {
+                        llvm::consumeError(calibration.takeError());
+                    }
+
+                    emitError(module.getLoc(), "Invalid calibration file " + calibrationFilename);
+                    signalPassFailure();
+                    return;
+                }
+
+                llvm::json::Object* stats = calibration->getAsObject();
+
+                // Layers with weights and statistics, the others stay in float
+                std::vector<std::vector<uint64_t>> producers;
+                std::vector<Operation*> toQuantize;
+                for(Operation* op : getLayersInTopologicalOrder(graph, producers)) {
+                    std::string name = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+                    llvm::json::Object* layerStats = stats->getObject(name);
+                    if(!this->isQuantizable(op) || layerStats == nullptr ||
+                       !layerStats->getNumber("input").hasValue() || !layerStats->getNumber("output").hasValue()) {
+                        continue;
+                    }
+
+                    AbsOpWrapper* wrapped = opToWrapper(op);
+                    bool constant = this->getFloatData(wrapped->getWeights()) &&
+                        (!wrapped->hasBias() || this->getFloatData(*wrapped->getBiases()));
+                    delete wrapped;
+
+                    if(constant) {
+                        toQuantize.push_back(op);
+                    } else {
+                        LLVM_DEBUG(llvm::outs() << "Keeping " << name << " in float, its weights are not constant\n");
+                    }
+                }
+
+                llvm::SmallPtrSet<Operation*, 16> quantized(toQuantize.begin(), toQuantize.end());
+                llvm::DenseMap<Operation*, double> outputScales;
+                llvm::SmallSetVector<Operation*, 16> oldConstants;
+
+                Type i8 = IntegerType::get(module.getContext(), 8, IntegerType::Signed);
+                for(Operation* op : toQuantize) {
+                    std::string name = op->getAttr("layer_name").dyn_cast<StringAttr>().getValue().str();
+                    llvm::json::Object* layerStats = stats->getObject(name);
+                    double inScale = this->scaleOf(*layerStats->getNumber("input"));
+                    double outScale = this->scaleOf(*layerStats->getNumber("output"));
+
+                    AbsOpWrapper* wrapped = opToWrapper(op);
+                    OpBuilder builder(op);
+
+                    // Reuse the scale of a quantized producer, quantize anything else
+                    Value input = wrapped->getInput();
+                    Operation* producer = input.getDefiningOp();
+                    if(producer != nullptr && quantized.count(producer) != 0) {
+                        inScale = outputScales[producer];
+                    } else {
+                        Operation* quantize = builder.create<QuantizeOp>(op->getLoc(), this->withDtype(input.getType(), i8), input,
+                                                                         builder.getF64FloatAttr(inScale));
+                        op->replaceUsesOfWith(input, quantize->getResult(0));
+                        numConversions++;
+                    }
+
+                    // Output channels are the rows of the conv and linear weights and the columns of y
+                    std::vector<double> weightScales;
+                    Value weights = wrapped->getWeights();
+                    unsigned int channelDim = llvm::isa<MMOp>(op) ? 1 : 0;
+                    Value nWeights = this->quantizeWeights(builder, weights, this->getFloatData(weights), channelDim, weightScales);
+                    op->replaceUsesOfWith(weights, nWeights);
+                    oldConstants.insert(weights.getDefiningOp());
+
+                    if(wrapped->hasBias()) {
+                        Value biases = *wrapped->getBiases();
+                        Value nBiases = this->quantizeBiases(builder, biases, this->getFloatData(biases), inScale, weightScales);
+                        op->replaceUsesOfWith(biases, nBiases);
+                        oldConstants.insert(biases.getDefiningOp());
+                    }
+
+                    delete wrapped;
+
+                    Value result = op->getResult(0);
+                    Type floatType = result.getType();
+                    result.setType(this->withDtype(floatType, i8));
+
+                    std::vector<NamedAttribute> attrs;
+                    attrs.push_back(builder.getNamedAttr("input_scale", builder.getF64FloatAttr(inScale)));
+                    attrs.push_back(builder.getNamedAttr("output_scale", builder.getF64FloatAttr(outScale)));
+                    attrs.push_back(builder.getNamedAttr("weight_scales", builder.getF64ArrayAttr(weightScales)));
+                    op->setAttr(QUANT_ATTR, builder.getDictionaryAttr(attrs));
+                    outputScales[op] = outScale;
+
+                    // Float users read a single dequantized copy
+                    std::vector<OpOperand*> floatUses;
+                    for(OpOperand &use : result.getUses()) {
+                        if(quantized.count(use.getOwner()) == 0) {
+                            floatUses.push_back(&use);
+                        }
+                    }
+
+                    if(!floatUses.empty()) {
+                        builder.setInsertionPointAfter(op);
+                        Operation* dequantize = builder.create<DequantizeOp>(op->getLoc(), floatType, result,
+                                                                             builder.getF64FloatAttr(outScale));
+                        for(OpOperand* use : floatUses) {
+                            use->set(dequantize->getResult(0));
+                        }
+                        numConversions++;
+                    }
+
+                    numLayers++;
+                }
+
+                // Float constants no longer read by anyone
+                for(Operation* cst : oldConstants) {
+                    if(cst->use_empty()) {
+                        cst->erase();
+                    }
+                }
+
+                LLVM_DEBUG(llvm::outs() << "Quantized " << toQuantize.size() << " layers\n");
+            }
+        };
+    }
+}
+
+namespace xilinx {
+namespace xten {
+
+std::unique_ptr<OperationPass<ModuleOp>> createXTenQuantizePass() {
+    return std::make_unique<XTenQuantizePass>();
+}
+
+} // namespace xten
+} // namespace xilinx
@@ -382,6 +382,117 @@ std::map<std::string, uint64_t> getStatistics(xilinx::xten::Conv2dReLUOp op) {
   return getConv2dStatistics<xilinx::xten::Conv2dReLUOp>(op);
 }
 
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::Conv2dBatchNormOp op) {
+  return getConv2dStatistics<xilinx::xten::Conv2dBatchNormOp>(op);
+}
+
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::Conv2dBatchNormAddReLUOp op) {
+  std::map<std::string, uint64_t> toReturn = getConv2dStatistics<xilinx::xten::Conv2dBatchNormAddReLUOp>(op);
+
+  uint64_t residual_volume = xilinx::xten::getTensorVolume(op.residual().getType());
+  toReturn["ops:+"] += residual_volume;
+  toReturn["operand:14:activation_in"] = residual_volume;
+  toReturn["reads"] += residual_volume;
+  return toReturn;
+}
+
+// hardswish x * min(max(x + 3, 0), 6) / 6 on top of the convolution
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::Conv2dHardswishOp op) {
+  std::map<std::string, uint64_t> toReturn = getConv2dStatistics<xilinx::xten::Conv2dHardswishOp>(op);
+
+  uint64_t ofm_volume = toReturn["result:0:activation_out"];
+  toReturn["ops:+"] += ofm_volume;
+  toReturn["ops:>"] += 2 * ofm_volume;
+  toReturn["ops:*"] += 2 * ofm_volume;
+  return toReturn;
+}
+
+// xten elementwise binary ops, opName is the key of the counted operation
+template<class T>
+std::map<std::string, uint64_t> getXTenBinaryStatistics(T op, std::string opName) {
+  std::map<std::string, uint64_t> toReturn;
+
+  Torch::BaseTensorType resultTy = op.getResult().getType().template cast<Torch::BaseTensorType>();
+  uint64_t ofm_volume = xilinx::xten::getTensorVolume(resultTy);
+  toReturn[opName] = ofm_volume;
+  toReturn["result:0:activation_out"] = ofm_volume;
+
+  uint64_t a_volume = xilinx::xten::getTensorVolume(op.input0().getType());
+  uint64_t b_volume = xilinx::xten::getTensorVolume(op.input1().getType());
+
+  toReturn["operand:0:activation_in"] = a_volume;
+  toReturn["operand:1:activation_in"] = b_volume;
+
+  toReturn["reads"] = a_volume + b_volume;
+  toReturn["writes"] = ofm_volume;
+
+  return toReturn;
+}
+
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::AddOp op) {
+  return getXTenBinaryStatistics<xilinx::xten::AddOp>(op, "ops:+");
+}
+
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::MulOp op) {
+  return getXTenBinaryStatistics<xilinx::xten::MulOp>(op, "ops:*");
+}
+
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::MMOp op) {
+  std::map<std::string, uint64_t> toReturn;
+
+  Torch::BaseTensorType resultTy = op.getResult().getType().cast<Torch::BaseTensorType>();
+  uint64_t ofm_volume = xilinx::xten::getTensorVolume(resultTy);
+
+  Torch::BaseTensorType yTy = op.y().getType().cast<Torch::BaseTensorType>();
+  uint64_t num_input_neurons = yTy.getSizes()[0];
+  toReturn["ops:MAC"] = ofm_volume * num_input_neurons;
+
+  uint64_t x_volume = xilinx::xten::getTensorVolume(op.x().getType());
+  uint64_t y_volume = xilinx::xten::getTensorVolume(yTy);
+  toReturn["reads"] = x_volume + y_volume;
+  toReturn["writes"] = ofm_volume;
+
+  toReturn["operand:0:activation_in"] = x_volume;
+  toReturn["operand:1:activation_in"] = y_volume;
+  toReturn["result:0:activation_out"] = ofm_volume;
+  return toReturn;
+}
+
+template<>
+std::map<std::string, uint64_t> getStatistics(xilinx::xten::LinearReLUOp op) {
+  std::map<std::string, uint64_t> toReturn;
+
+  Torch::BaseTensorType resultTy = op.getResult().getType().cast<Torch::BaseTensorType>();
+  uint64_t ofm_volume = xilinx::xten::getTensorVolume(resultTy);
+
+  // weight is out_features x in_features
+  Torch::BaseTensorType weightTy = op.weight().getType().cast<Torch::BaseTensorType>();
+  uint64_t num_input_neurons = weightTy.getSizes()[1];
+  toReturn["ops:MAC"] = ofm_volume * num_input_neurons;
+  toReturn["ops:+"] = ofm_volume;
+  toReturn["ops:>"] = ofm_volume;
+
+  uint64_t x_volume = xilinx::xten::getTensorVolume(op.input().getType());
+  uint64_t weight_volume = xilinx::xten::getTensorVolume(weightTy);
+  uint64_t bias_volume = 0;
+  if(!op.bias().getType().isa<Torch::NoneType>())
+    bias_volume = xilinx::xten::getTensorVolume(op.bias().getType());
+  toReturn["reads"] = x_volume + weight_volume + bias_volume;
+  toReturn["writes"] = ofm_volume;
+
+  toReturn["operand:0:activation_in"] = x_volume;
+  toReturn["operand:1:parameters_in:weight"] = weight_volume;
+  toReturn["operand:2:parameters_in:bias"] = bias_volume;
+  toReturn["result:0:activation_out"] = ofm_volume;
+  return toReturn;
+}
+
 // _convolution_backward
 // template<>
 // std::map<std::string, uint64_t> getStatistics(ConvolutionBackwardOp op) {
@@ -998,6 +1109,13 @@ std::map<std::string, uint64_t> getATenOpStats(Operation *op)
 //  GET_STATS(AsStridedOp)
   GET_STATS(Torch::AtenBatchNormOp)
   GET_STATS(xilinx::xten::Conv2dReLUOp)
+  GET_STATS(xilinx::xten::Conv2dBatchNormOp)
+  GET_STATS(xilinx::xten::Conv2dBatchNormAddReLUOp)
+  GET_STATS(xilinx::xten::Conv2dHardswishOp)
+  GET_STATS(xilinx::xten::AddOp)
+  GET_STATS(xilinx::xten::MulOp)
+  GET_STATS(xilinx::xten::MMOp)
+  GET_STATS(xilinx::xten::LinearReLUOp)
   GET_STATS(Torch::AtenConv2dOp)
 //  GET_STATS(ConvolutionBackwardOp)
   GET_STATS(Torch::AtenDivTensorOp)
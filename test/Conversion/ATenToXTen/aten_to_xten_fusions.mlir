@@ -0,0 +1,72 @@
+//===- aten_to_xten_fusions.mlir -------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s --aten-to-xten | FileCheck %s
+
+// CHECK-LABEL: func @conv_bn(
+// CHECK: %[[BN:.*]] = "xten.conv2d_bn"(%arg0, %arg1, %arg2, %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}, %arg3, %arg4, %arg5, %arg6, %{{.*}}, %{{.*}}, %{{.*}})
+// CHECK-NOT: torch.aten.batch_norm
+// CHECK: return %[[BN]]
+
+// CHECK-LABEL: func @conv_bn_add_relu
+// CHECK: %[[RES:.*]] = "xten.conv2d_bn_add_relu"(%arg0, %arg1, %arg2, %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}}, %arg3, %arg4, %arg5, %arg6, %{{.*}}, %{{.*}}, %{{.*}}, %arg7)
+// CHECK-NOT: xten.add
+// CHECK-NOT: torch.aten.relu
+// CHECK: return %[[RES]]
+
+// CHECK-LABEL: func @conv_hardswish
+// CHECK: %[[HS:.*]] = "xten.conv2d_hardswish"(%arg0, %arg1, %arg2, %{{.*}}, %{{.*}}, %{{.*}}, %{{.*}})
+// CHECK-NOT: torch.aten.hardswish
+// CHECK: return %[[HS]]
+
+// CHECK-LABEL: func @linear_relu
+// CHECK: %[[FC:.*]] = "xten.linear_relu"(%arg0, %arg1, %arg2) : (!torch.vtensor<[4,32],f32>, !torch.vtensor<[16,32],f32>, !torch.vtensor<[16],f32>) -> !torch.vtensor<[4,16],f32>
+// CHECK-NOT: torch.aten.relu
+// CHECK: return %[[FC]]
+
+module attributes {torch.debug_module_name = "fusions"} {
+  func @conv_bn(%arg0: !torch.vtensor<[1,2,8,8],f32>, %arg1: !torch.vtensor<[4,2,3,3],f32>, %arg2: !torch.vtensor<[4],f32>, %arg3: !torch.vtensor<[4],f32>, %arg4: !torch.vtensor<[4],f32>, %arg5: !torch.vtensor<[4],f32>, %arg6: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,8,8],f32> {
+    %int1 = torch.constant.int 1
+    %false = torch.constant.bool false
+    %float1.000000e-01 = torch.constant.float 1.000000e-01
+    %float1.000000e-05 = torch.constant.float 1.000000e-05
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = torch.aten.conv2d %arg0, %arg1, %arg2, %0, %0, %0, %int1 : !torch.vtensor<[1,2,8,8],f32>, !torch.vtensor<[4,2,3,3],f32>, !torch.vtensor<[4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+    %2 = torch.aten.batch_norm %1, %arg3, %arg4, %arg5, %arg6, %false, %float1.000000e-01, %float1.000000e-05, %false : !torch.vtensor<[1,4,8,8],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.bool, !torch.float, !torch.float, !torch.bool -> !torch.vtensor<[1,4,8,8],f32>
+    return %2 : !torch.vtensor<[1,4,8,8],f32>
+  }
+
+  func @conv_bn_add_relu(%arg0: !torch.vtensor<[1,2,8,8],f32>, %arg1: !torch.vtensor<[4,2,3,3],f32>, %arg2: !torch.vtensor<[4],f32>, %arg3: !torch.vtensor<[4],f32>, %arg4: !torch.vtensor<[4],f32>, %arg5: !torch.vtensor<[4],f32>, %arg6: !torch.vtensor<[4],f32>, %arg7: !torch.vtensor<[1,4,8,8],f32>) -> !torch.vtensor<[1,4,8,8],f32> {
+    %int1 = torch.constant.int 1
+    %false = torch.constant.bool false
+    %float1.000000e-01 = torch.constant.float 1.000000e-01
+    %float1.000000e-05 = torch.constant.float 1.000000e-05
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = torch.aten.conv2d %arg0, %arg1, %arg2, %0, %0, %0, %int1 : !torch.vtensor<[1,2,8,8],f32>, !torch.vtensor<[4,2,3,3],f32>, !torch.vtensor<[4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+    %2 = torch.aten.batch_norm %1, %arg3, %arg4, %arg5, %arg6, %false, %float1.000000e-01, %float1.000000e-05, %false : !torch.vtensor<[1,4,8,8],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.bool, !torch.float, !torch.float, !torch.bool -> !torch.vtensor<[1,4,8,8],f32>
+    %3 = torch.aten.add.Tensor %arg7, %2, %int1 : !torch.vtensor<[1,4,8,8],f32>, !torch.vtensor<[1,4,8,8],f32>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+    %4 = torch.aten.relu %3 : !torch.vtensor<[1,4,8,8],f32> -> !torch.vtensor<[1,4,8,8],f32>
+    return %4 : !torch.vtensor<[1,4,8,8],f32>
+  }
+
+  func @conv_hardswish(%arg0: !torch.vtensor<[1,2,8,8],f32>, %arg1: !torch.vtensor<[4,2,3,3],f32>, %arg2: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,4,8,8],f32> {
+    %int1 = torch.constant.int 1
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = torch.aten.conv2d %arg0, %arg1, %arg2, %0, %0, %0, %int1 : !torch.vtensor<[1,2,8,8],f32>, !torch.vtensor<[4,2,3,3],f32>, !torch.vtensor<[4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int -> !torch.vtensor<[1,4,8,8],f32>
+    %2 = torch.aten.hardswish %1 : !torch.vtensor<[1,4,8,8],f32> -> !torch.vtensor<[1,4,8,8],f32>
+    return %2 : !torch.vtensor<[1,4,8,8],f32>
+  }
+
+  func @linear_relu(%arg0: !torch.vtensor<[4,32],f32>, %arg1: !torch.vtensor<[16,32],f32>, %arg2: !torch.vtensor<[16],f32>) -> !torch.vtensor<[4,16],f32> {
+    %0 = torch.aten.linear %arg0, %arg1, %arg2 : !torch.vtensor<[4,32],f32>, !torch.vtensor<[16,32],f32>, !torch.vtensor<[16],f32> -> !torch.vtensor<[4,16],f32>
+    %1 = torch.aten.relu %0 : !torch.vtensor<[4,16],f32> -> !torch.vtensor<[4,16],f32>
+    return %1 : !torch.vtensor<[4,16],f32>
+  }
+}
@@ -0,0 +1,34 @@
+//===- xten_to_linalg_conv2d_bn.mlir ---------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-to-linalg | FileCheck %s
+// CHECK-DAG: #[[CHANNEL:.*]] = affine_map<(d0, d1, d2, d3) -> (d3)>
+// CHECK: %[[OUT:.*]] = memref.alloc() : memref<1x6x6x4xf32>
+// CHECK: linalg.generic {indexing_maps = [#[[CHANNEL]], #{{.*}}], {{.*}}} ins(%{{.*}} : memref<4xf32>) outs(%[[OUT]] : memref<1x6x6x4xf32>)
+// CHECK: linalg.conv_2d_nhwc_hwcf {{.*}}ins(%{{.*}}, %{{.*}} : memref<1x8x8x2xf32>, memref<3x3x2x4xf32>) outs(%[[OUT]] : memref<1x6x6x4xf32>)
+// CHECK: linalg.generic {indexing_maps = [#[[CHANNEL]], #[[CHANNEL]], #[[CHANNEL]], #[[CHANNEL]], #{{.*}}], {{.*}}} ins(%{{.*}}, %{{.*}}, %{{.*}}, %{{.*}} : memref<4xf32>, memref<4xf32>, memref<4xf32>, memref<4xf32>) outs(%[[OUT]] : memref<1x6x6x4xf32>)
+// CHECK: math.sqrt
+// CHECK: arith.subf
+// CHECK: arith.mulf
+// CHECK: arith.divf
+// CHECK: arith.addf
+// CHECK-NOT: arith.maxf
+// CHECK-NOT: xten.conv2d_bn
+module  {
+  func @myFunc(%arg0: !torch.vtensor<[1,8,8,2],f32>, %arg1: !torch.vtensor<[3,3,2,4],f32>, %arg2: !torch.vtensor<[4],f32>, %arg3: !torch.vtensor<[4],f32>, %arg4: !torch.vtensor<[4],f32>, %arg5: !torch.vtensor<[4],f32>, %arg6: !torch.vtensor<[4],f32>) -> !torch.vtensor<[1,6,6,4],f32> {
+    %int1 = torch.constant.int 1
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %false = torch.constant.bool false
+    %float1.000000e-01 = torch.constant.float 1.000000e-01
+    %float1.000000e-05 = torch.constant.float 1.000000e-05
+    %1 = "xten.conv2d_bn"(%arg0, %arg1, %arg2, %0, %0, %0, %int1, %arg3, %arg4, %arg5, %arg6, %false, %float1.000000e-01, %float1.000000e-05) : (!torch.vtensor<[1,8,8,2],f32>, !torch.vtensor<[3,3,2,4],f32>, !torch.vtensor<[4],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.vtensor<[4],f32>, !torch.bool, !torch.float, !torch.float) -> !torch.vtensor<[1,6,6,4],f32>
+    return %1 : !torch.vtensor<[1,6,6,4],f32>
+  }
+}
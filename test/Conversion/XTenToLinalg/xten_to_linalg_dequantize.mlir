@@ -0,0 +1,23 @@
+//===- xten_to_linalg_dequantize.mlir --------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-to-linalg | FileCheck %s
+// CHECK: torch_c.to_builtin_tensor %arg0 : !torch.vtensor<[4,16],si8> -> tensor<4x16xi8>
+// CHECK: %[[OUT:.*]] = memref.alloc() : memref<4x16xf32>
+// CHECK: linalg.generic {{.*}} ins(%{{.*}} : memref<4x16xi8>) outs(%[[OUT]] : memref<4x16xf32>)
+// CHECK: arith.sitofp %{{.*}} : i8 to f32
+// CHECK: arith.mulf
+// CHECK-NOT: xten.dequantize
+module  {
+  func @myFunc(%arg0: !torch.vtensor<[4,16],si8>) -> !torch.vtensor<[4,16],f32> {
+    %0 = "xten.dequantize"(%arg0) {scale = 2.500000e-01 : f64} : (!torch.vtensor<[4,16],si8>) -> !torch.vtensor<[4,16],f32>
+    return %0 : !torch.vtensor<[4,16],f32>
+  }
+}
@@ -0,0 +1,28 @@
+//===- xten_to_linalg_linear_relu.mlir -------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-to-linalg | FileCheck %s
+// CHECK-DAG: #[[BIAS:.*]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-DAG: #[[X:.*]] = affine_map<(d0, d1, d2) -> (d0, d2)>
+// CHECK-DAG: #[[W:.*]] = affine_map<(d0, d1, d2) -> (d1, d2)>
+// CHECK: %[[OUT:.*]] = memref.alloc() : memref<4x16xf32>
+// CHECK: linalg.generic {indexing_maps = [#[[BIAS]], #{{.*}}], iterator_types = ["parallel", "parallel"]} ins(%{{.*}} : memref<16xf32>) outs(%[[OUT]] : memref<4x16xf32>)
+// CHECK: linalg.generic {indexing_maps = [#[[X]], #[[W]], #{{.*}}], iterator_types = ["parallel", "parallel", "reduction"]} ins(%{{.*}}, %{{.*}} : memref<4x32xf32>, memref<16x32xf32>) outs(%[[OUT]] : memref<4x16xf32>)
+// CHECK: arith.mulf
+// CHECK: arith.addf
+// CHECK: linalg.generic {{.*}} outs(%[[OUT]] : memref<4x16xf32>)
+// CHECK: arith.maxf
+// CHECK-NOT: xten.linear_relu
+module  {
+  func @myFunc(%arg0: !torch.vtensor<[4,32],f32>, %arg1: !torch.vtensor<[16,32],f32>, %arg2: !torch.vtensor<[16],f32>) -> !torch.vtensor<[4,16],f32> {
+    %0 = "xten.linear_relu"(%arg0, %arg1, %arg2) : (!torch.vtensor<[4,32],f32>, !torch.vtensor<[16,32],f32>, !torch.vtensor<[16],f32>) -> !torch.vtensor<[4,16],f32>
+    return %0 : !torch.vtensor<[4,16],f32>
+  }
+}
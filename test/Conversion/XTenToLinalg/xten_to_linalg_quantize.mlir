@@ -0,0 +1,27 @@
+//===- xten_to_linalg_quantize.mlir ----------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-to-linalg | FileCheck %s
+// CHECK: %[[OUT:.*]] = memref.alloc() : memref<4x32xi8>
+// CHECK: linalg.generic {{.*}} ins(%{{.*}} : memref<4x32xf32>) outs(%[[OUT]] : memref<4x32xi8>)
+// CHECK: arith.divf
+// CHECK: arith.select
+// CHECK: arith.addf
+// CHECK: arith.maxf
+// CHECK: arith.minf
+// CHECK: arith.fptosi %{{.*}} : f32 to i8
+// CHECK: torch_c.from_builtin_tensor %{{.*}} : tensor<4x32xi8> -> !torch.vtensor<[4,32],si8>
+// CHECK-NOT: xten.quantize
+module  {
+  func @myFunc(%arg0: !torch.vtensor<[4,32],f32>) -> !torch.vtensor<[4,32],si8> {
+    %0 = "xten.quantize"(%arg0) {scale = 1.250000e-01 : f64} : (!torch.vtensor<[4,32],f32>) -> !torch.vtensor<[4,32],si8>
+    return %0 : !torch.vtensor<[4,32],si8>
+  }
+}
@@ -0,0 +1,32 @@
+//===- xten_to_linalg_quantized_conv2d_relu.mlir ---------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-to-linalg | FileCheck %s
+// CHECK-DAG: #[[CHANNEL:.*]] = affine_map<(d0, d1, d2, d3) -> (d3)>
+// CHECK: %[[ACC:.*]] = memref.alloc() : memref<1x6x6x4xi32>
+// CHECK: linalg.generic {indexing_maps = [#[[CHANNEL]], #{{.*}}], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%{{.*}} : memref<4xi32>) outs(%[[ACC]] : memref<1x6x6x4xi32>)
+// CHECK: linalg.conv_2d_nhwc_hwcf {{.*}}ins(%{{.*}}, %{{.*}} : memref<1x8x8x2xi8>, memref<3x3x2x4xi8>) outs(%[[ACC]] : memref<1x6x6x4xi32>)
+// CHECK: arith.constant dense<[6.250000e-02, 3.125000e-02, 1.250000e-01, 2.500000e-01]> : tensor<4xf32>
+// CHECK: %[[OUT:.*]] = memref.alloc() : memref<1x6x6x4xi8>
+// CHECK: linalg.generic {indexing_maps = [#{{.*}}, #[[CHANNEL]], #{{.*}}], {{.*}}} ins(%[[ACC]], %{{.*}} : memref<1x6x6x4xi32>, memref<4xf32>) outs(%[[OUT]] : memref<1x6x6x4xi8>)
+// CHECK: arith.sitofp %{{.*}} : i32 to f32
+// CHECK: arith.mulf
+// CHECK: arith.maxf
+// CHECK: arith.divf
+// CHECK: arith.fptosi %{{.*}} : f32 to i8
+// CHECK-NOT: xten.conv2d_relu
+module  {
+  func @myFunc(%arg0: !torch.vtensor<[1,8,8,2],si8>, %arg1: !torch.vtensor<[3,3,2,4],si8>, %arg2: !torch.vtensor<[4],si32>) -> !torch.vtensor<[1,6,6,4],si8> {
+    %int1 = torch.constant.int 1
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = "xten.conv2d_relu"(%arg0, %arg1, %arg2, %0, %0, %0, %int1) {xten.quant = {input_scale = 1.250000e-01 : f64, output_scale = 2.500000e-01 : f64, weight_scales = [5.000000e-01, 2.500000e-01, 1.000000e+00, 2.000000e+00]}} : (!torch.vtensor<[1,8,8,2],si8>, !torch.vtensor<[3,3,2,4],si8>, !torch.vtensor<[4],si32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,6,6,4],si8>
+    return %1 : !torch.vtensor<[1,6,6,4],si8>
+  }
+}
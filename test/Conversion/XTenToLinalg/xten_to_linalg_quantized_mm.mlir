@@ -0,0 +1,29 @@
+//===- xten_to_linalg_quantized_mm.mlir ------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-to-linalg | FileCheck %s
+// CHECK: %[[ACC:.*]] = memref.alloc() : memref<4x16xi32>
+// CHECK: linalg.generic {{.*}} outs(%[[ACC]] : memref<4x16xi32>)
+// CHECK: arith.constant 0 : i32
+// CHECK: linalg.matmul ins(%{{.*}}, %{{.*}} : memref<4x32xi8>, memref<32x16xi8>) outs(%[[ACC]] : memref<4x16xi32>)
+// CHECK: arith.constant dense<6.250000e-02> : tensor<16xf32>
+// CHECK: %[[OUT:.*]] = memref.alloc() : memref<4x16xi8>
+// CHECK: linalg.generic {{.*}} ins(%[[ACC]], %{{.*}} : memref<4x16xi32>, memref<16xf32>) outs(%[[OUT]] : memref<4x16xi8>)
+// CHECK: arith.sitofp %{{.*}} : i32 to f32
+// CHECK: arith.mulf
+// CHECK: arith.divf
+// CHECK: arith.fptosi %{{.*}} : f32 to i8
+// CHECK-NOT: xten.mm
+module  {
+  func @myFunc(%arg0: !torch.vtensor<[4,32],si8>, %arg1: !torch.vtensor<[32,16],si8>) -> !torch.vtensor<[4,16],si8> {
+    %0 = "xten.mm"(%arg0, %arg1) {xten.quant = {input_scale = 1.250000e-01 : f64, output_scale = 2.500000e-01 : f64, weight_scales = [5.000000e-01]}} : (!torch.vtensor<[4,32],si8>, !torch.vtensor<[32,16],si8>) -> !torch.vtensor<[4,16],si8>
+    return %0 : !torch.vtensor<[4,16],si8>
+  }
+}
@@ -0,0 +1,118 @@
+//===- concat_split.mlir ---------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -canonicalize | FileCheck %s
+
+// CHECK-LABEL: func @split_of_concat
+// CHECK-NOT: xten.concat
+// CHECK-NOT: xten.split
+// CHECK: return %arg1, %arg0
+func @split_of_concat(%arg0: !torch.vtensor<[1,16,8,8],f32>, %arg1: !torch.vtensor<[1,16,8,8],f32>) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>) {
+  %c1 = arith.constant 1 : i32
+  %0 = "xten.concat"(%arg1, %arg0, %c1) : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>, i32) -> !torch.vtensor<[1,32,8,8],f32>
+  %1:2 = "xten.split"(%0, %c1) : (!torch.vtensor<[1,32,8,8],f32>, i32) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>)
+  return %1#0, %1#1 : !torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>
+}
+
+// CHECK-LABEL: func @concat_of_split
+// CHECK-NOT: xten.concat
+// CHECK: return %arg0
+func @concat_of_split(%arg0: !torch.vtensor<[1,32,8,8],f32>) -> !torch.vtensor<[1,32,8,8],f32> {
+  %c2 = arith.constant 2 : i32
+  %0:2 = "xten.split"(%arg0, %c2) : (!torch.vtensor<[1,32,8,8],f32>, i32) -> (!torch.vtensor<[1,32,4,8],f32>, !torch.vtensor<[1,32,4,8],f32>)
+  %1 = "xten.concat"(%0#0, %0#1, %c2) : (!torch.vtensor<[1,32,4,8],f32>, !torch.vtensor<[1,32,4,8],f32>, i32) -> !torch.vtensor<[1,32,8,8],f32>
+  return %1 : !torch.vtensor<[1,32,8,8],f32>
+}
+
+// CHECK-LABEL: func @slice_of_slice
+// CHECK: "xten.slice"(%arg0) {offsets = [0, 12, 0, 0]}
+// CHECK-NOT: xten.slice
+func @slice_of_slice(%arg0: !torch.vtensor<[1,32,8,8],f32>) -> !torch.vtensor<[1,4,8,8],f32> {
+  %0 = "xten.slice"(%arg0) {offsets = [0, 8, 0, 0]} : (!torch.vtensor<[1,32,8,8],f32>) -> !torch.vtensor<[1,16,8,8],f32>
+  %1 = "xten.slice"(%0) {offsets = [0, 4, 0, 0]} : (!torch.vtensor<[1,16,8,8],f32>) -> !torch.vtensor<[1,4,8,8],f32>
+  return %1 : !torch.vtensor<[1,4,8,8],f32>
+}
+
+// CHECK-LABEL: func @split_of_concat_orthogonal
+// CHECK-NOT: xten.split
+// CHECK-DAG: [[R0:%.+]] = "xten.concat"(%arg0, %arg2, %{{.*}}) : (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>, i32) -> !torch.vtensor<[1,16,8,8],f32>
+// CHECK-DAG: [[R1:%.+]] = "xten.concat"(%arg1, %arg3, %{{.*}}) : (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>, i32) -> !torch.vtensor<[1,16,8,8],f32>
+// CHECK: return [[R0]], [[R1]]
+func @split_of_concat_orthogonal(%arg0: !torch.vtensor<[1,16,4,8],f32>, %arg1: !torch.vtensor<[1,16,4,8],f32>, %arg2: !torch.vtensor<[1,16,4,8],f32>, %arg3: !torch.vtensor<[1,16,4,8],f32>) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>) {
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.constant 2 : i32
+  %0 = "xten.concat"(%arg0, %arg1, %c1) : (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>, i32) -> !torch.vtensor<[1,32,4,8],f32>
+  %1 = "xten.concat"(%arg2, %arg3, %c1) : (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>, i32) -> !torch.vtensor<[1,32,4,8],f32>
+  %2 = "xten.concat"(%0, %1, %c2) : (!torch.vtensor<[1,32,4,8],f32>, !torch.vtensor<[1,32,4,8],f32>, i32) -> !torch.vtensor<[1,32,8,8],f32>
+  %3:2 = "xten.split"(%2, %c1) : (!torch.vtensor<[1,32,8,8],f32>, i32) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>)
+  return %3#0, %3#1 : !torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>
+}
+
+// Both inputs are already split the same way, their splits are reused
+// CHECK-LABEL: func @split_of_concat_orthogonal_reuse
+// CHECK: [[S0:%.+]]:2 = "xten.split"(%arg0, %{{.*}})
+// CHECK: [[S1:%.+]]:2 = "xten.split"(%arg1, %{{.*}})
+// CHECK-NOT: xten.split
+// CHECK-DAG: [[R0:%.+]] = "xten.concat"([[S0]]#0, [[S1]]#0, %{{.*}}) : (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>, i32) -> !torch.vtensor<[1,16,8,8],f32>
+// CHECK-DAG: [[R1:%.+]] = "xten.concat"([[S0]]#1, [[S1]]#1, %{{.*}}) : (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>, i32) -> !torch.vtensor<[1,16,8,8],f32>
+// CHECK: return [[R0]], [[R1]], [[S0]]#0, [[S1]]#1
+func @split_of_concat_orthogonal_reuse(%arg0: !torch.vtensor<[1,32,4,8],f32>, %arg1: !torch.vtensor<[1,32,4,8],f32>) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>) {
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.constant 2 : i32
+  %0:2 = "xten.split"(%arg0, %c1) : (!torch.vtensor<[1,32,4,8],f32>, i32) -> (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>)
+  %1:2 = "xten.split"(%arg1, %c1) : (!torch.vtensor<[1,32,4,8],f32>, i32) -> (!torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>)
+  %2 = "xten.concat"(%arg0, %arg1, %c2) : (!torch.vtensor<[1,32,4,8],f32>, !torch.vtensor<[1,32,4,8],f32>, i32) -> !torch.vtensor<[1,32,8,8],f32>
+  %3:2 = "xten.split"(%2, %c1) : (!torch.vtensor<[1,32,8,8],f32>, i32) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>)
+  return %3#0, %3#1, %0#0, %1#1 : !torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,4,8],f32>, !torch.vtensor<[1,16,4,8],f32>
+}
+
+// The inputs would need new splits, the split stays after the concat
+// CHECK-LABEL: func @split_of_concat_orthogonal_kept
+// CHECK: "xten.concat"(%arg0, %arg1, %{{.*}})
+// CHECK: "xten.split"
+// CHECK-NOT: "xten.split"
+func @split_of_concat_orthogonal_kept(%arg0: !torch.vtensor<[1,32,4,8],f32>, %arg1: !torch.vtensor<[1,32,4,8],f32>) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>) {
+  %c1 = arith.constant 1 : i32
+  %c2 = arith.constant 2 : i32
+  %0 = "xten.concat"(%arg0, %arg1, %c2) : (!torch.vtensor<[1,32,4,8],f32>, !torch.vtensor<[1,32,4,8],f32>, i32) -> !torch.vtensor<[1,32,8,8],f32>
+  %1:2 = "xten.split"(%0, %c1) : (!torch.vtensor<[1,32,8,8],f32>, i32) -> (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>)
+  return %1#0, %1#1 : !torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>
+}
+
+// CHECK-LABEL: func @flatten_concat
+// CHECK: [[R:%.+]] = "xten.concat"(%arg0, %arg1, %arg2, %{{.*}}) : (!torch.vtensor<[1,8,8,8],f32>, !torch.vtensor<[1,8,8,8],f32>, !torch.vtensor<[1,8,8,8],f32>, i32) -> !torch.vtensor<[1,24,8,8],f32>
+// CHECK-NOT: xten.concat
+// CHECK: return [[R]]
+func @flatten_concat(%arg0: !torch.vtensor<[1,8,8,8],f32>, %arg1: !torch.vtensor<[1,8,8,8],f32>, %arg2: !torch.vtensor<[1,8,8,8],f32>) -> !torch.vtensor<[1,24,8,8],f32> {
+  %c1 = arith.constant 1 : i32
+  %0 = "xten.concat"(%arg1, %arg2, %c1) : (!torch.vtensor<[1,8,8,8],f32>, !torch.vtensor<[1,8,8,8],f32>, i32) -> !torch.vtensor<[1,16,8,8],f32>
+  %1 = "xten.concat"(%arg0, %0, %c1) : (!torch.vtensor<[1,8,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>, i32) -> !torch.vtensor<[1,24,8,8],f32>
+  return %1 : !torch.vtensor<[1,24,8,8],f32>
+}
+
+// CHECK-LABEL: func @slice_of_concat
+// CHECK-NOT: xten.concat
+// CHECK: [[R:%.+]] = "xten.slice"(%arg1) {offsets = [0, 4, 0, 0]}
+// CHECK: return [[R]]
+func @slice_of_concat(%arg0: !torch.vtensor<[1,16,8,8],f32>, %arg1: !torch.vtensor<[1,16,8,8],f32>) -> !torch.vtensor<[1,8,8,8],f32> {
+  %c1 = arith.constant 1 : i32
+  %0 = "xten.concat"(%arg0, %arg1, %c1) : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[1,16,8,8],f32>, i32) -> !torch.vtensor<[1,32,8,8],f32>
+  %1 = "xten.slice"(%0) {offsets = [0, 20, 0, 0]} : (!torch.vtensor<[1,32,8,8],f32>) -> !torch.vtensor<[1,8,8,8],f32>
+  return %1 : !torch.vtensor<[1,8,8,8],f32>
+}
+
+// CHECK-LABEL: func @single_result_split
+// CHECK-NOT: xten.split
+// CHECK: return %arg0
+func @single_result_split(%arg0: !torch.vtensor<[1,16,8,8],f32>) -> !torch.vtensor<[1,16,8,8],f32> {
+  %c1 = arith.constant 1 : i32
+  %0 = "xten.split"(%arg0, %c1) : (!torch.vtensor<[1,16,8,8],f32>, i32) -> !torch.vtensor<[1,16,8,8],f32>
+  return %0 : !torch.vtensor<[1,16,8,8],f32>
+}
@@ -0,0 +1,35 @@
+//===- annotate_expand.mlir ------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-annotate-dataflow | FileCheck %s --check-prefix=ANNOTATE
+// RUN: aten-opt %s -xten-annotate-dataflow -xten-expand-graph | FileCheck %s --check-prefix=EXPAND
+// RUN: aten-opt %s -xten-annotate-dataflow -xten-expand-graph -mlir-timing -mlir-timing-display=tree -o /dev/null 2>&1 | FileCheck %s --check-prefix=TIMING
+
+// ANNOTATE: "xten.mm"(%arg0, %0) {layer_name = "mm0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 3 : i64, W = 12 : i64, computeTime = {{[0-9]+}} : i64, lineGranularity = false, totalTime = 10 : i64, totalTimePerTile = {{[0-9]+}} : i64}}
+
+// The 64 columns go to 3 cores as 24, 24 and 16, the 16 lines to 12 replicas as 2 lines for the first 4 and 1 for the others
+// EXPAND-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 0 : i32, locW = 0 : i32{{.*}} -> !torch.vtensor<[2,24],f32>
+// EXPAND-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 2 : i32, locW = 11 : i32{{.*}} -> !torch.vtensor<[1,16],f32>
+// EXPAND: "xten.concat"{{.*}} -> !torch.vtensor<[16,64],f32>
+
+// The exploration phases and the transforms are nested in the timers of their passes
+// TIMING-DAG: (A) generateValidTopologies
+// TIMING-DAG: (A) generatePathGraph
+// TIMING-DAG: (A) enumeratePaths
+// TIMING-DAG: (A) getParetoFrontierAndCleanGraph
+// TIMING-DAG: (A) parallelTransform
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[16,32],f32>) -> !torch.vtensor<[16,64],f32> {
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<32x64xf32>) : !torch.vtensor<[32,64],f32>
+    %1 = "xten.mm"(%arg0, %0) {layer_name = "mm0"} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,64],f32>) -> !torch.vtensor<[16,64],f32>
+    return %1 : !torch.vtensor<[16,64],f32>
+  }
+}
@@ -0,0 +1,24 @@
+//===- bias_element_type.mlir ----------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph -verify-diagnostics
+
+// Zero biases cannot be built for the Ca split when the bias elements are not byte addressable
+module attributes {torch.debug_module_name = "bias"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,8,8],f32>) -> !torch.vtensor<[1,16,8,8],f32> {
+    %int1 = torch.constant.int 1
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = torch.vtensor.literal(dense<0.1> : tensor<16x16x3x3xf32>) : !torch.vtensor<[16,16,3,3],f32>
+    %2 = torch.vtensor.literal(dense<false> : tensor<16xi1>) : !torch.vtensor<[16],i1>
+    // expected-error @+1 {{Unsupported bias element type in the dataflow graph: 'i1'}}
+    %3 = "xten.conv2d_relu"(%arg0, %1, %2, %0, %0, %0, %int1) {layer_name = "conv0", xten.dataflow = {Ca = 2 : i64, L = 1 : i64, P = 1 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],i1>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,8,8],f32>
+    return %3 : !torch.vtensor<[1,16,8,8],f32>
+  }
+}
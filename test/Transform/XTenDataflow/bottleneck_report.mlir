@@ -0,0 +1,58 @@
+//===- bottleneck_report.mlir ----------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-annotate-dataflow='bottleneck-report=- bottleneck-extra-cores=11' -o /dev/null | FileCheck %s
+
+// The 1x1 layer is the bottleneck. Going from Ca = 4 to Ca = 5 takes 11 more cores and brings it
+// under the 3x3 layer, which then bounds the throughput. Extra cores for the 3x3 layer change nothing
+// CHECK: "area": 396,
+// CHECK: "bottleneck": {
+// CHECK-NEXT: "id": 0,
+// CHECK-NEXT: "name": "conv2d_relu0",
+// CHECK-NEXT: "totalTime": 256
+
+// CHECK: "Ca": 4,
+// CHECK-NEXT: "L": 1,
+// CHECK-NEXT: "P": 11,
+// CHECK-NEXT: "W": 1,
+// CHECK-NEXT: "cores": 44,
+// CHECK: "k": 10,
+// CHECK-NEXT: "throughput": 3906249,
+// CHECK-NEXT: "totalTime": 256
+// CHECK: "cores": 55,
+// CHECK-NEXT: "gain": 1.06666{{[0-9]*}},
+// CHECK-NEXT: "k": 11,
+// CHECK-NEXT: "throughput": 4166666,
+// CHECK-NEXT: "totalTime": 224
+// CHECK: "name": "conv2d_relu0",
+// CHECK-NEXT: "slack": 0,
+
+// CHECK: "P": 32,
+// CHECK: "k": 11,
+// CHECK-NEXT: "throughput": 3906249,
+// CHECK-NEXT: "totalTime": 240
+// CHECK: "name": "conv2d_relu1",
+// CHECK-NEXT: "slack": 16,
+// CHECK: "throughput": 3906249
+
+module attributes {torch.debug_module_name = "conv2d"}  {
+  func @forward(%arg0: !torch.vtensor<[1,256,1,16],f32>) -> !torch.vtensor<[1,256,1,16],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<256x256x1x1xf32>) : !torch.vtensor<[256,256,1,1],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<256xf32>) : !torch.vtensor<[256],f32>
+    %2 = torch.vtensor.literal(dense<0.1> : tensor<256x256x3x3xf32>) : !torch.vtensor<[256,256,3,3],f32>
+    %3 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %4 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %5 = "xten.conv2d_relu"(%arg0, %0, %1, %3, %4, %3, %int1) {layer_name = "conv2d_relu0"} : (!torch.vtensor<[1,256,1,16],f32>, !torch.vtensor<[256,256,1,1],f32>, !torch.vtensor<[256],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,256,1,16],f32>
+    %6 = "xten.conv2d_relu"(%5, %2, %1, %3, %3, %3, %int1) {layer_name = "conv2d_relu1"} : (!torch.vtensor<[1,256,1,16],f32>, !torch.vtensor<[256,256,3,3],f32>, !torch.vtensor<[256],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,256,1,16],f32>
+    return %6 : !torch.vtensor<[1,256,1,16],f32>
+  }
+}
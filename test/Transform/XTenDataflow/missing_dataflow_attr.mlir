@@ -0,0 +1,25 @@
+//===- missing_dataflow_attr.mlir ------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: not aten-opt %s -xten-expand-graph 2>&1 | FileCheck %s
+// CHECK: error: Missing or invalid xten.dataflow attribute, run xten-annotate-dataflow first
+
+module attributes {torch.debug_module_name = "conv2d"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,18,18],f32>) -> !torch.vtensor<[1,32,16,16],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<32x16x3x3xf32>) : !torch.vtensor<[32,16,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<32xf32>) : !torch.vtensor<[32],f32>
+    %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %4 = "xten.conv2d_relu"(%arg0, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu0"} : (!torch.vtensor<[1,16,18,18],f32>, !torch.vtensor<[32,16,3,3],f32>, !torch.vtensor<[32],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,32,16,16],f32>
+    return %4 : !torch.vtensor<[1,32,16,16],f32>
+  }
+}
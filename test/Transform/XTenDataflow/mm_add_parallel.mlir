@@ -0,0 +1,26 @@
+//===- mm_add_parallel.mlir ------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s
+// CHECK: "xten.split"(%arg1
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0", locP = 0 : i32{{.*}} -> !torch.vtensor<[16,32],f32>
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0", locP = 1 : i32{{.*}} -> !torch.vtensor<[16,32],f32>
+// CHECK: "xten.concat"{{.*}} -> !torch.vtensor<[16,64],f32>
+// CHECK-DAG: "xten.add"{{.*}}layer_name = "add0", locW = 0 : i32{{.*}} -> !torch.vtensor<[8,64],f32>
+// CHECK-DAG: "xten.add"{{.*}}layer_name = "add0", locW = 1 : i32{{.*}} -> !torch.vtensor<[8,64],f32>
+// CHECK: "xten.concat"{{.*}} -> !torch.vtensor<[16,64],f32>
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[16,32],f32>, %arg1: !torch.vtensor<[32,64],f32>, %arg2: !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32> {
+    %0 = "xten.mm"(%arg0, %arg1) {layer_name = "mm0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 2 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,64],f32>) -> !torch.vtensor<[16,64],f32>
+    %1 = "xten.add"(%0, %arg2) {layer_name = "add0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = false}} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32>
+    return %1 : !torch.vtensor<[16,64],f32>
+  }
+}
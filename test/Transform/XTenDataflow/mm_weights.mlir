@@ -0,0 +1,34 @@
+//===- mm_weights.mlir -----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-annotate-dataflow='layer-descriptors=-' -o /dev/null | FileCheck %s
+
+// y of mm0 is a constant, its weights stay in the banks of the cores
+// CHECK: "C": 32,
+// CHECK-NEXT: "CIn": 32,
+// CHECK-NEXT: "COut": 64,
+// CHECK: "name": "mm0",
+// CHECK: "weights": 1,
+
+// y of mm1 is a graph input, an activation, it still gives the sizes of the layer
+// CHECK: "C": 64,
+// CHECK-NEXT: "CIn": 64,
+// CHECK-NEXT: "COut": 8,
+// CHECK: "name": "mm1",
+// CHECK: "weights": 0,
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[16,32],f32>, %arg1: !torch.vtensor<[64,8],f32>) -> !torch.vtensor<[16,8],f32> {
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<32x64xf32>) : !torch.vtensor<[32,64],f32>
+    %1 = "xten.mm"(%arg0, %0) {layer_name = "mm0"} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,64],f32>) -> !torch.vtensor<[16,64],f32>
+    %2 = "xten.mm"(%1, %arg1) {layer_name = "mm1"} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[64,8],f32>) -> !torch.vtensor<[16,8],f32>
+    return %2 : !torch.vtensor<[16,8],f32>
+  }
+}
@@ -0,0 +1,45 @@
+//===- mobilenet_block_w.mlir ----------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// Depthwise followed by pointwise convolution, both duplicated twice along the lines
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s
+// CHECK-DAG: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu0", locW = 0 : i32
+// CHECK-DAG: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu0", locW = 1 : i32
+// CHECK-DAG: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu1", locW = 0 : i32
+// CHECK-DAG: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu1", locW = 1 : i32
+// CHECK-NOT: "xten.conv2d_relu"
+
+// W replicas share the weights of the layer instead of holding copies
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s --check-prefix=SHARED
+// SHARED: [[W1:%[^ ]+]] = torch.vtensor.literal({{.*}} : tensor<32x16x1x1xf32>)
+// SHARED-NOT: tensor<32x16x1x1xf32>
+// SHARED: "xten.partialconv2d_relu"({{.*}}[[W1]], {{.*}}layer_name = "conv2d_relu1"
+// SHARED: "xten.partialconv2d_relu"({{.*}}[[W1]], {{.*}}layer_name = "conv2d_relu1"
+
+// RUN: aten-opt %s -xten-expand-graph='expand-w=false' | FileCheck %s --check-prefix=NOW
+// NOW-COUNT-2: "xten.conv2d_relu"
+// NOW-NOT: locW
+
+module attributes {torch.debug_module_name = "MobileNet"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,18,18],f32>) -> !torch.vtensor<[1,32,16,16],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %int16 = torch.constant.int 16
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<16x1x3x3xf32>) : !torch.vtensor<[16,1,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.vtensor.literal(dense<0.1> : tensor<32x16x1x1xf32>) : !torch.vtensor<[32,16,1,1],f32>
+    %3 = torch.vtensor.literal(dense<0.0> : tensor<32xf32>) : !torch.vtensor<[32],f32>
+    %4 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %5 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %6 = "xten.conv2d_relu"(%arg0, %0, %1, %4, %5, %4, %int16) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,18,18],f32>, !torch.vtensor<[16,1,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,16,16],f32>
+    %7 = "xten.conv2d_relu"(%6, %2, %3, %4, %5, %4, %int1) {layer_name = "conv2d_relu1", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,16,16],f32>, !torch.vtensor<[32,16,1,1],f32>, !torch.vtensor<[32],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,32,16,16],f32>
+    return %7 : !torch.vtensor<[1,32,16,16],f32>
+  }
+}
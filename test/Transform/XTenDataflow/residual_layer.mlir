@@ -0,0 +1,39 @@
+//===- residual_layer.mlir -------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s
+
+// The residual is split along the output channels like the output
+// CHECK: %[[RES:.*]]:2 = "xten.split"(%arg1
+
+// Ca = 2 and L = 3 chain 6 partial ops per output channel group, only the last one adds the residual
+// CHECK-COUNT-5: "xten.partialconv2d_bn"(
+// CHECK: "xten.partialconv2d_bn_add_relu"({{.*}}, %[[RES]]#0) {layer_name = "conv0", locCa = 1 : i32, locL = 2 : i32, locP = 0 : i32
+// CHECK-COUNT-5: "xten.partialconv2d_bn"(
+// CHECK: "xten.partialconv2d_bn_add_relu"({{.*}}, %[[RES]]#1) {layer_name = "conv0", locCa = 1 : i32, locL = 2 : i32, locP = 1 : i32
+// CHECK-NOT: "xten.conv2d_bn_add_relu"
+
+module attributes {torch.debug_module_name = "residual"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,8,8],f32>, %arg1: !torch.vtensor<[1,16,8,8],f32>) -> !torch.vtensor<[1,16,8,8],f32> {
+    %int1 = torch.constant.int 1
+    %false = torch.constant.bool false
+    %float1.000000e-01 = torch.constant.float 1.000000e-01
+    %float1.000000e-05 = torch.constant.float 1.000000e-05
+    %0 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %1 = torch.vtensor.literal(dense<0.1> : tensor<16x16x3x3xf32>) : !torch.vtensor<[16,16,3,3],f32>
+    %2 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %3 = torch.vtensor.literal(dense<1.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %4 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %5 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %6 = torch.vtensor.literal(dense<1.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %7 = "xten.conv2d_bn_add_relu"(%arg0, %1, %2, %0, %0, %0, %int1, %3, %4, %5, %6, %false, %float1.000000e-01, %float1.000000e-05, %arg1) {layer_name = "conv0", xten.dataflow = {Ca = 2 : i64, L = 3 : i64, P = 2 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int, !torch.vtensor<[16],f32>, !torch.vtensor<[16],f32>, !torch.vtensor<[16],f32>, !torch.vtensor<[16],f32>, !torch.bool, !torch.float, !torch.float, !torch.vtensor<[1,16,8,8],f32>) -> !torch.vtensor<[1,16,8,8],f32>
+    return %7 : !torch.vtensor<[1,16,8,8],f32>
+  }
+}
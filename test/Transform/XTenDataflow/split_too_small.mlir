@@ -0,0 +1,29 @@
+//===- split_too_small.mlir ------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph -split-input-file -verify-diagnostics
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[7,32],f32>, %arg1: !torch.vtensor<[32,4],f32>) -> !torch.vtensor<[7,4],f32> {
+    // expected-error @+1 {{P = 5 is larger than the 4 output channels of the layer}}
+    %0 = "xten.mm"(%arg0, %arg1) {layer_name = "mm0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 5 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[7,32],f32>, !torch.vtensor<[32,4],f32>) -> !torch.vtensor<[7,4],f32>
+    return %0 : !torch.vtensor<[7,4],f32>
+  }
+}
+
+// -----
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[7,96],f32>, %arg1: !torch.vtensor<[7,96],f32>) -> !torch.vtensor<[7,96],f32> {
+    // expected-error @+1 {{W = 8 is larger than the 7 input lines of the layer}}
+    %0 = "xten.add"(%arg0, %arg1) {layer_name = "add0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 8 : i64, lineGranularity = false}} : (!torch.vtensor<[7,96],f32>, !torch.vtensor<[7,96],f32>) -> !torch.vtensor<[7,96],f32>
+    return %0 : !torch.vtensor<[7,96],f32>
+  }
+}
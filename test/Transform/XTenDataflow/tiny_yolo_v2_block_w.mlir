@@ -0,0 +1,36 @@
+//===- tiny_yolo_v2_block_w.mlir -------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s
+// CHECK: "xten.conv2d_relu"{{.*}}layer_name = "conv2d_relu0"
+// CHECK: "torch.aten.max_pool2d"{{.*}}layer_name = "max_pool2d0"
+// CHECK-DAG: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu1", locW = 0 : i32
+// CHECK-DAG: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu1", locW = 1 : i32
+// CHECK-NOT: "xten.conv2d_relu"{{.*}}layer_name = "conv2d_relu1"
+
+module attributes {torch.debug_module_name = "TinyYoloV2"}  {
+  func @forward(%arg0: !torch.vtensor<[1,3,34,34],f32>) -> !torch.vtensor<[1,32,16,16],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %int2 = torch.constant.int 2
+    %false = torch.constant.bool false
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<16x3x3x3xf32>) : !torch.vtensor<[16,3,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.vtensor.literal(dense<0.1> : tensor<32x16x3x3xf32>) : !torch.vtensor<[32,16,3,3],f32>
+    %3 = torch.vtensor.literal(dense<0.0> : tensor<32xf32>) : !torch.vtensor<[32],f32>
+    %4 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %5 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %6 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+    %7 = "xten.conv2d_relu"(%arg0, %0, %1, %4, %5, %4, %int1) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 1 : i64, lineGranularity = true}} : (!torch.vtensor<[1,3,34,34],f32>, !torch.vtensor<[16,3,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,32,32],f32>
+    %8 = torch.aten.max_pool2d %7, %6, %6, %5, %4, %false {layer_name = "max_pool2d0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 1 : i64, lineGranularity = true}} : !torch.vtensor<[1,16,32,32],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[1,16,16,16],f32>
+    %9 = "xten.conv2d_relu"(%8, %2, %3, %4, %4, %4, %int1) {layer_name = "conv2d_relu1", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,16,16],f32>, !torch.vtensor<[32,16,3,3],f32>, !torch.vtensor<[32],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,32,16,16],f32>
+    return %9 : !torch.vtensor<[1,32,16,16],f32>
+  }
+}
@@ -0,0 +1,34 @@
+//===- uneven_splits.mlir --------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s
+
+// The 12 blocks of 8 channels go to 5 cores as 3, 3, 2, 2 and 2 blocks
+// CHECK: "xten.split"(%arg1{{.*}} -> (!torch.vtensor<[32,24],f32>, !torch.vtensor<[32,24],f32>, !torch.vtensor<[32,16],f32>, !torch.vtensor<[32,16],f32>, !torch.vtensor<[32,16],f32>)
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 0 : i32{{.*}} -> !torch.vtensor<[7,24],f32>
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 1 : i32{{.*}} -> !torch.vtensor<[7,24],f32>
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 2 : i32{{.*}} -> !torch.vtensor<[7,16],f32>
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 3 : i32{{.*}} -> !torch.vtensor<[7,16],f32>
+// CHECK-DAG: "xten.mm"{{.*}}layer_name = "mm0"{{.*}}locP = 4 : i32{{.*}} -> !torch.vtensor<[7,16],f32>
+// CHECK: "xten.concat"{{.*}} : (!torch.vtensor<[7,24],f32>, !torch.vtensor<[7,24],f32>, !torch.vtensor<[7,16],f32>, !torch.vtensor<[7,16],f32>, !torch.vtensor<[7,16],f32>{{.*}} -> !torch.vtensor<[7,96],f32>
+
+// The 7 lines go to 3 replicas as 3, 2 and 2 lines
+// CHECK-DAG: "xten.add"{{.*}}layer_name = "add0"{{.*}}locW = 0 : i32{{.*}} -> !torch.vtensor<[3,96],f32>
+// CHECK-DAG: "xten.add"{{.*}}layer_name = "add0"{{.*}}locW = 1 : i32{{.*}} -> !torch.vtensor<[2,96],f32>
+// CHECK-DAG: "xten.add"{{.*}}layer_name = "add0"{{.*}}locW = 2 : i32{{.*}} -> !torch.vtensor<[2,96],f32>
+// CHECK: "xten.concat"{{.*}} : (!torch.vtensor<[3,96],f32>, !torch.vtensor<[2,96],f32>, !torch.vtensor<[2,96],f32>{{.*}} -> !torch.vtensor<[7,96],f32>
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[7,32],f32>, %arg1: !torch.vtensor<[32,96],f32>, %arg2: !torch.vtensor<[7,96],f32>) -> !torch.vtensor<[7,96],f32> {
+    %0 = "xten.mm"(%arg0, %arg1) {layer_name = "mm0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 5 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[7,32],f32>, !torch.vtensor<[32,96],f32>) -> !torch.vtensor<[7,96],f32>
+    %1 = "xten.add"(%0, %arg2) {layer_name = "add0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 3 : i64, lineGranularity = false}} : (!torch.vtensor<[7,96],f32>, !torch.vtensor<[7,96],f32>) -> !torch.vtensor<[7,96],f32>
+    return %1 : !torch.vtensor<[7,96],f32>
+  }
+}
@@ -0,0 +1,112 @@
+//===- w_halo.mlir ---------------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// Replicas of a layer compute every W-th tile of lines and a 3x3 kernel needs 3 tiles of one line
+// A replica forwards its input lines to the other replica of its layer, which completes them with
+// the tile it needs next from the producer
+// RUN: aten-opt %s -split-input-file -xten-expand-graph | FileCheck %s
+
+// Same W on both layers: replica 1 of conv2d_relu1 reads both producer tiles, replica 0 reads the
+// lines forwarded by replica 1 and the tile of producer replica 0
+// CHECK-LABEL: torch.debug_module_name = "same_w"
+// CHECK-DAG: [[P0:%[0-9]+]]:2 = "xten.partialconv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0", locW = 0 : i32
+// CHECK-DAG: [[P1:%[0-9]+]]:2 = "xten.partialconv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0", locW = 1 : i32
+// CHECK-DAG: [[IN1:%[0-9]+]] = "xten.concat"([[P0]]#0, [[P1]]#0, %{{.*}})
+// CHECK-DAG: [[R1:%[0-9]+]]:2 = "xten.partialconv2d_relu"([[IN1]], {{.*}}layer_name = "conv2d_relu1", locW = 1 : i32
+// CHECK-DAG: [[IN0:%[0-9]+]] = "xten.concat"([[R1]]#1, [[P0]]#0, %{{.*}})
+// CHECK-DAG: "xten.partialconv2d_relu"([[IN0]], {{.*}}layer_name = "conv2d_relu1", locW = 0 : i32
+
+// W grows: both replicas of conv2d_relu1 read the single producer, replica 0 also reads the lines
+// forwarded by replica 1
+// CHECK-LABEL: torch.debug_module_name = "growing_w"
+// CHECK: [[P:%[0-9]+]] = "xten.conv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0"
+// CHECK-DAG: [[R1:%[0-9]+]]:2 = "xten.partialconv2d_relu"([[P]], {{.*}}layer_name = "conv2d_relu1", locW = 1 : i32
+// CHECK-DAG: [[IN0:%[0-9]+]] = "xten.concat"([[R1]]#1, [[P]], %{{.*}})
+// CHECK-DAG: "xten.partialconv2d_relu"([[IN0]], {{.*}}layer_name = "conv2d_relu1", locW = 0 : i32
+
+// W shrinks: the tiles of both producer replicas are concatenated for the single consumer
+// CHECK-LABEL: torch.debug_module_name = "shrinking_w"
+// CHECK-DAG: [[P0:%[0-9]+]]:2 = "xten.partialconv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0", locW = 0 : i32
+// CHECK-DAG: [[P1:%[0-9]+]]:2 = "xten.partialconv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0", locW = 1 : i32
+// CHECK: [[IN:%[0-9]+]] = "xten.concat"([[P0]]#0, [[P1]]#0, %{{.*}})
+// CHECK: "xten.partialconv2d_relu"([[IN]], {{.*}}layer_name = "conv2d_relu1"
+
+// A pool has no partial variant to forward its lines, its replicas read the producer tiles directly
+// CHECK-LABEL: torch.debug_module_name = "conv_pool"
+// CHECK-DAG: [[P0:%[0-9]+]]:2 = "xten.partialconv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0", locW = 0 : i32
+// CHECK-DAG: [[P1:%[0-9]+]]:2 = "xten.partialconv2d_relu"(%arg0, {{.*}}layer_name = "conv2d_relu0", locW = 1 : i32
+// CHECK-DAG: [[IN1:%[0-9]+]] = "xten.concat"([[P0]]#0, [[P1]]#0, %{{.*}})
+// CHECK-DAG: torch.aten.max_pool2d [[IN1]], {{.*}}layer_name = "max_pool2d0", locW = 1 : i32
+// CHECK-DAG: torch.aten.max_pool2d [[P0]]#0, {{.*}}layer_name = "max_pool2d0", locW = 0 : i32
+
+module attributes {torch.debug_module_name = "same_w"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,10,10],f32>) -> !torch.vtensor<[1,16,6,6],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<16x16x3x3xf32>) : !torch.vtensor<[16,16,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %4 = "xten.conv2d_relu"(%arg0, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,10,10],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,8,8],f32>
+    %5 = "xten.conv2d_relu"(%4, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu1", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,6,6],f32>
+    return %5 : !torch.vtensor<[1,16,6,6],f32>
+  }
+}
+
+// -----
+
+module attributes {torch.debug_module_name = "growing_w"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,10,10],f32>) -> !torch.vtensor<[1,16,6,6],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<16x16x3x3xf32>) : !torch.vtensor<[16,16,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %4 = "xten.conv2d_relu"(%arg0, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 1 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,10,10],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,8,8],f32>
+    %5 = "xten.conv2d_relu"(%4, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu1", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,6,6],f32>
+    return %5 : !torch.vtensor<[1,16,6,6],f32>
+  }
+}
+
+// -----
+
+module attributes {torch.debug_module_name = "shrinking_w"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,10,10],f32>) -> !torch.vtensor<[1,16,6,6],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<16x16x3x3xf32>) : !torch.vtensor<[16,16,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %4 = "xten.conv2d_relu"(%arg0, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,10,10],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,8,8],f32>
+    %5 = "xten.conv2d_relu"(%4, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu1", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 1 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,8,8],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,6,6],f32>
+    return %5 : !torch.vtensor<[1,16,6,6],f32>
+  }
+}
+
+// -----
+
+module attributes {torch.debug_module_name = "conv_pool"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,10,10],f32>) -> !torch.vtensor<[1,16,4,4],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.1> : tensor<16x16x3x3xf32>) : !torch.vtensor<[16,16,3,3],f32>
+    %1 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %3 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %int2 = torch.constant.int 2
+    %false = torch.constant.bool false
+    %4 = torch.prim.ListConstruct %int2, %int2 : (!torch.int, !torch.int) -> !torch.list<int>
+    %5 = "xten.conv2d_relu"(%arg0, %0, %1, %2, %3, %2, %int1) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : (!torch.vtensor<[1,16,10,10],f32>, !torch.vtensor<[16,16,3,3],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,8,8],f32>
+    %6 = torch.aten.max_pool2d %5, %4, %4, %3, %2, %false {layer_name = "max_pool2d0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = true}} : !torch.vtensor<[1,16,8,8],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.bool -> !torch.vtensor<[1,16,4,4],f32>
+    return %6 : !torch.vtensor<[1,16,4,4],f32>
+  }
+}
@@ -0,0 +1,85 @@
+//===- mm_add.mlir ---------------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-emit-graph -o /dev/null | FileCheck %s
+// y of the mm is a graph input, so it is streamed like any other activation
+// CHECK: "connections": [
+// CHECK: "bytes": 2048,
+// CHECK-NEXT: "from": "arg0",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "mm0_0_0_0_0",
+// CHECK-NEXT: "mm0_1_0_0_0"
+// CHECK-NEXT: ]
+// CHECK: "bytes": 4096,
+// CHECK-NEXT: "from": "arg1",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "mm0_0_0_0_0"
+// CHECK-NEXT: ]
+// CHECK: "bytes": 4096,
+// CHECK-NEXT: "from": "arg2",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "mm0_1_0_0_0"
+// CHECK-NEXT: ]
+// CHECK: "bytes": 2048,
+// CHECK-NEXT: "from": "mm0_0_0_0_0",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "add0_0_0_0_0",
+// CHECK-NEXT: "add0_0_0_0_1"
+// CHECK-NEXT: ]
+// CHECK: "bytes": 2048,
+// CHECK-NEXT: "from": "mm0_1_0_0_0",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "add0_0_0_0_0",
+// CHECK-NEXT: "add0_0_0_0_1"
+// CHECK-NEXT: ]
+// CHECK: "bytes": 4096,
+// CHECK-NEXT: "from": "arg3",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "add0_0_0_0_0",
+// CHECK-NEXT: "add0_0_0_0_1"
+// CHECK-NEXT: ]
+// CHECK: "bytes": 4096,
+// CHECK-NEXT: "from": "add0_0_0_0_0",
+// CHECK-NEXT: "kind": "stream",
+// CHECK-NEXT: "to": [
+// CHECK-NEXT: "out0"
+// CHECK-NEXT: ]
+// CHECK: "kernels": [
+// CHECK: "kernel": "xten.mm",
+// CHECK: "layer": "mm0",
+// CHECK: "name": "mm0_0_0_0_0"
+// CHECK: "kernel": "xten.mm",
+// CHECK: "name": "mm0_1_0_0_0"
+// CHECK: "kernel": "xten.add",
+// CHECK: "loc": {
+// CHECK: "W": 0
+// CHECK: "name": "add0_0_0_0_0"
+// CHECK: "kernel": "xten.add",
+// CHECK: "loc": {
+// CHECK: "W": 1
+// CHECK: "name": "add0_0_0_0_1"
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[16,32],f32>, %arg1: !torch.vtensor<[32,32],f32>, %arg2: !torch.vtensor<[32,32],f32>, %arg3: !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32> {
+    %c1 = arith.constant 1 : i32
+    %0 = "xten.mm"(%arg0, %arg1) {layer_name = "mm0", locP = 0 : i32, xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 2 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,32],f32>) -> !torch.vtensor<[16,32],f32>
+    %1 = "xten.mm"(%arg0, %arg2) {layer_name = "mm0", locP = 1 : i32, xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 2 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,32],f32>) -> !torch.vtensor<[16,32],f32>
+    %2 = "xten.concat"(%0, %1, %c1) : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[16,32],f32>, i32) -> !torch.vtensor<[16,64],f32>
+    %3 = "xten.add"(%2, %arg3) {layer_name = "add0", locW = 0 : i32, xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = false}} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32>
+    %4 = "xten.add"(%2, %arg3) {layer_name = "add0", locW = 1 : i32, xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 1 : i64, W = 2 : i64, lineGranularity = false}} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32>
+    return %3 : !torch.vtensor<[16,64],f32>
+  }
+}
@@ -0,0 +1,34 @@
+//===- round_trip.mlir -----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-externalize-constants='blob=%t.bin threshold=16' | FileCheck %s
+// CHECK: module attributes {xten.weights_blob = "{{.*}}.bin"
+// CHECK: "xten.external_constant"() {offset = 0 : i64, size = 64 : i64} : () -> tensor<4x4xf32>
+// CHECK: arith.constant dense<[1.000000e+00, 2.000000e+00, 3.000000e+00]> : tensor<3xf32>
+// CHECK: arith.constant dense<5.000000e-01> : tensor<8x8xf32>
+// CHECK: "xten.external_constant"() {offset = 64 : i64, size = 24 : i64} : () -> tensor<2x3xf32>
+
+// RUN: aten-opt %s -xten-externalize-constants='blob=%t.bin threshold=16' | aten-opt -xten-internalize-constants | FileCheck %s --check-prefix=LOAD
+// LOAD-NOT: xten.weights_blob
+// LOAD-NOT: xten.external_constant
+// LOAD: arith.constant dense<{{\[}}[0.000000e+00, 1.000000e+00, 2.000000e+00, 3.000000e+00], [4.000000e+00, 5.000000e+00, 6.000000e+00, 7.000000e+00], [8.000000e+00, 9.000000e+00, 1.000000e+01, 1.100000e+01], [1.200000e+01, 1.300000e+01, 1.400000e+01, 1.500000e+01]]> : tensor<4x4xf32>
+// LOAD: arith.constant dense<[1.000000e+00, 2.000000e+00, 3.000000e+00]> : tensor<3xf32>
+// LOAD: arith.constant dense<5.000000e-01> : tensor<8x8xf32>
+// LOAD: arith.constant dense<{{\[}}[-1.000000e+00, -2.000000e+00, -3.000000e+00], [-4.000000e+00, -5.000000e+00, -6.000000e+00]]> : tensor<2x3xf32>
+
+module {
+  func @forward() -> (tensor<4x4xf32>, tensor<3xf32>, tensor<8x8xf32>, tensor<2x3xf32>) {
+    %0 = arith.constant dense<[[0.0, 1.0, 2.0, 3.0], [4.0, 5.0, 6.0, 7.0], [8.0, 9.0, 10.0, 11.0], [12.0, 13.0, 14.0, 15.0]]> : tensor<4x4xf32>
+    %1 = arith.constant dense<[1.0, 2.0, 3.0]> : tensor<3xf32>
+    %2 = arith.constant dense<0.5> : tensor<8x8xf32>
+    %3 = arith.constant dense<[[-1.0, -2.0, -3.0], [-4.0, -5.0, -6.0]]> : tensor<2x3xf32>
+    return %0, %1, %2, %3 : tensor<4x4xf32>, tensor<3xf32>, tensor<8x8xf32>, tensor<2x3xf32>
+  }
+}
@@ -0,0 +1,42 @@
+//===- conv_bn_relu.mlir ---------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// s = bn_weight / sqrt(running_var + eps) = [0.5, 1.0]
+// RUN: aten-opt %s -xten-fold-batchnorm | FileCheck %s
+// CHECK-NOT: torch.vtensor.literal
+// CHECK: [[W:%[^ ]+]] = arith.constant dense<{{\[}}{{\[}}{{\[}}{{\[}}5.000000e-01]], {{\[}}{{\[}}5.000000e-01]]], {{\[}}{{\[}}{{\[}}1.000000e+00]], {{\[}}{{\[}}1.000000e+00]]]]> : tensor<2x2x1x1xf32>
+// CHECK: [[B:%[^ ]+]] = arith.constant dense<[-5.000000e-01, -1.500000e+00]> : tensor<2xf32>
+// CHECK: "xten.conv2d_relu"(%arg0, [[W]], [[B]], {{.*}}) {layer_name = "conv2d_bn_relu0"}
+// CHECK-NOT: bn_relu"(
+
+// Training mode keeps the batch norm
+// RUN: sed 's/torch.constant.bool false/torch.constant.bool true/' %s | aten-opt -xten-fold-batchnorm | FileCheck %s --check-prefix=TRAIN
+// TRAIN: "xten.conv2d_bn_relu"
+// TRAIN-NOT: "xten.conv2d_relu"
+
+module attributes {torch.debug_module_name = "ConvBN"}  {
+  func @forward(%arg0: !torch.vtensor<[1,2,4,4],f32>) -> !torch.vtensor<[1,2,4,4],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %false = torch.constant.bool false
+    %float1 = torch.constant.float 1.000000e+00
+    %float0.1 = torch.constant.float 1.000000e-01
+    %0 = torch.vtensor.literal(dense<1.0> : tensor<2x2x1x1xf32>) : !torch.vtensor<[2,2,1,1],f32>
+    %1 = torch.vtensor.literal(dense<1.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+    %2 = torch.vtensor.literal(dense<[1.0, 2.0]> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+    %3 = torch.vtensor.literal(dense<0.5> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+    %4 = torch.vtensor.literal(dense<3.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+    %5 = torch.vtensor.literal(dense<3.0> : tensor<2xf32>) : !torch.vtensor<[2],f32>
+    %6 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %7 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %8 = "xten.conv2d_bn_relu"(%arg0, %0, %1, %6, %7, %6, %int1, %2, %3, %4, %5, %false, %float0.1, %float1) {layer_name = "conv2d_bn_relu0"} : (!torch.vtensor<[1,2,4,4],f32>, !torch.vtensor<[2,2,1,1],f32>, !torch.vtensor<[2],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.vtensor<[2],f32>, !torch.bool, !torch.float, !torch.float) -> !torch.vtensor<[1,2,4,4],f32>
+    return %8 : !torch.vtensor<[1,2,4,4],f32>
+  }
+}
@@ -0,0 +1,33 @@
+//===- invalid_slice.mlir --------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -split-input-file -verify-diagnostics
+
+func @forward(%arg0: !torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32> {
+  // expected-error @+1 {{'xten.slice' op expected 2 offsets, got 1}}
+  %0 = "xten.slice"(%arg0) {offsets = [8]} : (!torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32>
+  return %0 : !torch.vtensor<[2,8],f32>
+}
+
+// -----
+
+func @forward(%arg0: !torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32> {
+  // expected-error @+1 {{'xten.slice' op slice [12, 20) of dimension 1 is out of the input of size 16}}
+  %0 = "xten.slice"(%arg0) {offsets = [0, 12]} : (!torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32>
+  return %0 : !torch.vtensor<[2,8],f32>
+}
+
+// -----
+
+func @forward(%arg0: !torch.vtensor<[2,16],f32>) -> !torch.vtensor<[16],f32> {
+  // expected-error @+1 {{'xten.slice' op result rank 1 does not match the input rank 2}}
+  %0 = "xten.slice"(%arg0) {offsets = [0, 0]} : (!torch.vtensor<[2,16],f32>) -> !torch.vtensor<[16],f32>
+  return %0 : !torch.vtensor<[16],f32>
+}
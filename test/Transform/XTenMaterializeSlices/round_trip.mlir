@@ -0,0 +1,29 @@
+//===- round_trip.mlir -----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-expand-graph | FileCheck %s --check-prefix=EXPAND
+// RUN: aten-opt %s -xten-expand-graph -xten-materialize-slices | FileCheck %s --implicit-check-not=xten.slice --implicit-check-not="tensor<2x16xf32>"
+
+// The literal weights of the two cores are referenced through slices after the expansion
+// EXPAND: %[[W:[0-9]+]] = torch.vtensor.literal
+// EXPAND-DAG: "xten.slice"(%[[W]]) {offsets = [0, 0]} : (!torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32>
+// EXPAND-DAG: "xten.slice"(%[[W]]) {offsets = [0, 8]} : (!torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32>
+
+// and hold the columns of their part once materialized
+// CHECK-DAG: torch.vtensor.literal(dense<{{\[}}[0.000000e+00, 1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00, 5.000000e+00, 6.000000e+00, 7.000000e+00], [1.600000e+01, 1.700000e+01, 1.800000e+01, 1.900000e+01, 2.000000e+01, 2.100000e+01, 2.200000e+01, 2.300000e+01]]> : tensor<2x8xf32>) : !torch.vtensor<[2,8],f32>
+// CHECK-DAG: torch.vtensor.literal(dense<{{\[}}[8.000000e+00, 9.000000e+00, 1.000000e+01, 1.100000e+01, 1.200000e+01, 1.300000e+01, 1.400000e+01, 1.500000e+01], [2.400000e+01, 2.500000e+01, 2.600000e+01, 2.700000e+01, 2.800000e+01, 2.900000e+01, 3.000000e+01, 3.100000e+01]]> : tensor<2x8xf32>) : !torch.vtensor<[2,8],f32>
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[4,2],f32>) -> !torch.vtensor<[4,16],f32> {
+    %0 = torch.vtensor.literal(dense<[[0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0, 13.0, 14.0, 15.0], [16.0, 17.0, 18.0, 19.0, 20.0, 21.0, 22.0, 23.0, 24.0, 25.0, 26.0, 27.0, 28.0, 29.0, 30.0, 31.0]]> : tensor<2x16xf32>) : !torch.vtensor<[2,16],f32>
+    %1 = "xten.mm"(%arg0, %0) {layer_name = "mm0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 2 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[4,2],f32>, !torch.vtensor<[2,16],f32>) -> !torch.vtensor<[4,16],f32>
+    return %1 : !torch.vtensor<[4,16],f32>
+  }
+}
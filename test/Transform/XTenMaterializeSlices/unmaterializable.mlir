@@ -0,0 +1,26 @@
+//===- unmaterializable.mlir -----------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-materialize-slices -split-input-file -verify-diagnostics
+
+func @forward(%arg0: !torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32> {
+  // expected-error @+1 {{Cannot materialize a slice of a value that is not a constant}}
+  %0 = "xten.slice"(%arg0) {offsets = [0, 8]} : (!torch.vtensor<[2,16],f32>) -> !torch.vtensor<[2,8],f32>
+  return %0 : !torch.vtensor<[2,8],f32>
+}
+
+// -----
+
+func @forward() -> !torch.vtensor<[2,8],i1> {
+  %0 = torch.vtensor.literal(dense<true> : tensor<2x16xi1>) : !torch.vtensor<[2,16],i1>
+  // expected-error @+1 {{Cannot materialize a slice of a constant whose elements are not byte addressable}}
+  %1 = "xten.slice"(%0) {offsets = [0, 8]} : (!torch.vtensor<[2,16],i1>) -> !torch.vtensor<[2,8],i1>
+  return %1 : !torch.vtensor<[2,8],i1>
+}
@@ -0,0 +1,33 @@
+//===- chains.mlir ---------------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// RUN: aten-opt %s -xten-place-cores='rows=2 cols=3 placement-report=-' | FileCheck %s
+// CHECK: "maxCongestion": 4
+// CHECK: "nonAdjacent": 0
+// CHECK: "streams": 6
+// CHECK: "wirelength": 10
+// CHECK: "xten.mm"{{.*}}locP = 0 : i32, xten.core = [0, 0]
+// CHECK: "xten.mm"{{.*}}locP = 1 : i32, xten.core = [0, 1]
+// CHECK: "xten.add"{{.*}}locCa = 0 : i32, xten.core = [0, 2]
+// CHECK: "xten.add"{{.*}}locCa = 1 : i32, xten.core = [1, 2]
+// CHECK: "xten.mul"{{.*}}xten.core = [1, 1]
+
+module attributes {torch.debug_module_name = "classifier"}  {
+  func @forward(%arg0: !torch.vtensor<[16,32],f32>, %arg1: !torch.vtensor<[32,32],f32>, %arg2: !torch.vtensor<[32,32],f32>) -> !torch.vtensor<[16,64],f32> {
+    %c1 = arith.constant 1 : i32
+    %0 = "xten.mm"(%arg0, %arg1) {layer_name = "mm0", locP = 0 : i32} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,32],f32>) -> !torch.vtensor<[16,32],f32>
+    %1 = "xten.mm"(%arg0, %arg2) {layer_name = "mm0", locP = 1 : i32} : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[32,32],f32>) -> !torch.vtensor<[16,32],f32>
+    %2 = "xten.concat"(%0, %1, %c1) : (!torch.vtensor<[16,32],f32>, !torch.vtensor<[16,32],f32>, i32) -> !torch.vtensor<[16,64],f32>
+    %3 = "xten.add"(%2, %2) {layer_name = "add0", locCa = 0 : i32} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32>
+    %4 = "xten.add"(%3, %2) {layer_name = "add0", locCa = 1 : i32} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32>
+    %5 = "xten.mul"(%4, %4) {layer_name = "mul0"} : (!torch.vtensor<[16,64],f32>, !torch.vtensor<[16,64],f32>) -> !torch.vtensor<[16,64],f32>
+    return %5 : !torch.vtensor<[16,64],f32>
+  }
+}
@@ -0,0 +1,43 @@
+//===- conv_chain.mlir -----------------------------------------*- MLIR -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// Two quantized convolutions, the second reads the int8 result of the first directly
+// RUN: echo '{"conv2d_relu0": {"input": 1.0, "output": 4.0}, "conv2d_relu1": {"input": 4.0, "output": 8.0}}' > %t.json
+// RUN: aten-opt %s -xten-quantize='calibration=%t.json' | FileCheck %s
+// CHECK: [[Q:%[^ ]+]] = "xten.quantize"(%arg0) {scale = {{.*}} : f64} : (!torch.vtensor<[1,16,4,4],f32>) -> !torch.vtensor<[1,16,4,4],si8>
+// CHECK: [[W0:%[^ ]+]] = arith.constant dense<127> : tensor<16x16x1x1xsi8>
+// CHECK: [[B0:%[^ ]+]] = arith.constant dense<16129> : tensor<16xsi32>
+// CHECK: [[C0:%[^ ]+]] = "xten.conv2d_relu"([[Q]], [[W0]], [[B0]], {{.*}}layer_name = "conv2d_relu0"{{.*}}xten.quant = {input_scale = {{.*}}, output_scale = {{.*}}, weight_scales = [{{.*}}]}{{.*}} -> !torch.vtensor<[1,16,4,4],si8>
+// CHECK-NOT: "xten.quantize"
+// CHECK: [[C1:%[^ ]+]] = "xten.conv2d_relu"([[C0]], {{.*}}layer_name = "conv2d_relu1"{{.*}} -> !torch.vtensor<[1,16,4,4],si8>
+// CHECK: [[D:%[^ ]+]] = "xten.dequantize"([[C1]]) {scale = {{.*}} : f64} : (!torch.vtensor<[1,16,4,4],si8>) -> !torch.vtensor<[1,16,4,4],f32>
+// CHECK: return [[D]]
+
+// Channel split layers keep the scales of their channels, Ca chains pass int32 sums along
+// RUN: aten-opt %s -xten-quantize='calibration=%t.json' -xten-expand-graph | FileCheck %s --check-prefix=EXPAND
+// EXPAND-COUNT-2: "xten.conv2d_relu"{{.*}}layer_name = "conv2d_relu0"{{.*}}weight_scales = {{\[([^],]+, ){7}[^],]+\]}}
+// EXPAND: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu1", locCa = 0{{.*}} -> !torch.vtensor<[1,16,4,4],si32>
+// EXPAND: "xten.partialconv2d_relu"{{.*}}layer_name = "conv2d_relu1", locCa = 1{{.*}} -> !torch.vtensor<[1,16,4,4],si8>
+
+module attributes {torch.debug_module_name = "ConvChain"}  {
+  func @forward(%arg0: !torch.vtensor<[1,16,4,4],f32>) -> !torch.vtensor<[1,16,4,4],f32> {
+    %int0 = torch.constant.int 0
+    %int1 = torch.constant.int 1
+    %0 = torch.vtensor.literal(dense<0.5> : tensor<16x16x1x1xf32>) : !torch.vtensor<[16,16,1,1],f32>
+    %1 = torch.vtensor.literal(dense<0.5> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %2 = torch.vtensor.literal(dense<0.25> : tensor<16x16x1x1xf32>) : !torch.vtensor<[16,16,1,1],f32>
+    %3 = torch.vtensor.literal(dense<0.0> : tensor<16xf32>) : !torch.vtensor<[16],f32>
+    %4 = torch.prim.ListConstruct %int1, %int1 : (!torch.int, !torch.int) -> !torch.list<int>
+    %5 = torch.prim.ListConstruct %int0, %int0 : (!torch.int, !torch.int) -> !torch.list<int>
+    %6 = "xten.conv2d_relu"(%arg0, %0, %1, %4, %5, %4, %int1) {layer_name = "conv2d_relu0", xten.dataflow = {Ca = 1 : i64, L = 1 : i64, P = 2 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[1,16,4,4],f32>, !torch.vtensor<[16,16,1,1],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,4,4],f32>
+    %7 = "xten.conv2d_relu"(%6, %2, %3, %4, %5, %4, %int1) {layer_name = "conv2d_relu1", xten.dataflow = {Ca = 2 : i64, L = 1 : i64, P = 1 : i64, W = 1 : i64, lineGranularity = false}} : (!torch.vtensor<[1,16,4,4],f32>, !torch.vtensor<[16,16,1,1],f32>, !torch.vtensor<[16],f32>, !torch.list<int>, !torch.list<int>, !torch.list<int>, !torch.int) -> !torch.vtensor<[1,16,4,4],f32>
+    return %7 : !torch.vtensor<[1,16,4,4],f32>
+  }
+}
@@ -27,7 +27,7 @@ config.name = 'ATEN'
 config.test_format = lit.formats.ShTest(not llvm_config.use_lit_shell)
 
 # suffixes: A list of file extensions to treat as test files.
-config.suffixes = ['.mlir']
+config.suffixes = ['.mlir', '.test']
 
 # test_source_root: The root path where tests are located.
 config.test_source_root = os.path.dirname(__file__)
@@ -46,7 +46,8 @@ llvm_config.use_default_substitutions()
 # excludes: A list of directories to exclude from the testsuite. The 'Inputs'
 # subdirectories contain auxiliary inputs for various tests in their parent
 # directories.
-config.excludes = ['Inputs', 'Examples', 'CMakeLists.txt', 'README.txt', 'LICENSE.txt', 'XTenToAffine', 'XTenToLinalg']
+config.excludes = ['Inputs', 'Examples', 'CMakeLists.txt', 'README.txt', 'LICENSE.txt', 'XTenToAffine', 'air_to_linalg_mm.mlir',
+                   'air_to_linalg_conv2d.mlir']
 
 # test_source_root: The root path where tests are located.
 config.test_source_root = os.path.dirname(__file__)
@@ -61,7 +62,9 @@ llvm_config.with_environment('PATH', config.llvm_tools_dir, append_path=True)
 tool_dirs = [config.aie_tools_dir, config.llvm_tools_dir]
 tools = [
     'test.exe',
-    'aten-opt'
+    'aten-opt',
+    'xten-explore',
+    'xten-explore-bench'
 ]
 
 llvm_config.add_tool_substitutions(tools, tool_dirs)
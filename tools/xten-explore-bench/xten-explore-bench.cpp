@@ -0,0 +1,349 @@
+//===- xten-explore-bench.cpp -----------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// Benchmarks the dataflow explorer on synthetic VGG, MobileNet and ResNet
+// like conv chains. For each exploration stage reports wall time, peak RSS,
+// path graph nodes and edges, relaxed frontier cells and frontier size.
+// With -check-batch, compares the batch evaluation of the cost model against
+// the scalar one instead.
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "xten/Dialect/XTen/XTenDataflowExplorer.h"
+
+#ifdef LLVM_ON_UNIX
+#include <sys/resource.h>
+#endif
+
+using namespace llvm;
+using namespace xilinx::xten;
+
+typedef std::vector<std::pair<std::string, std::map<std::string, int64_t>>>
+    Network;
+
+static cl::list<std::string>
+    networks("network",
+             cl::desc("Synthetic networks to explore: vgg, mobilenet, "
+                      "resnet"),
+             cl::CommaSeparated);
+
+static cl::opt<unsigned> depth("depth",
+                               cl::desc("Layers (VGG), blocks (MobileNet) "
+                                        "or residual blocks (ResNet) per "
+                                        "stage"),
+                               cl::init(2));
+
+static cl::opt<unsigned> channels("channels",
+                                  cl::desc("Channels of the first stage"),
+                                  cl::init(64));
+
+static cl::opt<unsigned> resolution("resolution",
+                                    cl::desc("Height and width of the input"),
+                                    cl::init(224));
+
+static cl::opt<bool>
+    checkBatch("check-batch",
+               cl::desc("Compare evaluateBatch against isValid, "
+                        "getTotalMemBanks and getTotalTime over the full P, "
+                        "Ca, L, W grid instead of benchmarking"),
+               cl::init(false));
+
+namespace {
+
+class NetworkBuilder {
+public:
+  NetworkBuilder(std::string prefix, int64_t C, int64_t res)
+      : prefix(prefix), C(C), N(res), M(res) {}
+
+  // Appends a F x F conv producing COut channels, depthwise if dw
+  void conv(int64_t COut, int64_t F, int64_t stride, bool dw = false) {
+    int64_t CIn = dw ? 1 : C;
+    COut = dw ? C : COut;
+
+    std::map<std::string, int64_t> sizes = layer(COut, CIn, F, stride);
+    sizes["DW"] = dw ? 1 : 0;
+    sizes["eff"] = dw ? 30 : 90;
+    sizes["weights"] = 1;
+    sizes["macs"] = COut * CIn * F * F * outLines(stride) * outCols(stride);
+    push(dw ? "conv2d_dw" : "conv2d_relu", sizes, COut, stride);
+  }
+
+  void maxpool(int64_t F, int64_t stride) {
+    std::map<std::string, int64_t> sizes = layer(C, 1, F, stride);
+    sizes["DW"] = 1;
+    sizes["eff"] = 25;
+    sizes["weights"] = 0;
+    sizes["macs"] = C * F * F * outLines(stride) * outCols(stride);
+    push("max_pool2d", sizes, C, stride);
+  }
+
+  int64_t channels() { return C; }
+  int64_t lines() { return N; }
+
+  Network network;
+
+private:
+  std::string prefix;
+  int64_t C;
+  int64_t N;
+  int64_t M;
+
+  int64_t outLines(int64_t stride) { return std::max((int64_t)1, N / stride); }
+  int64_t outCols(int64_t stride) { return std::max((int64_t)1, M / stride); }
+
+  std::map<std::string, int64_t> layer(int64_t COut, int64_t CIn, int64_t F,
+                                       int64_t stride) {
+    std::map<std::string, int64_t> sizes;
+    sizes["C"] = C;
+    sizes["M"] = M;
+    sizes["N"] = N;
+    sizes["COut"] = COut;
+    sizes["CIn"] = CIn;
+    sizes["F0"] = F;
+    sizes["F1"] = F;
+    sizes["width"] = 1;
+    sizes["stride"] = stride;
+    return sizes;
+  }
+
+  void push(std::string kind, std::map<std::string, int64_t> &sizes,
+            int64_t COut, int64_t stride) {
+    std::string name = prefix + "_" + kind + std::to_string(network.size());
+    network.push_back(std::make_pair(name, sizes));
+    N = outLines(stride);
+    M = outCols(stride);
+    C = COut;
+  }
+};
+
+} // namespace
+
+// 5 stages of depth 3x3 convs each followed by a 2x2 max pool
+static Network buildVGG(unsigned depth, int64_t channels, int64_t res) {
+  NetworkBuilder builder("vgg", 3, res);
+  for (unsigned s = 0; s < 5; s++) {
+    int64_t c = channels << std::min(s, 3u);
+    for (unsigned l = 0; l < depth; l++)
+      builder.conv(c, 3, 1);
+    if (builder.lines() > 1)
+      builder.maxpool(2, 2);
+  }
+  return builder.network;
+}
+
+// Stem conv, then depthwise separable blocks, downsampling every depth blocks
+static Network buildMobileNet(unsigned depth, int64_t channels, int64_t res) {
+  NetworkBuilder builder("mobilenet", 3, res);
+  builder.conv(channels / 2, 3, 2);
+  for (unsigned s = 0; s < 5; s++) {
+    int64_t c = channels << s;
+    for (unsigned b = 0; b < depth; b++) {
+      bool down = (b == 0) && (s > 0) && (builder.lines() > 1);
+      builder.conv(0, 3, down ? 2 : 1, true);
+      builder.conv(c, 1, 1);
+    }
+  }
+  return builder.network;
+}
+
+// Stem conv and pool, then 4 stages of depth basic blocks, residual adds are
+// not part of the chain seen by the explorer
+static Network buildResNet(unsigned depth, int64_t channels, int64_t res) {
+  NetworkBuilder builder("resnet", 3, res);
+  builder.conv(channels, 7, 2);
+  builder.maxpool(3, 2);
+  for (unsigned s = 0; s < 4; s++) {
+    int64_t c = channels << s;
+    for (unsigned b = 0; b < depth; b++) {
+      bool down = (b == 0) && (s > 0) && (builder.lines() > 1);
+      builder.conv(c, 3, down ? 2 : 1);
+      builder.conv(c, 3, 1);
+    }
+  }
+  return builder.network;
+}
+
+static uint64_t getPeakRSS() {
+#ifdef LLVM_ON_UNIX
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+  return 0;
+}
+
+namespace {
+
+struct StageStats {
+  uint64_t nodes = 0;
+  uint64_t edges = 0;
+  uint64_t cells = 0;
+  uint64_t frontier = 0;
+};
+
+} // namespace
+
+static StageStats getGraphStats(DataflowExplorer &explorer) {
+  StageStats stats;
+  for (auto &layer : explorer.pathGraph) {
+    for (Node_t *node : layer) {
+      stats.nodes++;
+      stats.edges += node->ins.size();
+      for (PathInfo_t &info : node->areaToThroughput)
+        stats.cells += info.path.size() != 0;
+      for (PathInfo_t &info : node->areaToLatency)
+        stats.cells += info.path.size() != 0;
+    }
+  }
+  return stats;
+}
+
+static void report(StringRef network, StringRef stage, double seconds,
+                   StageStats stats) {
+  outs() << formatv("{0,-10} {1,-12} {2,10:f3} {3,12} {4,10} {5,12} {6,10} "
+                    "{7,8}\n",
+                    network, stage, seconds * 1000, getPeakRSS(), stats.nodes,
+                    stats.edges, stats.cells, stats.frontier);
+}
+
+static void runBenchmark(StringRef name, Network &network) {
+  DataflowExplorer explorer(network);
+  StageStats stats;
+
+  TimeRecord start = TimeRecord::getCurrentTime(true);
+  explorer.generateValidTopologies();
+  TimeRecord end = TimeRecord::getCurrentTime(false);
+  for (auto &topologies : explorer.validTopologies)
+    stats.nodes += topologies.size();
+  report(name, "topologies", end.getWallTime() - start.getWallTime(), stats);
+
+  start = TimeRecord::getCurrentTime(true);
+  explorer.generatePathGraph();
+  end = TimeRecord::getCurrentTime(false);
+  report(name, "graph", end.getWallTime() - start.getWallTime(),
+         getGraphStats(explorer));
+
+  start = TimeRecord::getCurrentTime(true);
+  explorer.enumeratePaths();
+  end = TimeRecord::getCurrentTime(false);
+  stats = getGraphStats(explorer);
+  report(name, "enumerate", end.getWallTime() - start.getWallTime(), stats);
+
+  start = TimeRecord::getCurrentTime(true);
+  explorer.getParetoFrontierAndCleanGraph();
+  end = TimeRecord::getCurrentTime(false);
+  stats = StageStats();
+  for (PathInfo_t &info : explorer.paretoThroughput)
+    stats.frontier += info.path.size() != 0;
+  for (PathInfo_t &info : explorer.paretoLatency)
+    stats.frontier += info.path.size() != 0;
+  report(name, "pareto", end.getWallTime() - start.getWallTime(), stats);
+}
+
+// Returns the number of candidates whose batch and scalar results differ.
+// Times are only compared when every dimension is at least as large as the
+// number of parts it is split into, the scalar split sizes are not defined
+// otherwise.
+static uint64_t checkBatchEvaluation(StringRef name, Network &network) {
+  DataflowExplorer explorer(network);
+  uint64_t numCores = explorer.arch->getNumCores();
+
+  uint64_t candidates = 0;
+  uint64_t mismatches = 0;
+  for (uint64_t layerId = 0; layerId < network.size(); layerId++) {
+    std::map<std::string, int64_t> &sizes = network[layerId].second;
+    uint64_t F0 = sizes["F0"];
+
+    ModelParamsBatch batch;
+    for (uint64_t p = 1; p <= numCores; p++)
+      for (uint64_t ca = 1; ca <= numCores / p; ca++)
+        for (uint64_t f = 1; f <= std::min(F0, numCores / (p * ca)); f++)
+          for (uint64_t w = 1; w <= numCores / (p * ca * f); w++) {
+            batch.push_back(ModelParams(p, ca, f, w, true));
+            batch.push_back(ModelParams(p, ca, f, w, false));
+          }
+
+    explorer.evaluateBatch(layerId, batch);
+    candidates += batch.size();
+
+    for (uint64_t i = 0; i < batch.size(); i++) {
+      ModelParams params = batch.at(i);
+      bool valid = explorer.isValid(layerId, params);
+      uint64_t memBanks = explorer.getTotalMemBanks(layerId, params);
+
+      bool splittable = ((int64_t)params.P <= sizes["COut"]) &&
+                        ((int64_t)params.Ca <= sizes["C"]);
+      uint64_t totalTime =
+          splittable ? explorer.getTotalTime(layerId, params) : 0;
+
+      if ((valid == (bool)batch.valid[i]) && (memBanks == batch.memBanks[i]) &&
+          (!splittable || (totalTime == batch.totalTime[i])))
+        continue;
+
+      mismatches++;
+      errs() << formatv("{0} {1}: P: {2}, Ca: {3}, L: {4}, W: {5}, "
+                        "lineGranularity: {6}: valid {7} vs {8}, memBanks "
+                        "{9} vs {10}, totalTime {11} vs {12}\n",
+                        name, network[layerId].first, params.P, params.Ca,
+                        params.L, params.W, params.lineGranularity,
+                        (unsigned)batch.valid[i], (unsigned)valid,
+                        batch.memBanks[i], memBanks, batch.totalTime[i],
+                        totalTime);
+    }
+  }
+
+  outs() << formatv("{0}: {1} candidates, {2} mismatches\n", name, candidates,
+                    mismatches);
+  return mismatches;
+}
+
+int main(int argc, char **argv) {
+  InitLLVM y(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "XTen dataflow explorer benchmark\n");
+
+  std::vector<std::string> selected(networks.begin(), networks.end());
+  if (selected.empty())
+    selected = {"vgg", "mobilenet", "resnet"};
+
+  outs() << formatv("# depth {0}, channels {1}, resolution {2}\n",
+                    (unsigned)depth, (unsigned)channels, (unsigned)resolution);
+  if (!checkBatch)
+    outs() << formatv("{0,-10} {1,-12} {2,10} {3,12} {4,10} {5,12} {6,10} "
+                      "{7,8}\n",
+                      "network", "stage", "time_ms", "peak_rss_kb", "nodes",
+                      "edges", "cells", "frontier");
+
+  uint64_t mismatches = 0;
+  for (std::string &name : selected) {
+    Network network;
+    if (name == "vgg") {
+      network = buildVGG(depth, channels, resolution);
+    } else if (name == "mobilenet") {
+      network = buildMobileNet(depth, channels, resolution);
+    } else if (name == "resnet") {
+      network = buildResNet(depth, channels, resolution);
+    } else {
+      errs() << "Unknown network " << name << "\n";
+      return 1;
+    }
+
+    if (checkBatch)
+      mismatches += checkBatchEvaluation(name, network);
+    else
+      runBenchmark(name, network);
+  }
+
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,161 @@
+//===- xten-explore.cpp -----------------------------------------*- C++ -*-===//
+//
+// This file is licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// (c) Copyright 2021 Xilinx Inc.
+//
+//===----------------------------------------------------------------------===//
+
+// Runs the dataflow explorer on a layer descriptor file, without going
+// through MLIR. Descriptor files are emitted from a model with
+//   aten-opt model.mlir -xten-name-layers -xten-annotate-dataflow="layer-descriptors=model.json"
+// or written by hand as CSV, with a header line naming the columns:
+//   name,C,M,N,COut,CIn,F0,F1,macs,DW,stride
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "xten/Dialect/XTen/XTenDataflowExplorer.h"
+#include "xten/Dialect/XTen/XTenDataflowSimulator.h"
+
+using namespace llvm;
+using namespace xilinx::xten;
+
+static cl::opt<std::string> inputFilename(cl::Positional,
+                                          cl::desc("<layer descriptors>"),
+                                          cl::init("-"));
+
+static cl::opt<std::string>
+    bottleneckReportFilename("bottleneck-report",
+                             cl::desc("Write the marginal gain report of "
+                                      "the selected design to this file, "
+                                      "\"-\" for stdout"),
+                             cl::init(""));
+
+static cl::opt<unsigned>
+    bottleneckMaxExtraCores("bottleneck-extra-cores",
+                            cl::desc("Maximum number of extra cores per "
+                                     "layer considered by the bottleneck "
+                                     "report"),
+                            cl::init(8));
+
+static cl::opt<std::string>
+    dumpFilename("dump-file",
+                 cl::desc("Write the explored topologies, pareto frontiers "
+                          "and their paths to this file"),
+                 cl::init(""));
+
+static cl::opt<std::string>
+    simulationReportFilename("simulation-report",
+                             cl::desc("Simulate the selected design and "
+                                      "write the report to this file, \"-\" "
+                                      "for stdout"),
+                             cl::init(""));
+
+static cl::opt<unsigned>
+    simulationSamples("simulation-samples",
+                      cl::desc("Number of samples pushed through the "
+                               "simulated pipeline"),
+                      cl::init(4));
+
+static cl::opt<std::string>
+    timeTraceFilename("time-trace",
+                      cl::desc("Write a Chrome trace of the exploration "
+                               "phases to this file"),
+                      cl::init(""));
+
+int main(int argc, char **argv) {
+  InitLLVM y(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "XTen dataflow explorer\n");
+
+  std::vector<std::pair<std::string, std::map<std::string, int64_t>>> layers;
+  if (!parseLayerDescriptors(inputFilename, layers))
+    return 1;
+
+  if (layers.empty()) {
+    errs() << "No layer found in " << inputFilename << "\n";
+    return 1;
+  }
+
+  if (timeTraceFilename != "")
+    timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, argv[0]);
+
+  DataflowExplorer explorer(layers);
+  explorer.enumerate([](const char *phase, function_ref<void()> run) {
+    TimeTraceScope timeScope(phase);
+    run();
+  });
+
+  if (timeTraceProfilerEnabled()) {
+    if (Error E = timeTraceProfilerWrite(timeTraceFilename, argv[0])) {
+      errs() << toString(std::move(E)) << "\n";
+      return 1;
+    }
+    timeTraceProfilerCleanup();
+  }
+
+  outs() << "candidates: " << explorer.numCandidates
+         << ", edges: " << explorer.numEdges
+         << ", cells relaxed: " << explorer.numCellsRelaxed
+         << ", peak node memory: " << explorer.peakNodeMemory << "\n";
+
+  if (dumpFilename != "" && !explorer.dumpExploration(dumpFilename))
+    return 1;
+
+  std::vector<ModelParams> path = explorer.getMaxThroughputPath();
+  if (path.empty())
+    return 1;
+
+  outs() << "throughput: " << explorer.getThroughput(path)
+         << ", area: " << explorer.getArea(path) << "\n";
+  for (uint64_t i = 0; i < path.size(); i++) {
+    ModelParams &params = path.at(i);
+    outs() << explorer.layerIdToName[i] << ": P: " << params.P
+           << ", Ca: " << params.Ca << ", L: " << params.L
+           << ", W: " << params.W
+           << ", lineGranularity: " << params.lineGranularity
+           << ", totalTime: " << explorer.getTotalTime(i, params) << "\n";
+  }
+
+  if (bottleneckReportFilename != "") {
+    std::string report = explorer.emitBottleneckReport(bottleneckMaxExtraCores);
+    if (bottleneckReportFilename != "-") {
+      std::error_code EC;
+      raw_fd_ostream reportStream(bottleneckReportFilename, EC);
+      if (EC) {
+        errs() << "Cannot open " << bottleneckReportFilename << ": "
+               << EC.message() << "\n";
+        return 1;
+      }
+      reportStream << report;
+    } else {
+      outs() << report;
+    }
+  }
+
+  if (simulationReportFilename != "") {
+    DataflowSimulator simulator(explorer, path);
+    if (!simulator.run(simulationSamples))
+      errs() << "Simulation failed: " << simulator.failure << "\n";
+
+    std::string report = simulator.emitReport();
+    if (simulationReportFilename != "-") {
+      std::error_code EC;
+      raw_fd_ostream reportStream(simulationReportFilename, EC);
+      if (EC) {
+        errs() << "Cannot open " << simulationReportFilename << ": "
+               << EC.message() << "\n";
+        return 1;
+      }
+      reportStream << report;
+    } else {
+      outs() << report;
+    }
+  }
+
+  return 0;
+}